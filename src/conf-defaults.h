@@ -62,8 +62,10 @@
 #define CONF_RDS_PS_INFO_ERROR  UP_TO_5_BIT_ERR_CORR
 #define CONF_RDS_PS_DATA_ERROR  UP_TO_2_BIT_ERR_CORR
 #define CONF_RDS_PS_PROGRESSIVE FALSE
+#define CONF_RDS_PS_VOTING      FALSE
 #define CONF_RDS_RT_INFO_ERROR  NO_ERR_CORR
 #define CONF_RDS_RT_DATA_ERROR  NO_ERR_CORR
+#define CONF_RDS_RT_VOTING      FALSE
 
 /* Antenna */
 #define CONF_ANTENNA_SHOW_ALIGNMENT FALSE
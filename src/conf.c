@@ -67,8 +67,10 @@ static const gchar *key_reset_timeout      = "reset_timeout";
 static const gchar *key_ps_info_error      = "ps_info_error";
 static const gchar *key_ps_data_error      = "ps_data_error";
 static const gchar *key_ps_progressive     = "ps_progressive";
+static const gchar *key_ps_voting          = "ps_voting";
 static const gchar *key_rt_info_error      = "rt_info_error";
 static const gchar *key_rt_data_error      = "rt_data_error";
+static const gchar *key_rt_voting          = "rt_voting";
 static const gchar *key_show_alignment     = "show_alignment";
 static const gchar *key_swap_rotator       = "swap_rotator";
 static const gchar *key_count              = "count";
@@ -250,8 +252,10 @@ conf_read()
     conf.rds_ps_info_error  = conf_read_integer(keyfile, group_rds, key_ps_info_error,  CONF_RDS_PS_INFO_ERROR);
     conf.rds_ps_data_error  = conf_read_integer(keyfile, group_rds, key_ps_data_error,  CONF_RDS_PS_DATA_ERROR);
     conf.rds_ps_progressive = conf_read_boolean(keyfile, group_rds, key_ps_progressive, CONF_RDS_PS_PROGRESSIVE);
+    conf.rds_ps_voting      = conf_read_boolean(keyfile, group_rds, key_ps_voting,      CONF_RDS_PS_VOTING);
     conf.rds_rt_info_error  = conf_read_integer(keyfile, group_rds, key_rt_info_error,  CONF_RDS_RT_INFO_ERROR);
     conf.rds_rt_data_error  = conf_read_integer(keyfile, group_rds, key_rt_data_error,  CONF_RDS_RT_DATA_ERROR);
+    conf.rds_rt_voting      = conf_read_boolean(keyfile, group_rds, key_rt_voting,      CONF_RDS_RT_VOTING);
 
     /* Antenna */
     conf.ant_show_alignment = conf_read_boolean(keyfile, group_antenna, key_show_alignment, CONF_ANTENNA_SHOW_ALIGNMENT);
@@ -337,6 +341,16 @@ conf_read()
         conf_write();
 }
 
+gchar*
+conf_data_path(const gchar *name)
+{
+    /* Data files are kept next to the configuration */
+    gchar *directory = g_path_get_dirname(path);
+    gchar *data_path = g_build_filename(directory, name, NULL);
+    g_free(directory);
+    return data_path;
+}
+
 void
 conf_write()
 {
@@ -401,8 +415,10 @@ conf_write()
     g_key_file_set_integer(keyfile, group_rds, key_ps_info_error,  conf.rds_ps_info_error);
     g_key_file_set_integer(keyfile, group_rds, key_ps_data_error,  conf.rds_ps_data_error);
     g_key_file_set_boolean(keyfile, group_rds, key_ps_progressive, conf.rds_ps_progressive);
+    g_key_file_set_boolean(keyfile, group_rds, key_ps_voting,      conf.rds_ps_voting);
     g_key_file_set_integer(keyfile, group_rds, key_rt_info_error,  conf.rds_rt_info_error);
     g_key_file_set_integer(keyfile, group_rds, key_rt_data_error,  conf.rds_rt_data_error);
+    g_key_file_set_boolean(keyfile, group_rds, key_rt_voting,      conf.rds_rt_voting);
 
     /* Antenna */
     g_key_file_set_boolean     (keyfile, group_antenna, key_show_alignment, conf.ant_show_alignment);
@@ -105,8 +105,10 @@ typedef struct settings
     enum RDS_Err_Correction rds_ps_info_error;
     enum RDS_Err_Correction rds_ps_data_error;
     gboolean rds_ps_progressive;
+    gboolean rds_ps_voting;
     enum RDS_Err_Correction rds_rt_info_error;
     enum RDS_Err_Correction rds_rt_data_error;
+    gboolean rds_rt_voting;
 
     /* Antenna */
     gboolean ant_show_alignment;
@@ -190,6 +192,7 @@ extern settings_t conf;
 
 void conf_init(const gchar*);
 void conf_write();
+gchar* conf_data_path(const gchar*);
 
 void conf_uniq_int_list_add(GList**, gint);
 void conf_uniq_int_list_toggle(GList**, gint);
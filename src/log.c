@@ -8,6 +8,7 @@
 #include "tuner.h"
 #include "conf.h"
 #include "ui.h"
+#include "rds-utils.h"
 
 static FILE *logfp = NULL;
 static gchar ps_buff[9];
@@ -202,6 +203,22 @@ log_ecc(const gchar *ecc,
         fprintf(logfp, "ECC\t%s%s", ecc, LOG_NL);
 }
 
+void
+log_stats(const rds_stats_t *stats,
+          gint64             now)
+{
+    /* Appended to an open log only, a tune without RDS leaves no file */
+    gchar *summary;
+
+    if(!logfp || !stats->groups)
+        return;
+
+    summary = rds_stats_summary(stats, now);
+    log_timestamp();
+    fprintf(logfp, "STATS\t%s%s", summary, LOG_NL);
+    g_free(summary);
+}
+
 gchar*
 replace_spaces(const gchar *str)
 {
@@ -212,3 +229,36 @@ replace_spaces(const gchar *str)
             new_str[i] = '_';
     return new_str;
 }
+
+void
+log_rds(const rds_decoder_t *decoder,
+        const rds_event_t   *event,
+        gpointer             user_data)
+{
+    gchar *af;
+
+    switch(event->type)
+    {
+    case RDS_EVENT_PI:
+        log_pi(decoder->pi, decoder->pi_err_level);
+        break;
+    case RDS_EVENT_PTY:
+        log_pty(rds_utils_pty_to_string(conf.rds_pty_set, event->value));
+        break;
+    case RDS_EVENT_ECC:
+        if(event->value >= 0xE0 && event->value <= 0xE4)
+            log_ecc(rds_utils_ecc_to_string(event->value, decoder->pi), event->value);
+        break;
+    case RDS_EVENT_AF:
+        af = g_strdup_printf("%.1f", ((87500+event->value*100)/1000.0));
+        log_af(af);
+        g_free(af);
+        break;
+    case RDS_EVENT_PS:
+        log_ps(event->ps.text, event->ps.err);
+        break;
+    case RDS_EVENT_RT:
+        log_rt(event->rt.flag, event->rt.text);
+        break;
+    }
+}
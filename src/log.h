@@ -1,5 +1,11 @@
 #ifndef XDR_LOG_H_
 #define XDR_LOG_H_
+#include "rds-decoder.h"
+#include "rds-stats.h"
+
+#define LOG_RDS_EVENTS (RDS_EVENT_MASK(RDS_EVENT_PI) | RDS_EVENT_MASK(RDS_EVENT_PTY) | \
+                        RDS_EVENT_MASK(RDS_EVENT_ECC) | RDS_EVENT_MASK(RDS_EVENT_AF) | \
+                        RDS_EVENT_MASK(RDS_EVENT_PS) | RDS_EVENT_MASK(RDS_EVENT_RT))
 
 void log_cleanup();
 void log_pi(gint, gint);
@@ -8,8 +14,11 @@ void log_ps(const gchar*, const guchar*);
 void log_rt(guint8, const gchar*);
 void log_pty(const gchar*);
 void log_ecc(const gchar* ecc, guint);
+void log_stats(const rds_stats_t*, gint64);
 gchar* replace_spaces(const gchar*);
 
+void log_rds(const rds_decoder_t*, const rds_event_t*, gpointer);
+
 #endif
 
 
@@ -20,22 +20,59 @@
 #include "rdsspy.h"
 #include "stationlist.h"
 #include "log.h"
+#include "ui-connect.h"
+#include "tuner-replay.h"
+#include "tuner.h"
 #ifdef G_OS_WIN32
 #include "win32.h"
 #endif
 
-static const gchar*
-get_config_path(gint   argc,
-                gchar *argv[])
+#define STATION_DB_FILE "stations.db"
+
+typedef struct args
+{
+    const gchar *config;
+    const gchar *record;
+    const gchar *archive;
+    const gchar *diversity;
+    const gchar *replay;
+    gdouble speed;
+} args_t;
+
+static void
+get_args(gint    argc,
+         gchar  *argv[],
+         args_t *args)
 {
-    gchar *path = NULL;
     gint c;
-    while((c = getopt(argc, argv, "c:")) != -1)
+    args->config = NULL;
+    args->record = NULL;
+    args->archive = NULL;
+    args->diversity = NULL;
+    args->replay = NULL;
+    args->speed = TUNER_REPLAY_REALTIME;
+    while((c = getopt(argc, argv, "c:r:a:d:p:s:")) != -1)
     {
         switch(c)
         {
         case 'c':
-            path = optarg;
+            args->config = optarg;
+            break;
+        case 'r':
+            args->record = optarg;
+            break;
+        case 'a':
+            args->archive = optarg;
+            break;
+        case 'd':
+            args->diversity = optarg;
+            break;
+        case 'p':
+            args->replay = optarg;
+            break;
+        case 's':
+            /* 0 replays the session as fast as possible */
+            args->speed = g_ascii_strtod(optarg, NULL);
             break;
         case '?':
             if(optopt == 'c')
@@ -43,21 +80,45 @@ get_config_path(gint   argc,
             break;
         }
     }
-    return path;
 }
 
 gint
 main(gint   argc,
      gchar *argv[])
 {
+    args_t args;
+    gchar *path;
+
     gtk_disable_setlocale();
     gtk_init(&argc, &argv);
 #ifdef G_OS_WIN32
     win32_init();
 #endif
-    conf_init(get_config_path(argc, argv));
+    get_args(argc, argv, &args);
+    conf_init(args.config);
     ui_init();
 
+    path = conf_data_path(STATION_DB_FILE);
+    if(!(tuner.station_db = station_db_open(path)))
+        fprintf(stderr, "Unable to open the station database: %s\n", path);
+    g_free(path);
+
+    if(args.record && !tuner_record_start(args.record))
+        fprintf(stderr, "Unable to record the tuner session to: %s\n", args.record);
+
+    if(args.archive && !(tuner.rds_archive = rds_archive_new(args.archive)))
+        fprintf(stderr, "Unable to archive RDS groups to: %s\n", args.archive);
+
+    /* The secondary tuner has to be there before the primary one connects */
+    if(args.diversity)
+        connection_diversity(args.diversity);
+
+    tuner_replay_set_speed(args.speed);
+    if(args.replay)
+        connection_replay(args.replay);
+    else if(conf.auto_connect)
+        connection_dialog(TRUE);
+
     if(conf.rdsspy_auto)
         rdsspy_toggle();
 
@@ -65,6 +126,12 @@ main(gint   argc,
         stationlist_init();
 
     gtk_main();
+    connection_merge_release();
+    if(tuner.station_db)
+        station_db_close(tuner.station_db);
+    tuner_record_stop();
+    if(tuner.rds_archive)
+        rds_archive_close(tuner.rds_archive);
     log_cleanup();
 #ifdef G_OS_WIN32
     win32_cleanup();
@@ -0,0 +1,154 @@
+#include <glib.h>
+#include <string.h>
+#include "rds-af.h"
+
+static gboolean rds_af_valid(guint);
+static gboolean rds_af_insert(rds_af_set_t*, guchar*, gint*, gint, guchar);
+static rds_af_list_t* rds_af_list(rds_af_t*, guchar);
+
+void
+rds_af_clear(rds_af_t *af)
+{
+    memset(af, 0, sizeof(rds_af_t));
+    af->current = -1;
+}
+
+gint
+rds_af_pair(rds_af_t             *af,
+            guchar                a,
+            guchar                b,
+            guchar               *added,
+            const rds_af_list_t **changed)
+{
+    /* Decodes one pair of AF codes from block C. New frequencies of the
+     * merged list are stored in added, the number of them is returned. */
+    rds_af_list_t *list;
+    guchar alt[2];
+    gint i, n = 0, count = 0;
+    gboolean regional = FALSE;
+
+    *changed = NULL;
+
+    /* The code after an LF/MF marker is not an FM frequency */
+    if(af->lfmf)
+    {
+        af->lfmf = FALSE;
+        a = RDS_AF_FILLER;
+    }
+    if(a == RDS_AF_LFMF)
+        b = RDS_AF_FILLER;
+    else if(b == RDS_AF_LFMF)
+        af->lfmf = TRUE;
+
+    if(a >= RDS_AF_COUNT_MIN && a <= RDS_AF_COUNT_MAX)
+    {
+        /* Start of a list: number of codes and the transmitter frequency */
+        af->current = -1;
+        if(!rds_af_valid(b))
+            return 0;
+
+        list = rds_af_list(af, b);
+        if(list)
+        {
+            list->expected = a - RDS_AF_COUNT_MIN;
+            af->current = list - af->lists;
+        }
+        alt[count++] = b;
+    }
+    else if(af->current >= 0 &&
+            a != b &&
+            (a == af->lists[af->current].freq || b == af->lists[af->current].freq))
+    {
+        /* Method B: the transmitter frequency paired with one alternative,
+         * in descending order for a regional variant */
+        list = &af->lists[af->current];
+        list->method = RDS_AF_METHOD_B;
+        regional = (a > b);
+        alt[count++] = (a == list->freq ? b : a);
+    }
+    else
+    {
+        /* Method A: two alternatives of the same list */
+        list = (af->current >= 0 ? &af->lists[af->current] : NULL);
+        if(list && list->method == RDS_AF_METHOD_UNKNOWN)
+            list->method = RDS_AF_METHOD_A;
+        alt[count++] = a;
+        alt[count++] = b;
+    }
+
+    for(i=0; i<count; i++)
+    {
+        if(!rds_af_valid(alt[i]))
+            continue;
+
+        if(list && alt[i] != list->freq &&
+           rds_af_insert(&list->set, list->af, &list->count, RDS_AF_MAX, alt[i]))
+        {
+            if(regional)
+                list->regional.bits[alt[i] >> 5] |= 1u << (alt[i] & 31);
+            *changed = list;
+        }
+
+        if(rds_af_insert(&af->set, af->freq, &af->count, RDS_AF_CODES, alt[i]))
+            added[n++] = alt[i];
+    }
+
+    return n;
+}
+
+gboolean
+rds_af_set_has(const rds_af_set_t *set,
+               guint               code)
+{
+    return code < RDS_AF_CODES && (set->bits[code >> 5] >> (code & 31)) & 1;
+}
+
+static gboolean
+rds_af_valid(guint code)
+{
+    return code > 0 && code < RDS_AF_CODES;
+}
+
+static gboolean
+rds_af_insert(rds_af_set_t *set,
+              guchar       *freq,
+              gint         *count,
+              gint          max,
+              guchar        code)
+{
+    /* Bitset lookup, then an insertion into the sorted array */
+    gint i;
+
+    if(rds_af_set_has(set, code) || *count >= max)
+        return FALSE;
+
+    set->bits[code >> 5] |= 1u << (code & 31);
+    for(i=*count; i>0 && freq[i-1] > code; i--)
+        freq[i] = freq[i-1];
+    freq[i] = code;
+    (*count)++;
+    return TRUE;
+}
+
+static rds_af_list_t*
+rds_af_list(rds_af_t *af,
+            guchar    freq)
+{
+    rds_af_list_t *list;
+    gint i;
+
+    for(i=0; i<af->list_count; i++)
+        if(af->lists[i].freq == freq)
+            return &af->lists[i];
+
+    if(af->list_count >= RDS_AF_LISTS)
+    {
+        /* Its alternatives still reach the merged set */
+        af->unlisted.bits[freq >> 5] |= 1u << (freq & 31);
+        return NULL;
+    }
+
+    list = &af->lists[af->list_count++];
+    list->freq = freq;
+    return list;
+}
@@ -0,0 +1,57 @@
+#ifndef XDR_RDS_AF_H_
+#define XDR_RDS_AF_H_
+#include <glib.h>
+
+/* 0A AF codes: 1-204 are FM frequencies (87.6 - 107.9 MHz) */
+#define RDS_AF_CODES      205
+#define RDS_AF_FILLER     205
+#define RDS_AF_COUNT_MIN  224
+#define RDS_AF_COUNT_MAX  249
+#define RDS_AF_LFMF       250
+
+/* Codes in one list, the merged set may hold every FM frequency */
+#define RDS_AF_MAX   25
+#define RDS_AF_LISTS  8
+
+enum rds_af_method
+{
+    RDS_AF_METHOD_UNKNOWN,
+    RDS_AF_METHOD_A,
+    RDS_AF_METHOD_B
+};
+
+typedef struct rds_af_set
+{
+    guint32 bits[(RDS_AF_CODES + 31) / 32];
+} rds_af_set_t;
+
+/* AF list sent for one transmitter, the alternatives sorted by frequency */
+typedef struct rds_af_list
+{
+    guchar freq;
+    gint method;
+    gint expected;
+    rds_af_set_t set;
+    rds_af_set_t regional;  /* method B: regional variants */
+    guchar af[RDS_AF_MAX];
+    gint count;
+} rds_af_list_t;
+
+/* All alternatives of a PI, merged from every list */
+typedef struct rds_af
+{
+    rds_af_set_t set;
+    guchar freq[RDS_AF_CODES];
+    gint count;
+    rds_af_list_t lists[RDS_AF_LISTS];
+    gint list_count;
+    rds_af_set_t unlisted;  /* transmitters of lists beyond RDS_AF_LISTS */
+    gint current;
+    gboolean lfmf;
+} rds_af_t;
+
+void rds_af_clear(rds_af_t*);
+gint rds_af_pair(rds_af_t*, guchar, guchar, guchar*, const rds_af_list_t**);
+gboolean rds_af_set_has(const rds_af_set_t*, guint);
+
+#endif
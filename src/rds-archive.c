@@ -0,0 +1,707 @@
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <string.h>
+#include "rds-archive.h"
+
+/* File: a header, chunks of up to RDS_ARCHIVE_CHUNK groups and an
+ * index written on close: the first and last time of every chunk and
+ * sorted (PI, chunk) pairs, followed by a fixed size trailer. A file
+ * without the index (not closed) is scanned chunk by chunk instead.
+ *
+ * Chunk records, the state at the chunk start is kept in its header:
+ *   0x00-0x3F  group: error bits, time delta (ms, varint), blocks B, C, D
+ *   0x40-0x43  PI with the error level in the low bits, 2 bytes
+ *   0x44       frequency (varint), the PI is unknown again
+ * A group usually takes 8 bytes. All values are little-endian,
+ * except the blocks which are stored as transmitted. */
+#define RDS_ARCHIVE_MAGIC       "XDRRDSA1"
+#define RDS_ARCHIVE_INDEX_MAGIC "XDRRDSIX"
+#define RDS_ARCHIVE_CHUNK_MAGIC 0x4B4E4843
+#define RDS_ARCHIVE_BUFFER      (RDS_ARCHIVE_CHUNK * 16)
+#define RDS_ARCHIVE_RECORD_MAX  17
+
+#define RDS_ARCHIVE_TAG_PI   0x40
+#define RDS_ARCHIVE_TAG_FREQ 0x44
+
+typedef struct rds_archive_header
+{
+    gchar magic[8];
+    guint32 chunk;
+    guint32 reserved;
+} rds_archive_header_t;
+
+typedef struct rds_archive_chunk
+{
+    guint32 magic;
+    guint32 size;
+    guint32 count;
+    gint32 freq;
+    gint64 time;
+    gint32 pi;
+    gint32 pi_err_level;
+} rds_archive_chunk_t;
+
+typedef struct rds_archive_index
+{
+    gint64 first;
+    gint64 last;
+    guint64 offset;
+    guint32 count;
+    guint32 reserved;
+} rds_archive_index_t;
+
+typedef struct rds_archive_pi
+{
+    guint32 pi;
+    guint32 chunk;
+} rds_archive_pi_t;
+
+typedef struct rds_archive_trailer
+{
+    guint64 index;
+    guint32 chunks;
+    guint32 pis;
+    gchar magic[8];
+} rds_archive_trailer_t;
+
+G_STATIC_ASSERT(sizeof(rds_archive_header_t) == 16);
+G_STATIC_ASSERT(sizeof(rds_archive_chunk_t) == 32);
+G_STATIC_ASSERT(sizeof(rds_archive_index_t) == 32);
+G_STATIC_ASSERT(sizeof(rds_archive_pi_t) == 8);
+G_STATIC_ASSERT(sizeof(rds_archive_trailer_t) == 24);
+
+struct rds_archive
+{
+    FILE *file;
+    gboolean failed;
+    guint64 offset;
+    rds_archive_chunk_t chunk;
+    guchar buffer[RDS_ARCHIVE_BUFFER];
+    gsize size;
+    gint64 last;
+    gint freq;
+    gint pi;
+    gint pi_err_level;
+    GArray *index;
+    GArray *pis;
+    guint chunk_pis;
+};
+
+struct rds_archive_reader
+{
+    GMappedFile *file;
+    const guchar *data;
+    gsize size;
+    GArray *index;
+    GArray *pis;
+    guint64 count;
+
+    guint chunk;
+    const guchar *pos;
+    const guchar *end;
+    gint64 time;
+    gint freq;
+    gint pi;
+    gint pi_err_level;
+
+    gboolean pending;
+    rds_archive_group_t group;
+};
+
+static void rds_archive_write(rds_archive_t*, gconstpointer, gsize);
+static void rds_archive_varint(rds_archive_t*, guint64);
+static void rds_archive_index_pi(rds_archive_t*, gint);
+static void rds_archive_flush(rds_archive_t*);
+static gint rds_archive_pi_compare(gconstpointer, gconstpointer);
+static gboolean rds_archive_load_index(rds_archive_reader_t*);
+static void rds_archive_scan(rds_archive_reader_t*);
+static gboolean rds_archive_load_chunk(rds_archive_reader_t*, guint);
+static gboolean rds_archive_read_varint(const guchar**, const guchar*, guint64*);
+static gboolean rds_archive_read(rds_archive_reader_t*, rds_archive_group_t*);
+
+rds_archive_t*
+rds_archive_new(const gchar *path)
+{
+    rds_archive_t *archive;
+    rds_archive_header_t header;
+    FILE *file = g_fopen(path, "wb");
+
+    if(!file)
+        return NULL;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RDS_ARCHIVE_MAGIC, sizeof(header.magic));
+    header.chunk = GUINT32_TO_LE(RDS_ARCHIVE_CHUNK);
+
+    archive = g_new0(rds_archive_t, 1);
+    archive->file = file;
+    archive->freq = -1;
+    archive->pi = -1;
+    archive->index = g_array_new(FALSE, FALSE, sizeof(rds_archive_index_t));
+    archive->pis = g_array_new(FALSE, FALSE, sizeof(rds_archive_pi_t));
+    rds_archive_write(archive, &header, sizeof(header));
+    archive->offset = sizeof(header);
+    return archive;
+}
+
+void
+rds_archive_freq(rds_archive_t *archive,
+                 gint           freq)
+{
+    if(archive->freq == freq)
+        return;
+
+    archive->freq = freq;
+    archive->pi = -1;
+    archive->pi_err_level = 0;
+
+    /* Before the first group the state goes to the chunk header */
+    if(archive->size > RDS_ARCHIVE_BUFFER - RDS_ARCHIVE_RECORD_MAX)
+        rds_archive_flush(archive);
+    if(!archive->chunk.count)
+        return;
+
+    archive->buffer[archive->size++] = RDS_ARCHIVE_TAG_FREQ;
+    rds_archive_varint(archive, MAX(freq, 0));
+}
+
+void
+rds_archive_pi(rds_archive_t *archive,
+               gint           pi,
+               gint           err_level)
+{
+    if(archive->pi == pi &&
+       archive->pi_err_level == err_level)
+        return;
+
+    archive->pi = pi;
+    archive->pi_err_level = err_level;
+
+    if(archive->size > RDS_ARCHIVE_BUFFER - RDS_ARCHIVE_RECORD_MAX)
+        rds_archive_flush(archive);
+    if(!archive->chunk.count)
+        return;
+
+    archive->buffer[archive->size++] = RDS_ARCHIVE_TAG_PI | (err_level & 3);
+    archive->buffer[archive->size++] = pi >> 8;
+    archive->buffer[archive->size++] = pi & 0xFF;
+    rds_archive_index_pi(archive, pi);
+}
+
+void
+rds_archive_group(rds_archive_t *archive,
+                  gint64         time,
+                  const guint16 *data,
+                  guint          errors)
+{
+    gint64 ms = time / 1000;
+    gint i;
+
+    if(!archive->chunk.count)
+    {
+        archive->chunk.time = ms;
+        archive->chunk.freq = archive->freq;
+        archive->chunk.pi = archive->pi;
+        archive->chunk.pi_err_level = archive->pi_err_level;
+        archive->last = ms;
+        if(archive->pi >= 0)
+            rds_archive_index_pi(archive, archive->pi);
+    }
+
+    /* Keep the time monotonic for the index, even if the clock is set back */
+    ms = MAX(ms, archive->last);
+
+    archive->buffer[archive->size++] = errors & 0x3F;
+    rds_archive_varint(archive, ms - archive->last);
+    for(i=0; i<3; i++)
+    {
+        archive->buffer[archive->size++] = data[i] >> 8;
+        archive->buffer[archive->size++] = data[i] & 0xFF;
+    }
+    archive->last = ms;
+
+    if(++archive->chunk.count == RDS_ARCHIVE_CHUNK ||
+       archive->size > RDS_ARCHIVE_BUFFER - 2 * RDS_ARCHIVE_RECORD_MAX)
+        rds_archive_flush(archive);
+}
+
+void
+rds_archive_close(rds_archive_t *archive)
+{
+    rds_archive_trailer_t trailer;
+    rds_archive_index_t entry;
+    rds_archive_pi_t pi;
+    guint i;
+
+    if(archive->chunk.count)
+        rds_archive_flush(archive);
+
+    g_array_sort(archive->pis, rds_archive_pi_compare);
+
+    for(i=0; i<archive->index->len; i++)
+    {
+        entry = g_array_index(archive->index, rds_archive_index_t, i);
+        entry.first = GINT64_TO_LE(entry.first);
+        entry.last = GINT64_TO_LE(entry.last);
+        entry.offset = GUINT64_TO_LE(entry.offset);
+        entry.count = GUINT32_TO_LE(entry.count);
+        rds_archive_write(archive, &entry, sizeof(entry));
+    }
+
+    for(i=0; i<archive->pis->len; i++)
+    {
+        pi = g_array_index(archive->pis, rds_archive_pi_t, i);
+        pi.pi = GUINT32_TO_LE(pi.pi);
+        pi.chunk = GUINT32_TO_LE(pi.chunk);
+        rds_archive_write(archive, &pi, sizeof(pi));
+    }
+
+    trailer.index = GUINT64_TO_LE(archive->offset);
+    trailer.chunks = GUINT32_TO_LE(archive->index->len);
+    trailer.pis = GUINT32_TO_LE(archive->pis->len);
+    memcpy(trailer.magic, RDS_ARCHIVE_INDEX_MAGIC, sizeof(trailer.magic));
+    rds_archive_write(archive, &trailer, sizeof(trailer));
+
+    fclose(archive->file);
+    g_array_free(archive->index, TRUE);
+    g_array_free(archive->pis, TRUE);
+    g_free(archive);
+}
+
+static void
+rds_archive_write(rds_archive_t *archive,
+                  gconstpointer  data,
+                  gsize          size)
+{
+    /* After a failed write the file is left as it is */
+    if(!archive->failed &&
+       fwrite(data, 1, size, archive->file) != size)
+        archive->failed = TRUE;
+}
+
+static void
+rds_archive_varint(rds_archive_t *archive,
+                   guint64        value)
+{
+    while(value >= 0x80)
+    {
+        archive->buffer[archive->size++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    archive->buffer[archive->size++] = value;
+}
+
+static void
+rds_archive_index_pi(rds_archive_t *archive,
+                     gint           pi)
+{
+    rds_archive_pi_t entry;
+    guint i;
+
+    /* A chunk rarely has more than a few PIs */
+    for(i=archive->chunk_pis; i<archive->pis->len; i++)
+        if(g_array_index(archive->pis, rds_archive_pi_t, i).pi == (guint32)pi)
+            return;
+
+    entry.pi = pi;
+    entry.chunk = archive->index->len;
+    g_array_append_val(archive->pis, entry);
+}
+
+static void
+rds_archive_flush(rds_archive_t *archive)
+{
+    rds_archive_chunk_t chunk;
+    rds_archive_index_t entry;
+
+    chunk.magic = GUINT32_TO_LE(RDS_ARCHIVE_CHUNK_MAGIC);
+    chunk.size = GUINT32_TO_LE(archive->size);
+    chunk.count = GUINT32_TO_LE(archive->chunk.count);
+    chunk.freq = GINT32_TO_LE(archive->chunk.freq);
+    chunk.time = GINT64_TO_LE(archive->chunk.time);
+    chunk.pi = GINT32_TO_LE(archive->chunk.pi);
+    chunk.pi_err_level = GINT32_TO_LE(archive->chunk.pi_err_level);
+    rds_archive_write(archive, &chunk, sizeof(chunk));
+    rds_archive_write(archive, archive->buffer, archive->size);
+    if(!archive->failed)
+        fflush(archive->file);
+
+    entry.first = archive->chunk.time;
+    entry.last = archive->last;
+    entry.offset = archive->offset;
+    entry.count = archive->chunk.count;
+    entry.reserved = 0;
+    g_array_append_val(archive->index, entry);
+
+    archive->offset += sizeof(chunk) + archive->size;
+    archive->size = 0;
+    archive->chunk.count = 0;
+    archive->chunk_pis = archive->pis->len;
+}
+
+static gint
+rds_archive_pi_compare(gconstpointer a,
+                       gconstpointer b)
+{
+    const rds_archive_pi_t *x = a;
+    const rds_archive_pi_t *y = b;
+
+    if(x->pi != y->pi)
+        return (x->pi < y->pi ? -1 : 1);
+    if(x->chunk != y->chunk)
+        return (x->chunk < y->chunk ? -1 : 1);
+    return 0;
+}
+
+rds_archive_reader_t*
+rds_archive_reader_open(const gchar *path)
+{
+    rds_archive_reader_t *reader;
+    GMappedFile *file = g_mapped_file_new(path, FALSE, NULL);
+
+    if(!file)
+        return NULL;
+
+    if(g_mapped_file_get_length(file) < sizeof(rds_archive_header_t) ||
+       memcmp(g_mapped_file_get_contents(file), RDS_ARCHIVE_MAGIC, strlen(RDS_ARCHIVE_MAGIC)))
+    {
+        g_mapped_file_unref(file);
+        return NULL;
+    }
+
+    reader = g_new0(rds_archive_reader_t, 1);
+    reader->file = file;
+    reader->data = (const guchar*)g_mapped_file_get_contents(file);
+    reader->size = g_mapped_file_get_length(file);
+    reader->index = g_array_new(FALSE, FALSE, sizeof(rds_archive_index_t));
+    reader->pis = g_array_new(FALSE, FALSE, sizeof(rds_archive_pi_t));
+
+    if(!rds_archive_load_index(reader))
+        rds_archive_scan(reader);
+
+    rds_archive_rewind(reader);
+    return reader;
+}
+
+void
+rds_archive_reader_free(rds_archive_reader_t *reader)
+{
+    g_mapped_file_unref(reader->file);
+    g_array_free(reader->index, TRUE);
+    g_array_free(reader->pis, TRUE);
+    g_free(reader);
+}
+
+guint64
+rds_archive_reader_count(const rds_archive_reader_t *reader)
+{
+    return reader->count;
+}
+
+gboolean
+rds_archive_reader_range(const rds_archive_reader_t *reader,
+                         gint64                     *first,
+                         gint64                     *last)
+{
+    if(!reader->index->len)
+        return FALSE;
+
+    *first = g_array_index(reader->index, rds_archive_index_t, 0).first * 1000;
+    *last = g_array_index(reader->index, rds_archive_index_t, reader->index->len - 1).last * 1000;
+    return TRUE;
+}
+
+void
+rds_archive_rewind(rds_archive_reader_t *reader)
+{
+    reader->chunk = 0;
+    reader->pos = NULL;
+    reader->end = NULL;
+    reader->pending = FALSE;
+}
+
+gboolean
+rds_archive_seek_time(rds_archive_reader_t *reader,
+                      gint64                time)
+{
+    /* Last chunk starting at or before the time, then a linear scan */
+    rds_archive_index_t *index = (rds_archive_index_t*)reader->index->data;
+    gint64 ms = time / 1000;
+    guint low = 0, high = reader->index->len, mid;
+
+    while(low < high)
+    {
+        mid = low + (high - low) / 2;
+        if(index[mid].first <= ms)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    rds_archive_rewind(reader);
+    rds_archive_load_chunk(reader, (low ? low - 1 : 0));
+    while(rds_archive_next(reader, &reader->group))
+    {
+        if(reader->group.time >= time)
+        {
+            reader->pending = TRUE;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+gboolean
+rds_archive_seek_pi(rds_archive_reader_t *reader,
+                    gint                  pi)
+{
+    /* First chunk where the PI was received, then a linear scan */
+    rds_archive_pi_t *pis = (rds_archive_pi_t*)reader->pis->data;
+    guint low = 0, high = reader->pis->len, mid;
+
+    while(low < high)
+    {
+        mid = low + (high - low) / 2;
+        if(pis[mid].pi < (guint32)pi)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    rds_archive_rewind(reader);
+    if(low == reader->pis->len || pis[low].pi != (guint32)pi)
+        return FALSE;
+
+    rds_archive_load_chunk(reader, pis[low].chunk);
+    while(rds_archive_next(reader, &reader->group))
+    {
+        if(reader->group.pi == pi)
+        {
+            reader->pending = TRUE;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+gboolean
+rds_archive_next(rds_archive_reader_t *reader,
+                 rds_archive_group_t  *group)
+{
+    if(reader->pending)
+    {
+        reader->pending = FALSE;
+        *group = reader->group;
+        return TRUE;
+    }
+
+    while(!rds_archive_read(reader, group))
+    {
+        if(reader->chunk >= reader->index->len)
+            return FALSE;
+        rds_archive_load_chunk(reader, reader->chunk);
+    }
+    return TRUE;
+}
+
+static gboolean
+rds_archive_load_index(rds_archive_reader_t *reader)
+{
+    rds_archive_trailer_t trailer;
+    rds_archive_index_t entry;
+    rds_archive_pi_t pi;
+    const guchar *ptr;
+    guint64 index;
+    guint32 chunks, pis;
+    guint i;
+
+    if(reader->size < sizeof(rds_archive_header_t) + sizeof(trailer))
+        return FALSE;
+
+    memcpy(&trailer, reader->data + reader->size - sizeof(trailer), sizeof(trailer));
+    if(memcmp(trailer.magic, RDS_ARCHIVE_INDEX_MAGIC, sizeof(trailer.magic)))
+        return FALSE;
+
+    index = GUINT64_FROM_LE(trailer.index);
+    chunks = GUINT32_FROM_LE(trailer.chunks);
+    pis = GUINT32_FROM_LE(trailer.pis);
+    if(index < sizeof(rds_archive_header_t) ||
+       index + (guint64)chunks * sizeof(entry) + (guint64)pis * sizeof(pi) + sizeof(trailer) != reader->size)
+        return FALSE;
+
+    ptr = reader->data + index;
+    for(i=0; i<chunks; i++, ptr += sizeof(entry))
+    {
+        memcpy(&entry, ptr, sizeof(entry));
+        entry.first = GINT64_FROM_LE(entry.first);
+        entry.last = GINT64_FROM_LE(entry.last);
+        entry.offset = GUINT64_FROM_LE(entry.offset);
+        entry.count = GUINT32_FROM_LE(entry.count);
+        if(entry.offset + sizeof(rds_archive_chunk_t) > index)
+            break;
+        g_array_append_val(reader->index, entry);
+        reader->count += entry.count;
+    }
+
+    for(i=0; i<pis; i++, ptr += sizeof(pi))
+    {
+        memcpy(&pi, ptr, sizeof(pi));
+        pi.pi = GUINT32_FROM_LE(pi.pi);
+        pi.chunk = GUINT32_FROM_LE(pi.chunk);
+        if(pi.chunk < reader->index->len)
+            g_array_append_val(reader->pis, pi);
+    }
+    return TRUE;
+}
+
+static void
+rds_archive_scan(rds_archive_reader_t *reader)
+{
+    /* Recording was interrupted: rebuild the index from complete chunks */
+    rds_archive_chunk_t chunk;
+    rds_archive_index_t entry;
+    rds_archive_pi_t pi;
+    rds_archive_group_t group;
+    gsize offset = sizeof(rds_archive_header_t);
+    gint last_pi;
+
+    while(offset + sizeof(chunk) <= reader->size)
+    {
+        memcpy(&chunk, reader->data + offset, sizeof(chunk));
+        if(GUINT32_FROM_LE(chunk.magic) != RDS_ARCHIVE_CHUNK_MAGIC ||
+           offset + sizeof(chunk) + GUINT32_FROM_LE(chunk.size) > reader->size)
+            break;
+
+        entry.first = GINT64_FROM_LE(chunk.time);
+        entry.last = entry.first;
+        entry.offset = offset;
+        entry.count = 0;
+        entry.reserved = 0;
+        g_array_append_val(reader->index, entry);
+
+        last_pi = -1;
+        rds_archive_load_chunk(reader, reader->index->len - 1);
+        while(rds_archive_read(reader, &group))
+        {
+            entry.last = group.time / 1000;
+            entry.count++;
+            if(group.pi >= 0 && group.pi != last_pi)
+            {
+                pi.pi = group.pi;
+                pi.chunk = reader->index->len - 1;
+                g_array_append_val(reader->pis, pi);
+                last_pi = group.pi;
+            }
+        }
+        g_array_index(reader->index, rds_archive_index_t, reader->index->len - 1) = entry;
+        reader->count += entry.count;
+        offset += sizeof(chunk) + GUINT32_FROM_LE(chunk.size);
+    }
+
+    g_array_sort(reader->pis, rds_archive_pi_compare);
+}
+
+static gboolean
+rds_archive_load_chunk(rds_archive_reader_t *reader,
+                       guint                 i)
+{
+    const rds_archive_index_t *entry;
+    rds_archive_chunk_t chunk;
+    guint32 size;
+
+    reader->chunk = i + 1;
+    reader->pos = reader->end = NULL;
+    if(i >= reader->index->len)
+        return FALSE;
+
+    entry = &g_array_index(reader->index, rds_archive_index_t, i);
+    memcpy(&chunk, reader->data + entry->offset, sizeof(chunk));
+    size = GUINT32_FROM_LE(chunk.size);
+    if(GUINT32_FROM_LE(chunk.magic) != RDS_ARCHIVE_CHUNK_MAGIC ||
+       entry->offset + sizeof(chunk) + size > reader->size)
+        return FALSE;
+
+    reader->pos = reader->data + entry->offset + sizeof(chunk);
+    reader->end = reader->pos + size;
+    reader->time = GINT64_FROM_LE(chunk.time);
+    reader->freq = GINT32_FROM_LE(chunk.freq);
+    reader->pi = GINT32_FROM_LE(chunk.pi);
+    reader->pi_err_level = GINT32_FROM_LE(chunk.pi_err_level);
+    return TRUE;
+}
+
+static gboolean
+rds_archive_read_varint(const guchar **pos,
+                        const guchar  *end,
+                        guint64       *value)
+{
+    const guchar *ptr = *pos;
+    gint shift = 0;
+
+    *value = 0;
+    while(ptr < end && shift < 64)
+    {
+        *value |= (guint64)(*ptr & 0x7F) << shift;
+        if(!(*ptr++ & 0x80))
+        {
+            *pos = ptr;
+            return TRUE;
+        }
+        shift += 7;
+    }
+    return FALSE;
+}
+
+static gboolean
+rds_archive_read(rds_archive_reader_t *reader,
+                 rds_archive_group_t  *group)
+{
+    const guchar *pos = reader->pos;
+    const guchar *end = reader->end;
+    guint64 value;
+    guchar tag;
+
+    while(pos < end)
+    {
+        tag = *pos++;
+        if(tag < RDS_ARCHIVE_TAG_PI)
+        {
+            if(!rds_archive_read_varint(&pos, end, &value) || end - pos < 6)
+                break;
+            reader->time += value;
+            group->time = reader->time * 1000;
+            group->freq = reader->freq;
+            group->pi = reader->pi;
+            group->pi_err_level = reader->pi_err_level;
+            group->data[0] = (pos[0] << 8) | pos[1];
+            group->data[1] = (pos[2] << 8) | pos[3];
+            group->data[2] = (pos[4] << 8) | pos[5];
+            group->errors = tag;
+            reader->pos = pos + 6;
+            return TRUE;
+        }
+        else if((tag & ~3) == RDS_ARCHIVE_TAG_PI)
+        {
+            if(end - pos < 2)
+                break;
+            reader->pi = (pos[0] << 8) | pos[1];
+            reader->pi_err_level = tag & 3;
+            pos += 2;
+        }
+        else if(tag == RDS_ARCHIVE_TAG_FREQ)
+        {
+            if(!rds_archive_read_varint(&pos, end, &value))
+                break;
+            reader->freq = value;
+            reader->pi = -1;
+            reader->pi_err_level = 0;
+        }
+        else
+            break;
+    }
+
+    /* End of the chunk, a damaged record ends it early */
+    reader->pos = reader->end;
+    return FALSE;
+}
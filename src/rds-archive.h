@@ -0,0 +1,40 @@
+#ifndef XDR_RDS_ARCHIVE_H_
+#define XDR_RDS_ARCHIVE_H_
+#include <glib.h>
+
+/* Groups per chunk, the unit of the time and PI index */
+#define RDS_ARCHIVE_CHUNK 1024
+
+typedef struct rds_archive rds_archive_t;
+typedef struct rds_archive_reader rds_archive_reader_t;
+
+/* Group as read back: wall clock time in microseconds (stored
+ * with millisecond resolution), tuned frequency in kHz, last PI
+ * received (-1 if none yet) with its error level, blocks B, C, D
+ * and their error levels packed by two bits (B in lowest) */
+typedef struct rds_archive_group
+{
+    gint64 time;
+    gint freq;
+    gint pi;
+    gint pi_err_level;
+    guint16 data[3];
+    guint errors;
+} rds_archive_group_t;
+
+rds_archive_t* rds_archive_new(const gchar*);
+void rds_archive_freq(rds_archive_t*, gint);
+void rds_archive_pi(rds_archive_t*, gint, gint);
+void rds_archive_group(rds_archive_t*, gint64, const guint16*, guint);
+void rds_archive_close(rds_archive_t*);
+
+rds_archive_reader_t* rds_archive_reader_open(const gchar*);
+void rds_archive_reader_free(rds_archive_reader_t*);
+guint64 rds_archive_reader_count(const rds_archive_reader_t*);
+gboolean rds_archive_reader_range(const rds_archive_reader_t*, gint64*, gint64*);
+void rds_archive_rewind(rds_archive_reader_t*);
+gboolean rds_archive_seek_time(rds_archive_reader_t*, gint64);
+gboolean rds_archive_seek_pi(rds_archive_reader_t*, gint);
+gboolean rds_archive_next(rds_archive_reader_t*, rds_archive_group_t*);
+
+#endif
@@ -0,0 +1,68 @@
+#include <glib.h>
+#include <string.h>
+#include "rds-cache.h"
+
+static rds_cache_entry_t* rds_cache_find(rds_cache_t*, gint);
+
+void
+rds_cache_clear(rds_cache_t *cache)
+{
+    gint i;
+
+    for(i=0; i<RDS_CACHE_SIZE; i++)
+    {
+        cache->entries[i].freq = 0;
+        cache->entries[i].used = 0;
+    }
+    cache->clock = 0;
+}
+
+void
+rds_cache_store(rds_cache_t         *cache,
+                gint                 freq,
+                const rds_decoder_t *decoder)
+{
+    rds_cache_entry_t *entry = rds_cache_find(cache, freq);
+    gint i;
+
+    if(!entry)
+    {
+        /* Replace a free or the least recently used entry */
+        entry = &cache->entries[0];
+        for(i=1; i<RDS_CACHE_SIZE; i++)
+            if(cache->entries[i].used < entry->used)
+                entry = &cache->entries[i];
+        entry->freq = freq;
+    }
+
+    entry->used = ++cache->clock;
+    memcpy(&entry->state, decoder, sizeof(rds_decoder_t));
+}
+
+const rds_decoder_t*
+rds_cache_lookup(rds_cache_t *cache,
+                 gint         freq)
+{
+    rds_cache_entry_t *entry = rds_cache_find(cache, freq);
+
+    if(!entry)
+        return NULL;
+
+    entry->used = ++cache->clock;
+    return &entry->state;
+}
+
+static rds_cache_entry_t*
+rds_cache_find(rds_cache_t *cache,
+               gint         freq)
+{
+    gint i;
+
+    if(freq <= 0)
+        return NULL;
+
+    for(i=0; i<RDS_CACHE_SIZE; i++)
+        if(cache->entries[i].used && cache->entries[i].freq == freq)
+            return &cache->entries[i];
+    return NULL;
+}
@@ -0,0 +1,26 @@
+#ifndef XDR_RDS_CACHE_H_
+#define XDR_RDS_CACHE_H_
+#include <glib.h>
+#include "rds-decoder.h"
+
+#define RDS_CACHE_SIZE 16
+
+/* Decoder state of recently tuned frequencies, least recently used is replaced */
+typedef struct rds_cache_entry
+{
+    gint freq;
+    guint64 used;
+    rds_decoder_t state;
+} rds_cache_entry_t;
+
+typedef struct rds_cache
+{
+    rds_cache_entry_t entries[RDS_CACHE_SIZE];
+    guint64 clock;
+} rds_cache_t;
+
+void rds_cache_clear(rds_cache_t*);
+void rds_cache_store(rds_cache_t*, gint, const rds_decoder_t*);
+const rds_decoder_t* rds_cache_lookup(rds_cache_t*, gint);
+
+#endif
@@ -0,0 +1,1221 @@
+#include <glib.h>
+#include <string.h>
+#include "rds-decoder.h"
+
+typedef void (*rds_group_func_t)(rds_decoder_t*, const guint16*, const guchar*);
+
+static void rds_decoder_emit(rds_decoder_t*, const rds_event_t*);
+static void rds_decoder_copy(rds_decoder_t*, const rds_decoder_t*);
+static void rds_decoder_replay(rds_decoder_t*);
+static gint rds_decoder_value(const rds_decoder_t*, gint);
+static void rds_decoder_changes(rds_decoder_t*, const rds_decoder_t*);
+static void rds_decoder_set(rds_decoder_t*, gint*, gint, gint);
+static void rds_decoder_info(rds_decoder_t*, const guint16*, const guchar*);
+static void rds_decoder_ta_ms(rds_decoder_t*, const guint16*, const guchar*);
+static void rds_decoder_vote_reset(rds_decoder_t*);
+static void rds_decoder_ps(rds_decoder_t*, const guint16*, const guchar*);
+static gboolean rds_decoder_ps_vote(rds_decoder_t*, gint, const gchar*, guchar);
+static void rds_decoder_rt(rds_decoder_t*, gint, gint, const gchar*, const guchar*, gint, guchar);
+static gboolean rds_decoder_rt_vote(rds_decoder_t*, gint, gint, const gchar*, const guchar*, gint, guchar);
+static void rds_decoder_rt_received(rds_decoder_t*, gint, gint, const guchar*, gint, guchar);
+static void rds_decoder_0a(rds_decoder_t*, const guint16*, const guchar*);
+static void rds_decoder_0b(rds_decoder_t*, const guint16*, const guchar*);
+static void rds_decoder_1a(rds_decoder_t*, const guint16*, const guchar*);
+static void rds_decoder_2a(rds_decoder_t*, const guint16*, const guchar*);
+static void rds_decoder_2b(rds_decoder_t*, const guint16*, const guchar*);
+static void rds_decoder_3a(rds_decoder_t*, const guint16*, const guchar*);
+static void rds_decoder_4a(rds_decoder_t*, const guint16*, const guchar*);
+static void rds_decoder_10a(rds_decoder_t*, const guint16*, const guchar*);
+static void rds_decoder_14a(rds_decoder_t*, const guint16*, const guchar*);
+static void rds_decoder_14b(rds_decoder_t*, const guint16*, const guchar*);
+static void rds_decoder_15a(rds_decoder_t*, const guint16*, const guchar*);
+static void rds_decoder_15b(rds_decoder_t*, const guint16*, const guchar*);
+static void rds_decoder_rtplus(rds_decoder_t*, const guint16*, const guchar*);
+static rds_eon_t* rds_decoder_eon(rds_decoder_t*, gint);
+
+/* Groups without a handler may carry an open data application announced in 3A */
+static const rds_group_func_t rds_group_handlers[RDS_GROUP_COUNT] =
+{
+    [RDS_GROUP(0, 0)]  = rds_decoder_0a,
+    [RDS_GROUP(0, 1)]  = rds_decoder_0b,
+    [RDS_GROUP(1, 0)]  = rds_decoder_1a,
+    [RDS_GROUP(2, 0)]  = rds_decoder_2a,
+    [RDS_GROUP(2, 1)]  = rds_decoder_2b,
+    [RDS_GROUP(3, 0)]  = rds_decoder_3a,
+    [RDS_GROUP(4, 0)]  = rds_decoder_4a,
+    [RDS_GROUP(10, 0)] = rds_decoder_10a,
+    [RDS_GROUP(14, 0)] = rds_decoder_14a,
+    [RDS_GROUP(14, 1)] = rds_decoder_14b,
+    [RDS_GROUP(15, 0)] = rds_decoder_15a,
+    [RDS_GROUP(15, 1)] = rds_decoder_15b
+};
+
+void
+rds_decoder_init(rds_decoder_t *decoder)
+{
+    memset(&decoder->config, 0, sizeof(rds_decoder_config_t));
+    decoder->subscriber_count = 0;
+    decoder->mask = 0;
+    rds_decoder_reset(decoder);
+}
+
+gboolean
+rds_decoder_subscribe(rds_decoder_t      *decoder,
+                      guint32             mask,
+                      rds_decoder_func_t  func,
+                      gpointer            data)
+{
+    rds_subscriber_t *subscriber;
+
+    if(decoder->subscriber_count >= RDS_SUBSCRIBERS)
+        return FALSE;
+
+    subscriber = &decoder->subscribers[decoder->subscriber_count++];
+    subscriber->mask = mask;
+    subscriber->func = func;
+    subscriber->data = data;
+    decoder->mask |= mask;
+    return TRUE;
+}
+
+void
+rds_decoder_reset(rds_decoder_t *decoder)
+{
+    gint i;
+
+    decoder->provisional = FALSE;
+    decoder->pi = -1;
+    decoder->pi_err_level = G_MAXINT;
+    decoder->pty = -1;
+    decoder->tp = -1;
+    decoder->ta = -1;
+    decoder->ms = -1;
+    decoder->ecc = -1;
+    rds_af_clear(&decoder->af);
+
+    memset(decoder->ps, ' ', RDS_PS_LEN);
+    decoder->ps[RDS_PS_LEN] = 0;
+    for(i=0; i<RDS_PS_LEN; i++)
+        decoder->ps_err[i] = 0xFF;
+
+    for(i=0; i<2; i++)
+    {
+        memset(decoder->rt[i], ' ', RDS_RT_LEN);
+        decoder->rt[i][RDS_RT_LEN] = 0;
+        decoder->rt_received[i] = 0;
+        decoder->rt_length[i] = 0;
+    }
+
+    rds_decoder_vote_reset(decoder);
+
+    memset(&decoder->ct, 0, sizeof(rds_ct_t));
+
+    memset(decoder->ptyn, ' ', RDS_PTYN_LEN);
+    decoder->ptyn[RDS_PTYN_LEN] = 0;
+    decoder->ptyn_flag = -1;
+
+    memset(decoder->lps, ' ', RDS_LPS_LEN);
+    decoder->lps[RDS_LPS_LEN] = 0;
+
+    decoder->eon_count = 0;
+    memset(decoder->oda, 0, sizeof(decoder->oda));
+    memset(&decoder->rtplus, 0, sizeof(rds_rtplus_t));
+}
+
+gboolean
+rds_decoder_pi(rds_decoder_t *decoder,
+               gint           pi,
+               gint           err_level)
+{
+    rds_event_t event;
+
+    /* The first PI after a restore confirms or discards the state,
+     * a different PI must be error-free to do the latter */
+    if(decoder->provisional)
+    {
+        if(decoder->pi != pi && err_level)
+            return FALSE;
+
+        decoder->provisional = FALSE;
+        event.type = RDS_EVENT_RESTORE;
+        event.value = (decoder->pi == pi);
+        if(!event.value)
+            rds_decoder_reset(decoder);
+        rds_decoder_emit(decoder, &event);
+
+        if(event.value)
+        {
+            decoder->pi_err_level = err_level;
+            rds_decoder_replay(decoder);
+            return TRUE;
+        }
+    }
+
+    /* A PI with more errors can't replace the current one */
+    if(err_level > decoder->pi_err_level &&
+       decoder->pi != pi)
+        return FALSE;
+
+    if(decoder->pi == pi &&
+       err_level >= decoder->pi_err_level)
+        return TRUE;
+
+    /* Votes and AF lists collected for another station are worthless */
+    if(decoder->pi >= 0 && decoder->pi != pi)
+    {
+        rds_decoder_vote_reset(decoder);
+        rds_af_clear(&decoder->af);
+    }
+
+    decoder->pi = pi;
+    if(err_level < decoder->pi_err_level)
+        decoder->pi_err_level = err_level;
+
+    event.type = RDS_EVENT_PI;
+    event.value = pi;
+    rds_decoder_emit(decoder, &event);
+    return TRUE;
+}
+
+void
+rds_decoder_group(rds_decoder_t *decoder,
+                  const guint16 *data,
+                  guint          errors)
+{
+    guchar err[] = { (errors&3), ((errors&12)>>2), ((errors&48)>>4) };
+    rds_group_func_t handler;
+    rds_event_t event;
+    gint group;
+
+    if(decoder->pi < 0 || decoder->provisional)
+        return;
+
+    if(decoder->mask & RDS_EVENT_MASK(RDS_EVENT_GROUP))
+    {
+        event.type = RDS_EVENT_GROUP;
+        event.group.data = data;
+        event.group.errors = errors;
+        rds_decoder_emit(decoder, &event);
+    }
+
+    /* The group type itself is unknown */
+    if(err[RDS_BLOCK_B] >= 3)
+        return;
+
+    rds_decoder_info(decoder, data, err);
+
+    group = data[RDS_BLOCK_B] >> 11;
+    handler = rds_group_handlers[group];
+    if(!handler && decoder->oda[group] == RDS_AID_RTPLUS)
+        handler = rds_decoder_rtplus;
+
+    if(handler)
+        handler(decoder, data, err);
+}
+
+gboolean
+rds_decoder_ps_complete(const rds_decoder_t *decoder)
+{
+    gint i;
+
+    if(decoder->config.ps_voting)
+        return (decoder->ps_committed == 0xFF);
+
+    for(i=0; i<RDS_PS_LEN; i++)
+        if(decoder->ps_err[i] == 0xFF)
+            return FALSE;
+    return TRUE;
+}
+
+gboolean
+rds_decoder_ps_avail(const rds_decoder_t *decoder)
+{
+    gint i;
+
+    for(i=0; i<RDS_PS_LEN; i++)
+        if(decoder->ps_err[i] != 0xFF)
+            return TRUE;
+    return FALSE;
+}
+
+gboolean
+rds_decoder_rt_avail(const rds_decoder_t *decoder,
+                     gint                 flag)
+{
+    const gchar *text = decoder->rt[flag];
+    gint i;
+
+    for(i=0; i<RDS_RT_LEN && text[i]; i++)
+        if(text[i] != ' ')
+            return TRUE;
+    return (i < RDS_RT_LEN);
+}
+
+gboolean
+rds_decoder_rt_complete(const rds_decoder_t *decoder,
+                        gint                 flag)
+{
+    /* Every character up to the end of the message was received */
+    const gchar *end = memchr(decoder->rt[flag], 0, RDS_RT_LEN);
+    gint length = decoder->rt_length[flag];
+    guint64 mask;
+
+    if(end)
+        length = MIN(length, end - decoder->rt[flag] + 1);
+    if(!length)
+        return FALSE;
+
+    mask = (length < 64 ? (G_GUINT64_CONSTANT(1) << length) - 1 : G_MAXUINT64);
+    return (decoder->rt_received[flag] & mask) == mask;
+}
+
+void
+rds_decoder_restore(rds_decoder_t       *decoder,
+                    const rds_decoder_t *saved)
+{
+    /* Any PI may follow */
+    rds_decoder_copy(decoder, saved);
+    decoder->pi_err_level = G_MAXINT;
+    decoder->provisional = TRUE;
+}
+
+void
+rds_decoder_sync(rds_decoder_t       *view,
+                 const rds_decoder_t *state)
+{
+    /* Brings a copy of a decoder running in another thread up to date,
+     * the subscribers of the copy are notified of the differences */
+    rds_decoder_t old;
+    rds_event_t event;
+
+    memcpy(&old, view, sizeof(rds_decoder_t));
+    rds_decoder_copy(view, state);
+
+    /* Restored state is shown by the client until a PI confirms it */
+    if(view->provisional)
+        return;
+
+    if(old.provisional)
+    {
+        event.type = RDS_EVENT_RESTORE;
+        event.value = (view->pi >= 0 && view->pi == old.pi);
+        rds_decoder_emit(view, &event);
+        rds_decoder_reset(&old);
+    }
+
+    rds_decoder_changes(view, &old);
+}
+
+static void
+rds_decoder_copy(rds_decoder_t       *decoder,
+                 const rds_decoder_t *state)
+{
+    /* Keep the configuration and subscribers */
+    rds_decoder_config_t config = decoder->config;
+    rds_subscriber_t subscribers[RDS_SUBSCRIBERS];
+    gint subscriber_count = decoder->subscriber_count;
+    guint32 mask = decoder->mask;
+
+    memcpy(subscribers, decoder->subscribers, sizeof(subscribers));
+    memcpy(decoder, state, sizeof(rds_decoder_t));
+    decoder->config = config;
+    memcpy(decoder->subscribers, subscribers, sizeof(subscribers));
+    decoder->subscriber_count = subscriber_count;
+    decoder->mask = mask;
+}
+
+static void
+rds_decoder_replay(rds_decoder_t *decoder)
+{
+    /* Confirmed state is reported to the subscribers as if just decoded */
+    rds_decoder_t empty;
+
+    rds_decoder_reset(&empty);
+    rds_decoder_changes(decoder, &empty);
+}
+
+static gint
+rds_decoder_value(const rds_decoder_t *decoder,
+                  gint                 type)
+{
+    switch(type)
+    {
+    case RDS_EVENT_PTY:
+        return decoder->pty;
+    case RDS_EVENT_TP:
+        return decoder->tp;
+    case RDS_EVENT_TA:
+        return decoder->ta;
+    case RDS_EVENT_MS:
+        return decoder->ms;
+    default:
+        return decoder->ecc;
+    }
+}
+
+static void
+rds_decoder_changes(rds_decoder_t       *decoder,
+                    const rds_decoder_t *old)
+{
+    /* Reports everything that differs from an older copy of the state */
+    rds_event_t event;
+    gint i;
+
+    if(decoder->pi >= 0 &&
+       (decoder->pi != old->pi || decoder->pi_err_level != old->pi_err_level))
+    {
+        event.type = RDS_EVENT_PI;
+        event.value = decoder->pi;
+        rds_decoder_emit(decoder, &event);
+    }
+
+    for(i=RDS_EVENT_PTY; i<=RDS_EVENT_ECC; i++)
+    {
+        event.type = i;
+        event.value = rds_decoder_value(decoder, i);
+        if(event.value >= 0 && event.value != rds_decoder_value(old, i))
+            rds_decoder_emit(decoder, &event);
+    }
+
+    event.type = RDS_EVENT_AF;
+    for(i=0; i<decoder->af.count; i++)
+    {
+        event.value = decoder->af.freq[i];
+        if(!rds_af_set_has(&old->af.set, event.value))
+            rds_decoder_emit(decoder, &event);
+    }
+
+    event.type = RDS_EVENT_AF_LIST;
+    for(i=0; i<decoder->af.list_count; i++)
+    {
+        event.af_list = &decoder->af.lists[i];
+        if(i >= old->af.list_count ||
+           memcmp(event.af_list, &old->af.lists[i], sizeof(rds_af_list_t)))
+            rds_decoder_emit(decoder, &event);
+    }
+
+    if(rds_decoder_ps_avail(decoder) &&
+       (memcmp(decoder->ps, old->ps, RDS_PS_LEN) || memcmp(decoder->ps_err, old->ps_err, RDS_PS_LEN)))
+    {
+        event.type = RDS_EVENT_PS;
+        event.ps.text = decoder->ps;
+        event.ps.err = decoder->ps_err;
+        rds_decoder_emit(decoder, &event);
+    }
+
+    for(i=0; i<2; i++)
+    {
+        if(rds_decoder_rt_avail(decoder, i) &&
+           memcmp(decoder->rt[i], old->rt[i], RDS_RT_LEN))
+        {
+            event.type = RDS_EVENT_RT;
+            event.rt.flag = i;
+            event.rt.text = decoder->rt[i];
+            rds_decoder_emit(decoder, &event);
+        }
+    }
+
+    if(decoder->ct.year && memcmp(&decoder->ct, &old->ct, sizeof(rds_ct_t)))
+    {
+        event.type = RDS_EVENT_CT;
+        event.ct = &decoder->ct;
+        rds_decoder_emit(decoder, &event);
+    }
+
+    if(memcmp(decoder->ptyn, old->ptyn, RDS_PTYN_LEN))
+    {
+        event.type = RDS_EVENT_PTYN;
+        event.ptyn = decoder->ptyn;
+        rds_decoder_emit(decoder, &event);
+    }
+
+    if(memcmp(decoder->lps, old->lps, RDS_LPS_LEN))
+    {
+        event.type = RDS_EVENT_LPS;
+        event.lps = decoder->lps;
+        rds_decoder_emit(decoder, &event);
+    }
+
+    event.type = RDS_EVENT_EON;
+    for(i=0; i<decoder->eon_count; i++)
+    {
+        event.eon = &decoder->eon[i];
+        if(i >= old->eon_count ||
+           memcmp(event.eon, &old->eon[i], sizeof(rds_eon_t)))
+            rds_decoder_emit(decoder, &event);
+    }
+
+    event.type = RDS_EVENT_ODA;
+    for(i=0; i<RDS_GROUP_COUNT; i++)
+    {
+        if(decoder->oda[i] && decoder->oda[i] != old->oda[i])
+        {
+            event.oda.group = i;
+            event.oda.aid = decoder->oda[i];
+            rds_decoder_emit(decoder, &event);
+        }
+    }
+
+    if(memcmp(&decoder->rtplus, &old->rtplus, sizeof(rds_rtplus_t)))
+    {
+        event.type = RDS_EVENT_RTPLUS;
+        event.rtplus = &decoder->rtplus;
+        rds_decoder_emit(decoder, &event);
+    }
+}
+
+static void
+rds_decoder_vote_reset(rds_decoder_t *decoder)
+{
+    rds_vote_reset(decoder->ps_vote, RDS_PS_LEN);
+    decoder->ps_committed = 0;
+    rds_vote_reset(decoder->rt_vote[0], RDS_RT_LEN);
+    rds_vote_reset(decoder->rt_vote[1], RDS_RT_LEN);
+    decoder->rt_flag = -1;
+}
+
+static void
+rds_decoder_emit(rds_decoder_t     *decoder,
+                 const rds_event_t *event)
+{
+    const rds_subscriber_t *subscriber;
+    guint32 bit = RDS_EVENT_MASK(event->type);
+    gint i;
+
+    if(!(decoder->mask & bit))
+        return;
+
+    for(i=0; i<decoder->subscriber_count; i++)
+    {
+        subscriber = &decoder->subscribers[i];
+        if(subscriber->mask & bit)
+            subscriber->func(decoder, event, subscriber->data);
+    }
+}
+
+static void
+rds_decoder_set(rds_decoder_t *decoder,
+                gint          *field,
+                gint           type,
+                gint           value)
+{
+    rds_event_t event;
+
+    if(*field == value)
+        return;
+
+    *field = value;
+    event.type = type;
+    event.value = value;
+    rds_decoder_emit(decoder, &event);
+}
+
+static void
+rds_decoder_info(rds_decoder_t *decoder,
+                 const guint16 *data,
+                 const guchar  *err)
+{
+    /* PTY, TP: error-free block B of any group */
+    if(err[RDS_BLOCK_B])
+        return;
+
+    rds_decoder_set(decoder, &decoder->pty, RDS_EVENT_PTY, (data[RDS_BLOCK_B] & 0x03E0) >> 5);
+    rds_decoder_set(decoder, &decoder->tp, RDS_EVENT_TP, (data[RDS_BLOCK_B] & 0x400) >> 10);
+}
+
+static void
+rds_decoder_ta_ms(rds_decoder_t *decoder,
+                  const guint16 *data,
+                  const guchar  *err)
+{
+    /* TA, MS: error-free block B of 0A, 0B and 15B */
+    if(err[RDS_BLOCK_B])
+        return;
+
+    rds_decoder_set(decoder, &decoder->ta, RDS_EVENT_TA, (data[RDS_BLOCK_B] & 0x10) >> 4);
+    rds_decoder_set(decoder, &decoder->ms, RDS_EVENT_MS, (data[RDS_BLOCK_B] & 0x8) >> 3);
+}
+
+static void
+rds_decoder_ps(rds_decoder_t *decoder,
+               const guint16 *data,
+               const guchar  *err)
+{
+    /* PS: user-defined error correction */
+    const rds_decoder_config_t *config = &decoder->config;
+    gint pos, p, i;
+    gchar ps[2];
+    gboolean changed = FALSE;
+    rds_event_t event;
+    guchar e;
+
+    pos = data[RDS_BLOCK_B] & 3;
+    ps[0] = data[RDS_BLOCK_D] >> 8;
+    ps[1] = data[RDS_BLOCK_D] & 0xFF;
+
+    if(config->ps_voting)
+    {
+        changed = rds_decoder_ps_vote(decoder, pos, ps, MAX(err[RDS_BLOCK_B], err[RDS_BLOCK_D]));
+    }
+    else
+    {
+        if(!config->ps_progressive && err[RDS_BLOCK_B] > config->ps_info_error)
+            return;
+
+        if(err[RDS_BLOCK_D] >= 3 ||
+           (!config->ps_progressive && err[RDS_BLOCK_D] > config->ps_data_error))
+            return;
+
+        e = 2*err[RDS_BLOCK_B] + 3*err[RDS_BLOCK_D];
+
+        for(i=0; i<2; i++)
+        {
+            /* Only ASCII printable characters */
+            if(ps[i] >= 32 && ps[i] < 127)
+            {
+                p = pos*2+i;
+                if(!config->ps_progressive || decoder->ps_err[p] >= e)
+                {
+                    if(decoder->ps[p] != ps[i] || decoder->ps_err[p] > e)
+                    {
+                        decoder->ps[p] = ps[i];
+                        decoder->ps_err[p] = e;
+                        changed = TRUE;
+                    }
+                }
+            }
+        }
+    }
+
+    if(changed)
+    {
+        event.type = RDS_EVENT_PS;
+        event.ps.text = decoder->ps;
+        event.ps.err = decoder->ps_err;
+        rds_decoder_emit(decoder, &event);
+    }
+}
+
+static gboolean
+rds_decoder_ps_vote(rds_decoder_t *decoder,
+                    gint           pos,
+                    const gchar   *ps,
+                    guchar         err_level)
+{
+    /* Committed characters are error-free, the leading candidate of
+     * an uncommitted position is shown with an error by its confidence */
+    gboolean changed = FALSE;
+    rds_vote_t *vote;
+    gint p, i, value, best, second;
+    guchar e;
+
+    for(i=0; i<2; i++)
+    {
+        if(ps[i] < 32 || ps[i] >= 127)
+            continue;
+
+        p = pos*2+i;
+        vote = &decoder->ps_vote[p];
+        value = rds_vote_add(vote, ps[i], err_level);
+        if(value >= 0)
+        {
+            decoder->ps_committed |= (1 << p);
+            e = 0;
+        }
+        else if(!(decoder->ps_committed & (1 << p)) &&
+                (best = rds_vote_leader(vote, &second)) >= 0)
+        {
+            value = vote->value[best];
+            e = MAX(1, 10 - 10 * vote->weight[best] / RDS_VOTE_THRESHOLD);
+        }
+        else
+        {
+            continue;
+        }
+
+        if(decoder->ps[p] != value || decoder->ps_err[p] != e)
+        {
+            decoder->ps[p] = value;
+            decoder->ps_err[p] = e;
+            changed = TRUE;
+        }
+    }
+
+    return changed;
+}
+
+static void
+rds_decoder_rt(rds_decoder_t *decoder,
+               gint           flag,
+               gint           offset,
+               const gchar   *rt,
+               const guchar  *e,
+               gint           count,
+               guchar         info_error)
+{
+    /* RT: user-defined error correction */
+    const rds_decoder_config_t *config = &decoder->config;
+    gchar *text = decoder->rt[flag];
+    gboolean changed = FALSE;
+    rds_event_t event;
+    gint i;
+
+    if(config->rt_voting)
+    {
+        changed = rds_decoder_rt_vote(decoder, flag, offset, rt, e, count, info_error);
+        rds_decoder_rt_received(decoder, flag, offset, e, count, info_error);
+        if(changed)
+        {
+            event.type = RDS_EVENT_RT;
+            event.rt.flag = flag;
+            event.rt.text = text;
+            rds_decoder_emit(decoder, &event);
+        }
+        return;
+    }
+
+    rds_decoder_rt_received(decoder, flag, offset, e, count, info_error);
+
+    for(i=0; i<count; i++)
+    {
+        if(text[offset+i] == rt[i])
+            continue;
+
+        if(rt[i] == 0x0D)
+        {
+            /* End of the RadioText message: error-free blocks only */
+            if(!info_error && !e[i])
+            {
+                text[offset+i] = 0;
+                changed = TRUE;
+            }
+        }
+        else if(rt[i] >= 32 && rt[i] < 127)
+        {
+            /* Only ASCII printable characters */
+            if(e[i] <= config->rt_data_error)
+            {
+                text[offset+i] = rt[i];
+                changed = TRUE;
+            }
+        }
+    }
+
+    if(changed)
+    {
+        event.type = RDS_EVENT_RT;
+        event.rt.flag = flag;
+        event.rt.text = text;
+        rds_decoder_emit(decoder, &event);
+    }
+}
+
+static gboolean
+rds_decoder_rt_vote(rds_decoder_t *decoder,
+                    gint           flag,
+                    gint           offset,
+                    const gchar   *rt,
+                    const guchar  *e,
+                    gint           count,
+                    guchar         info_error)
+{
+    gchar *text = decoder->rt[flag];
+    gboolean changed = FALSE;
+    gint i, value;
+
+    /* A new message starts with a toggle of the A/B flag */
+    if(decoder->rt_flag != flag)
+    {
+        if(info_error)
+            return FALSE;
+        if(decoder->rt_flag >= 0)
+        {
+            rds_vote_reset(decoder->rt_vote[flag], RDS_RT_LEN);
+            memset(text, ' ', RDS_RT_LEN);
+            decoder->rt_received[flag] = 0;
+            changed = TRUE;
+        }
+        decoder->rt_flag = flag;
+    }
+
+    for(i=0; i<count; i++)
+    {
+        if(rt[i] != 0x0D && (rt[i] < 32 || rt[i] >= 127))
+            continue;
+
+        value = rds_vote_add(&decoder->rt_vote[flag][offset+i], rt[i], MAX(info_error, e[i]));
+        if(value < 0)
+            continue;
+
+        /* End of the RadioText message */
+        if(value == 0x0D)
+            value = 0;
+
+        if(text[offset+i] != value)
+        {
+            text[offset+i] = value;
+            changed = TRUE;
+        }
+    }
+
+    return changed;
+}
+
+static void
+rds_decoder_rt_received(rds_decoder_t *decoder,
+                        gint           flag,
+                        gint           offset,
+                        const guchar  *e,
+                        gint           count,
+                        guchar         info_error)
+{
+    /* 2A carries up to 64 characters, 2B up to 32 */
+    const rds_decoder_config_t *config = &decoder->config;
+    gint i;
+
+    decoder->rt_length[flag] = count * 16;
+    if(info_error > config->rt_info_error)
+        return;
+
+    for(i=0; i<count; i++)
+        if(e[i] <= config->rt_data_error)
+            decoder->rt_received[flag] |= G_GUINT64_CONSTANT(1) << (offset+i);
+}
+
+static void
+rds_decoder_0a(rds_decoder_t *decoder,
+               const guint16 *data,
+               const guchar  *err)
+{
+    rds_event_t event;
+    const rds_af_list_t *list;
+    guchar added[2];
+    gint i, n;
+
+    rds_decoder_ta_ms(decoder, data, err);
+
+    /* AF: error-free blocks, each frequency reported once */
+    if(!err[RDS_BLOCK_B] && !err[RDS_BLOCK_C])
+    {
+        n = rds_af_pair(&decoder->af, data[RDS_BLOCK_C] >> 8, data[RDS_BLOCK_C] & 0xFF, added, &list);
+
+        event.type = RDS_EVENT_AF;
+        for(i=0; i<n; i++)
+        {
+            event.value = added[i];
+            rds_decoder_emit(decoder, &event);
+        }
+
+        if(list)
+        {
+            event.type = RDS_EVENT_AF_LIST;
+            event.af_list = list;
+            rds_decoder_emit(decoder, &event);
+        }
+    }
+
+    rds_decoder_ps(decoder, data, err);
+}
+
+static void
+rds_decoder_0b(rds_decoder_t *decoder,
+               const guint16 *data,
+               const guchar  *err)
+{
+    rds_decoder_ta_ms(decoder, data, err);
+    rds_decoder_ps(decoder, data, err);
+}
+
+static void
+rds_decoder_1a(rds_decoder_t *decoder,
+               const guint16 *data,
+               const guchar  *err)
+{
+    /* ECC: error-free blocks, variant 0 */
+    if(err[RDS_BLOCK_B] || err[RDS_BLOCK_C])
+        return;
+
+    if(!(data[RDS_BLOCK_C] >> 12))
+        rds_decoder_set(decoder, &decoder->ecc, RDS_EVENT_ECC, data[RDS_BLOCK_C] & 255);
+}
+
+static void
+rds_decoder_2a(rds_decoder_t *decoder,
+               const guint16 *data,
+               const guchar  *err)
+{
+    gchar rt[4];
+    guchar e[4];
+
+    if(!decoder->config.rt_voting &&
+       err[RDS_BLOCK_B] > decoder->config.rt_info_error)
+        return;
+
+    rt[0] = data[RDS_BLOCK_C] >> 8;
+    rt[1] = data[RDS_BLOCK_C] & 0xFF;
+    rt[2] = data[RDS_BLOCK_D] >> 8;
+    rt[3] = data[RDS_BLOCK_D] & 0xFF;
+    e[0] = e[1] = err[RDS_BLOCK_C];
+    e[2] = e[3] = err[RDS_BLOCK_D];
+
+    rds_decoder_rt(decoder,
+                   (data[RDS_BLOCK_B] & 16) >> 4,
+                   (data[RDS_BLOCK_B] & 15) * 4,
+                   rt, e, 4, err[RDS_BLOCK_B]);
+}
+
+static void
+rds_decoder_2b(rds_decoder_t *decoder,
+               const guint16 *data,
+               const guchar  *err)
+{
+    /* Block C repeats the PI code, up to 32 characters */
+    gchar rt[2];
+    guchar e[2];
+
+    if(!decoder->config.rt_voting &&
+       err[RDS_BLOCK_B] > decoder->config.rt_info_error)
+        return;
+
+    rt[0] = data[RDS_BLOCK_D] >> 8;
+    rt[1] = data[RDS_BLOCK_D] & 0xFF;
+    e[0] = e[1] = err[RDS_BLOCK_D];
+
+    rds_decoder_rt(decoder,
+                   (data[RDS_BLOCK_B] & 16) >> 4,
+                   (data[RDS_BLOCK_B] & 15) * 2,
+                   rt, e, 2, err[RDS_BLOCK_B]);
+}
+
+static void
+rds_decoder_3a(rds_decoder_t *decoder,
+               const guint16 *data,
+               const guchar  *err)
+{
+    /* ODA: application group type in block B, AID in block D */
+    gint group = data[RDS_BLOCK_B] & 31;
+    rds_event_t event;
+
+    if(err[RDS_BLOCK_B] || err[RDS_BLOCK_D])
+        return;
+
+    /* 0A: not carried in a group, 15B: temporary data fault */
+    if(group == RDS_GROUP(0, 0) || group == RDS_GROUP(15, 1))
+        return;
+
+    if(decoder->oda[group] == data[RDS_BLOCK_D])
+        return;
+
+    decoder->oda[group] = data[RDS_BLOCK_D];
+    event.type = RDS_EVENT_ODA;
+    event.oda.group = group;
+    event.oda.aid = data[RDS_BLOCK_D];
+    rds_decoder_emit(decoder, &event);
+}
+
+static void
+rds_decoder_4a(rds_decoder_t *decoder,
+               const guint16 *data,
+               const guchar  *err)
+{
+    /* CT: error-free blocks, sent at the start of each minute */
+    rds_ct_t *ct = &decoder->ct;
+    rds_event_t event;
+    gint mjd, hour, minute, offset;
+    gint y, m, k;
+
+    if(err[RDS_BLOCK_B] || err[RDS_BLOCK_C] || err[RDS_BLOCK_D])
+        return;
+
+    mjd = ((data[RDS_BLOCK_B] & 3) << 15) | (data[RDS_BLOCK_C] >> 1);
+    hour = ((data[RDS_BLOCK_C] & 1) << 4) | (data[RDS_BLOCK_D] >> 12);
+    minute = (data[RDS_BLOCK_D] >> 6) & 63;
+    offset = data[RDS_BLOCK_D] & 31;
+    if(data[RDS_BLOCK_D] & 32)
+        offset = -offset;
+
+    if(!mjd || hour > 23 || minute > 59)
+        return;
+
+    /* Modified Julian Day to a calendar date, IEC 62106 Annex G */
+    y = (gint)((mjd - 15078.2) / 365.25);
+    m = (gint)((mjd - 14956.1 - (gint)(y * 365.25)) / 30.6001);
+    ct->day = mjd - 14956 - (gint)(y * 365.25) - (gint)(m * 30.6001);
+    k = (m == 14 || m == 15);
+    ct->year = y + k + 1900;
+    ct->month = m - 1 - k * 12;
+    ct->hour = hour;
+    ct->minute = minute;
+    ct->offset = offset;
+
+    event.type = RDS_EVENT_CT;
+    event.ct = ct;
+    rds_decoder_emit(decoder, &event);
+}
+
+static void
+rds_decoder_10a(rds_decoder_t *decoder,
+                const guint16 *data,
+                const guchar  *err)
+{
+    /* PTYN: PS error thresholds, cleared when the A/B flag changes */
+    const rds_decoder_config_t *config = &decoder->config;
+    gint flag = (data[RDS_BLOCK_B] & 16) >> 4;
+    gint pos = (data[RDS_BLOCK_B] & 1) * 4;
+    gboolean changed = FALSE;
+    rds_event_t event;
+    gchar ptyn[4];
+    gint i;
+
+    if(err[RDS_BLOCK_B] > config->ps_info_error ||
+       err[RDS_BLOCK_C] > config->ps_data_error ||
+       err[RDS_BLOCK_D] > config->ps_data_error)
+        return;
+
+    if(decoder->ptyn_flag != flag)
+    {
+        if(decoder->ptyn_flag >= 0)
+            memset(decoder->ptyn, ' ', RDS_PTYN_LEN);
+        decoder->ptyn_flag = flag;
+    }
+
+    ptyn[0] = data[RDS_BLOCK_C] >> 8;
+    ptyn[1] = data[RDS_BLOCK_C] & 0xFF;
+    ptyn[2] = data[RDS_BLOCK_D] >> 8;
+    ptyn[3] = data[RDS_BLOCK_D] & 0xFF;
+
+    for(i=0; i<4; i++)
+    {
+        if(ptyn[i] >= 32 && ptyn[i] < 127 &&
+           decoder->ptyn[pos+i] != ptyn[i])
+        {
+            decoder->ptyn[pos+i] = ptyn[i];
+            changed = TRUE;
+        }
+    }
+
+    if(changed)
+    {
+        event.type = RDS_EVENT_PTYN;
+        event.ptyn = decoder->ptyn;
+        rds_decoder_emit(decoder, &event);
+    }
+}
+
+static void
+rds_decoder_14a(rds_decoder_t *decoder,
+                const guint16 *data,
+                const guchar  *err)
+{
+    /* EON: error-free blocks, PI of the other network in block D */
+    gint variant = data[RDS_BLOCK_B] & 15;
+    gint info = data[RDS_BLOCK_C];
+    gboolean changed = FALSE;
+    rds_event_t event;
+    rds_eon_t *eon;
+    guchar c[2];
+    gint i, j;
+
+    if(err[RDS_BLOCK_B] || err[RDS_BLOCK_C] || err[RDS_BLOCK_D])
+        return;
+
+    if(!(eon = rds_decoder_eon(decoder, data[RDS_BLOCK_D])))
+        return;
+
+    if(eon->tp != ((data[RDS_BLOCK_B] & 16) >> 4))
+    {
+        eon->tp = (data[RDS_BLOCK_B] & 16) >> 4;
+        changed = TRUE;
+    }
+
+    c[0] = info >> 8;
+    c[1] = info & 0xFF;
+
+    if(variant <= 3)
+    {
+        for(i=0; i<2; i++)
+        {
+            if(c[i] >= 32 && c[i] < 127 &&
+               eon->ps[variant*2+i] != c[i])
+            {
+                eon->ps[variant*2+i] = c[i];
+                changed = TRUE;
+            }
+        }
+    }
+    else if(variant == 4)
+    {
+        for(i=0; i<2; i++)
+        {
+            if(c[i] == 0 || c[i] >= 205)
+                continue;
+            for(j=0; j<eon->af_count; j++)
+                if(eon->af[j] == c[i])
+                    break;
+            if(j == eon->af_count && eon->af_count < RDS_EON_AF_MAX)
+            {
+                eon->af[eon->af_count++] = c[i];
+                changed = TRUE;
+            }
+        }
+    }
+    else if(variant == 13)
+    {
+        if(eon->pty != (info >> 11) || eon->ta != (info & 1))
+        {
+            eon->pty = info >> 11;
+            eon->ta = info & 1;
+            changed = TRUE;
+        }
+    }
+
+    if(changed)
+    {
+        event.type = RDS_EVENT_EON;
+        event.eon = eon;
+        rds_decoder_emit(decoder, &event);
+    }
+}
+
+static void
+rds_decoder_14b(rds_decoder_t *decoder,
+                const guint16 *data,
+                const guchar  *err)
+{
+    /* EON: TP and TA switching of the other network */
+    gint tp = (data[RDS_BLOCK_B] & 16) >> 4;
+    gint ta = (data[RDS_BLOCK_B] & 8) >> 3;
+    rds_event_t event;
+    rds_eon_t *eon;
+
+    if(err[RDS_BLOCK_B] || err[RDS_BLOCK_D])
+        return;
+
+    if(!(eon = rds_decoder_eon(decoder, data[RDS_BLOCK_D])))
+        return;
+
+    if(eon->tp == tp && eon->ta == ta)
+        return;
+
+    eon->tp = tp;
+    eon->ta = ta;
+    event.type = RDS_EVENT_EON;
+    event.eon = eon;
+    rds_decoder_emit(decoder, &event);
+}
+
+static void
+rds_decoder_15a(rds_decoder_t *decoder,
+                const guint16 *data,
+                const guchar  *err)
+{
+    /* Long PS: 32 bytes of UTF-8, RT error thresholds */
+    const rds_decoder_config_t *config = &decoder->config;
+    gint pos = (data[RDS_BLOCK_B] & 7) * 4;
+    gboolean changed = FALSE;
+    rds_event_t event;
+    guchar lps[4], e;
+    gint i;
+
+    if(err[RDS_BLOCK_B] > config->rt_info_error)
+        return;
+
+    lps[0] = data[RDS_BLOCK_C] >> 8;
+    lps[1] = data[RDS_BLOCK_C] & 0xFF;
+    lps[2] = data[RDS_BLOCK_D] >> 8;
+    lps[3] = data[RDS_BLOCK_D] & 0xFF;
+
+    for(i=0; i<4; i++)
+    {
+        if((guchar)decoder->lps[pos+i] == lps[i])
+            continue;
+
+        e = (i <= 1 ? err[RDS_BLOCK_C] : err[RDS_BLOCK_D]);
+        if(lps[i] == 0x0D)
+        {
+            if(!err[RDS_BLOCK_B] && !e)
+            {
+                decoder->lps[pos+i] = 0;
+                changed = TRUE;
+            }
+        }
+        else if(lps[i] >= 32 && lps[i] != 127)
+        {
+            if(e <= config->rt_data_error)
+            {
+                decoder->lps[pos+i] = lps[i];
+                changed = TRUE;
+            }
+        }
+    }
+
+    if(changed)
+    {
+        event.type = RDS_EVENT_LPS;
+        event.lps = decoder->lps;
+        rds_decoder_emit(decoder, &event);
+    }
+}
+
+static void
+rds_decoder_15b(rds_decoder_t *decoder,
+                const guint16 *data,
+                const guchar  *err)
+{
+    /* Fast basic tuning information: same TA and MS bits as 0A */
+    rds_decoder_ta_ms(decoder, data, err);
+}
+
+static void
+rds_decoder_rtplus(rds_decoder_t *decoder,
+                   const guint16 *data,
+                   const guchar  *err)
+{
+    rds_rtplus_t rtplus;
+    rds_event_t event;
+
+    if(err[RDS_BLOCK_B] || err[RDS_BLOCK_C] || err[RDS_BLOCK_D])
+        return;
+
+    rtplus.toggle = (data[RDS_BLOCK_B] & 16) >> 4;
+    rtplus.running = (data[RDS_BLOCK_B] & 8) >> 3;
+    rtplus.tag[0].type = ((data[RDS_BLOCK_B] & 7) << 3) | (data[RDS_BLOCK_C] >> 13);
+    rtplus.tag[0].start = (data[RDS_BLOCK_C] >> 7) & 63;
+    rtplus.tag[0].length = (data[RDS_BLOCK_C] >> 1) & 63;
+    rtplus.tag[1].type = ((data[RDS_BLOCK_C] & 1) << 5) | (data[RDS_BLOCK_D] >> 11);
+    rtplus.tag[1].start = (data[RDS_BLOCK_D] >> 5) & 63;
+    rtplus.tag[1].length = data[RDS_BLOCK_D] & 31;
+
+    if(!memcmp(&decoder->rtplus, &rtplus, sizeof(rds_rtplus_t)))
+        return;
+
+    decoder->rtplus = rtplus;
+    event.type = RDS_EVENT_RTPLUS;
+    event.rtplus = &decoder->rtplus;
+    rds_decoder_emit(decoder, &event);
+}
+
+static rds_eon_t*
+rds_decoder_eon(rds_decoder_t *decoder,
+                gint           pi)
+{
+    rds_eon_t *eon;
+    gint i;
+
+    for(i=0; i<decoder->eon_count; i++)
+        if(decoder->eon[i].pi == pi)
+            return &decoder->eon[i];
+
+    if(decoder->eon_count >= RDS_EON_MAX)
+        return NULL;
+
+    eon = &decoder->eon[decoder->eon_count++];
+    eon->pi = pi;
+    eon->pty = -1;
+    eon->tp = -1;
+    eon->ta = -1;
+    memset(eon->ps, ' ', RDS_PS_LEN);
+    eon->ps[RDS_PS_LEN] = 0;
+    eon->af_count = 0;
+    return eon;
+}
@@ -0,0 +1,198 @@
+#ifndef XDR_RDS_DECODER_H_
+#define XDR_RDS_DECODER_H_
+#include <glib.h>
+#include "rds-af.h"
+#include "rds-vote.h"
+
+#define RDS_BLOCK_B 0
+#define RDS_BLOCK_C 1
+#define RDS_BLOCK_D 2
+
+#define RDS_PS_LEN    8
+#define RDS_RT_LEN   64
+#define RDS_PTYN_LEN  8
+#define RDS_LPS_LEN  32
+
+#define RDS_EON_MAX      8
+#define RDS_EON_AF_MAX   8
+#define RDS_SUBSCRIBERS  8
+
+/* Group type and version as a single dispatch index: 0A = 0, 0B = 1, ... 15B = 31 */
+#define RDS_GROUP_COUNT 32
+#define RDS_GROUP(type, version) (((type) << 1) | (version))
+
+#define RDS_AID_RTPLUS 0x4BD7
+
+enum rds_event_type
+{
+    RDS_EVENT_GROUP,
+    RDS_EVENT_PI,
+    RDS_EVENT_PTY,
+    RDS_EVENT_TP,
+    RDS_EVENT_TA,
+    RDS_EVENT_MS,
+    RDS_EVENT_ECC,
+    RDS_EVENT_AF,
+    RDS_EVENT_AF_LIST,
+    RDS_EVENT_PS,
+    RDS_EVENT_RT,
+    RDS_EVENT_CT,
+    RDS_EVENT_PTYN,
+    RDS_EVENT_LPS,
+    RDS_EVENT_EON,
+    RDS_EVENT_ODA,
+    RDS_EVENT_RTPLUS,
+    RDS_EVENT_RESTORE,
+    RDS_EVENT_COUNT
+};
+
+#define RDS_EVENT_MASK(type) (1u << (type))
+#define RDS_EVENT_ALL ((1u << RDS_EVENT_COUNT) - 1)
+
+/* Error levels: 0 - no errors, 1 - up to 2 bits corrected,
+ * 2 - up to 5 bits corrected, 3 - uncorrectable */
+typedef struct rds_decoder_config
+{
+    gint ps_info_error;
+    gint ps_data_error;
+    gboolean ps_progressive;
+    gboolean ps_voting;
+    gint rt_info_error;
+    gint rt_data_error;
+    gboolean rt_voting;
+} rds_decoder_config_t;
+
+/* 4A: UTC date and time, offset in half hours */
+typedef struct rds_ct
+{
+    gint year;
+    gint month;
+    gint day;
+    gint hour;
+    gint minute;
+    gint offset;
+} rds_ct_t;
+
+/* 14A/14B: other network */
+typedef struct rds_eon
+{
+    gint pi;
+    gint pty;
+    gint tp;
+    gint ta;
+    gchar ps[RDS_PS_LEN+1];
+    guchar af[RDS_EON_AF_MAX];
+    gint af_count;
+} rds_eon_t;
+
+/* RadioText+ content type, start and length of two tags */
+typedef struct rds_rtplus
+{
+    gint toggle;
+    gint running;
+    struct
+    {
+        gint type;
+        gint start;
+        gint length;
+    } tag[2];
+} rds_rtplus_t;
+
+typedef struct rds_event
+{
+    gint type;
+    union
+    {
+        /* PI, PTY, TP, TA, MS, ECC; an AF code;
+         * TRUE if restored data was confirmed by the PI */
+        gint value;
+        struct
+        {
+            const guint16 *data;
+            guint errors;
+        } group;
+        struct
+        {
+            const gchar *text;
+            const guchar *err;
+        } ps;
+        struct
+        {
+            gint flag;
+            const gchar *text;
+        } rt;
+        struct
+        {
+            gint group;
+            gint aid;
+        } oda;
+        const rds_ct_t *ct;
+        const gchar *ptyn;
+        const gchar *lps;
+        const rds_eon_t *eon;
+        const rds_rtplus_t *rtplus;
+        const rds_af_list_t *af_list;
+    };
+} rds_event_t;
+
+typedef struct rds_decoder rds_decoder_t;
+
+typedef void (*rds_decoder_func_t)(const rds_decoder_t*, const rds_event_t*, gpointer);
+
+typedef struct rds_subscriber
+{
+    guint32 mask;
+    rds_decoder_func_t func;
+    gpointer data;
+} rds_subscriber_t;
+
+struct rds_decoder
+{
+    rds_decoder_config_t config;
+    rds_subscriber_t subscribers[RDS_SUBSCRIBERS];
+    gint subscriber_count;
+    guint32 mask;
+
+    /* Restored state, not confirmed by a PI yet */
+    gboolean provisional;
+
+    gint pi;
+    gint pi_err_level;
+    gint pty;
+    gint tp;
+    gint ta;
+    gint ms;
+    gint ecc;
+    rds_af_t af;
+    gchar ps[RDS_PS_LEN+1];
+    guchar ps_err[RDS_PS_LEN];
+    rds_vote_t ps_vote[RDS_PS_LEN];
+    guint8 ps_committed;
+    gchar rt[2][RDS_RT_LEN+1];
+    rds_vote_t rt_vote[2][RDS_RT_LEN];
+    guint64 rt_received[2];  /* characters accepted at least once */
+    gint rt_length[2];
+    gint rt_flag;
+    rds_ct_t ct;
+    gchar ptyn[RDS_PTYN_LEN+1];
+    gint ptyn_flag;
+    gchar lps[RDS_LPS_LEN+1];
+    rds_eon_t eon[RDS_EON_MAX];
+    gint eon_count;
+    guint16 oda[RDS_GROUP_COUNT];
+    rds_rtplus_t rtplus;
+};
+
+void rds_decoder_init(rds_decoder_t*);
+gboolean rds_decoder_subscribe(rds_decoder_t*, guint32, rds_decoder_func_t, gpointer);
+void rds_decoder_reset(rds_decoder_t*);
+gboolean rds_decoder_pi(rds_decoder_t*, gint, gint);
+void rds_decoder_group(rds_decoder_t*, const guint16*, guint);
+gboolean rds_decoder_ps_complete(const rds_decoder_t*);
+gboolean rds_decoder_ps_avail(const rds_decoder_t*);
+gboolean rds_decoder_rt_avail(const rds_decoder_t*, gint);
+gboolean rds_decoder_rt_complete(const rds_decoder_t*, gint);
+void rds_decoder_restore(rds_decoder_t*, const rds_decoder_t*);
+void rds_decoder_sync(rds_decoder_t*, const rds_decoder_t*);
+
+#endif
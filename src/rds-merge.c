@@ -0,0 +1,306 @@
+#include <glib.h>
+#include <string.h>
+#include "rds-merge.h"
+
+/* Error level of a block: 0 - none, 1 - up to 2 bits corrected,
+ * 2 - up to 5 bits corrected, 3 - uncorrectable */
+#define RDS_MERGE_ERR(errors, block) (((errors) >> ((block) * 2)) & 3)
+
+static gboolean rds_merge_tuned(const rds_merge_t*);
+static gboolean rds_merge_match(const rds_merge_group_t*, const rds_merge_group_t*);
+static void rds_merge_combine(rds_merge_t*, const rds_merge_group_t*, const rds_merge_group_t*);
+static void rds_merge_single(rds_merge_t*, gint, gint);
+static void rds_merge_output(rds_merge_t*, const rds_merge_group_t*);
+static guint rds_merge_bad(guint);
+
+rds_merge_t*
+rds_merge_new()
+{
+    rds_merge_t *merge = g_new0(rds_merge_t, 1);
+    gint i;
+
+    g_mutex_init(&merge->lock);
+    for(i=0; i<RDS_MERGE_SOURCES; i++)
+        merge->pi[i] = -1;
+    return merge;
+}
+
+void
+rds_merge_free(rds_merge_t *merge)
+{
+    g_mutex_clear(&merge->lock);
+    g_free(merge);
+}
+
+void
+rds_merge_freq(rds_merge_t *merge,
+               gint         source,
+               gint         freq)
+{
+    /* 0 detaches the tuner, groups of another frequency are not merged */
+    g_mutex_lock(&merge->lock);
+    if(merge->freq[source] != freq)
+    {
+        /* Primary copies still waiting for a pair are passed on,
+         * the secondary ones are only duplicates and are dropped */
+        rds_merge_single(merge, RDS_MERGE_PRIMARY, merge->pending_count[RDS_MERGE_PRIMARY]);
+        merge->pending_count[RDS_MERGE_SECONDARY] = 0;
+        merge->freq[source] = freq;
+        merge->pi[source] = -1;
+        merge->pi_err_level[source] = 0;
+        if(source == RDS_MERGE_PRIMARY)
+        {
+            /* Groups of the previous frequency are not decoded anymore */
+            merge->output_count = 0;
+            memset(&merge->stats, 0, sizeof(rds_merge_stats_t));
+        }
+    }
+    g_mutex_unlock(&merge->lock);
+}
+
+void
+rds_merge_pi(rds_merge_t *merge,
+             gint         source,
+             gint         pi,
+             gint         err_level)
+{
+    g_mutex_lock(&merge->lock);
+    merge->pi[source] = pi;
+    merge->pi_err_level[source] = err_level;
+    g_mutex_unlock(&merge->lock);
+}
+
+void
+rds_merge_group(rds_merge_t   *merge,
+                gint           source,
+                gint64         time,
+                const guint16 *data,
+                guint          errors)
+{
+    gint other = !source;
+    rds_merge_group_t group;
+    const rds_merge_group_t *candidate;
+    gint i;
+
+    g_mutex_lock(&merge->lock);
+
+    group.time = time;
+    group.pi = merge->pi[source];
+    group.pi_err_level = merge->pi_err_level[source];
+    memcpy(group.data, data, sizeof(group.data));
+    group.errors = errors;
+
+    if(!rds_merge_tuned(merge))
+    {
+        /* A single tuner is passed through */
+        if(source == RDS_MERGE_PRIMARY)
+            rds_merge_output(merge, &group);
+        g_mutex_unlock(&merge->lock);
+        return;
+    }
+
+    merge->stats.groups[source]++;
+    merge->stats.bad[source] += rds_merge_bad(errors);
+
+    /* The oldest consistent copy from the other tuner, the older
+     * ones were missed by this tuner and are passed on first */
+    for(i=0; i<merge->pending_count[other]; i++)
+    {
+        candidate = &merge->pending[other][i];
+        if(ABS(candidate->time - time) <= RDS_MERGE_WINDOW &&
+           rds_merge_match(candidate, &group))
+        {
+            rds_merge_single(merge, other, i);
+            if(source == RDS_MERGE_PRIMARY)
+                rds_merge_combine(merge, &group, &merge->pending[other][0]);
+            else
+                rds_merge_combine(merge, &merge->pending[other][0], &group);
+            merge->pending_count[other]--;
+            memmove(&merge->pending[other][0], &merge->pending[other][1],
+                    merge->pending_count[other] * sizeof(rds_merge_group_t));
+            g_mutex_unlock(&merge->lock);
+            return;
+        }
+    }
+
+    if(merge->pending_count[source] == RDS_MERGE_PENDING)
+        rds_merge_single(merge, source, 1);
+    merge->pending[source][merge->pending_count[source]++] = group;
+    g_mutex_unlock(&merge->lock);
+}
+
+gboolean
+rds_merge_pop(rds_merge_t       *merge,
+              gint64             now,
+              rds_merge_group_t *group)
+{
+    gboolean ret = FALSE;
+    gint source;
+
+    g_mutex_lock(&merge->lock);
+
+    /* Copies that waited too long for their pair go out in time order */
+    for(;;)
+    {
+        if(merge->pending_count[RDS_MERGE_PRIMARY] && merge->pending_count[RDS_MERGE_SECONDARY])
+            source = (merge->pending[RDS_MERGE_PRIMARY][0].time <= merge->pending[RDS_MERGE_SECONDARY][0].time ?
+                      RDS_MERGE_PRIMARY : RDS_MERGE_SECONDARY);
+        else if(merge->pending_count[RDS_MERGE_PRIMARY])
+            source = RDS_MERGE_PRIMARY;
+        else if(merge->pending_count[RDS_MERGE_SECONDARY])
+            source = RDS_MERGE_SECONDARY;
+        else
+            break;
+
+        if(rds_merge_tuned(merge) &&
+           now - merge->pending[source][0].time <= RDS_MERGE_WINDOW)
+            break;
+        rds_merge_single(merge, source, 1);
+    }
+
+    if(merge->output_count)
+    {
+        *group = merge->output[merge->output_head];
+        merge->output_head = (merge->output_head + 1) % RDS_MERGE_OUTPUT;
+        merge->output_count--;
+        ret = TRUE;
+    }
+
+    g_mutex_unlock(&merge->lock);
+    return ret;
+}
+
+gboolean
+rds_merge_active(rds_merge_t *merge)
+{
+    gboolean ret;
+
+    g_mutex_lock(&merge->lock);
+    ret = rds_merge_tuned(merge);
+    g_mutex_unlock(&merge->lock);
+    return ret;
+}
+
+void
+rds_merge_get_stats(rds_merge_t       *merge,
+                    rds_merge_stats_t *stats)
+{
+    g_mutex_lock(&merge->lock);
+    *stats = merge->stats;
+    g_mutex_unlock(&merge->lock);
+}
+
+static gboolean
+rds_merge_tuned(const rds_merge_t *merge)
+{
+    return (merge->freq[RDS_MERGE_PRIMARY] > 0 &&
+            merge->freq[RDS_MERGE_PRIMARY] == merge->freq[RDS_MERGE_SECONDARY]);
+}
+
+static gboolean
+rds_merge_match(const rds_merge_group_t *a,
+                const rds_merge_group_t *b)
+{
+    /* Reliable blocks must agree and at least one must be there,
+     * block B alone tells the group type and its variant */
+    gboolean agree = FALSE;
+    gint i;
+
+    if(a->pi >= 0 && b->pi >= 0 && a->pi != b->pi &&
+       !a->pi_err_level && !b->pi_err_level)
+        return FALSE;
+
+    for(i=0; i<3; i++)
+    {
+        if(RDS_MERGE_ERR(a->errors, i) > 1 || RDS_MERGE_ERR(b->errors, i) > 1)
+            continue;
+        if(a->data[i] != b->data[i])
+            return FALSE;
+        agree = TRUE;
+    }
+    return agree;
+}
+
+static void
+rds_merge_combine(rds_merge_t             *merge,
+                  const rds_merge_group_t *primary,
+                  const rds_merge_group_t *secondary)
+{
+    rds_merge_group_t group = *primary;
+    guint e1, e2;
+    gint i;
+
+    if(secondary->pi >= 0 &&
+       (group.pi < 0 || secondary->pi_err_level < group.pi_err_level))
+    {
+        group.pi = secondary->pi;
+        group.pi_err_level = secondary->pi_err_level;
+    }
+
+    group.errors = 0;
+    for(i=0; i<3; i++)
+    {
+        e1 = RDS_MERGE_ERR(primary->errors, i);
+        e2 = RDS_MERGE_ERR(secondary->errors, i);
+        if(e2 < e1)
+        {
+            group.data[i] = secondary->data[i];
+            merge->stats.improved++;
+        }
+        group.errors |= MIN(e1, e2) << (i * 2);
+    }
+
+    merge->stats.merged++;
+    rds_merge_output(merge, &group);
+}
+
+static void
+rds_merge_single(rds_merge_t *merge,
+                 gint         source,
+                 gint         count)
+{
+    /* Passes on the oldest copies of one tuner */
+    gint i;
+
+    for(i=0; i<count; i++)
+    {
+        merge->stats.single[source]++;
+        rds_merge_output(merge, &merge->pending[source][i]);
+    }
+
+    merge->pending_count[source] -= count;
+    memmove(&merge->pending[source][0], &merge->pending[source][count],
+            merge->pending_count[source] * sizeof(rds_merge_group_t));
+}
+
+static void
+rds_merge_output(rds_merge_t             *merge,
+                 const rds_merge_group_t *group)
+{
+    /* The oldest group is lost when the reader falls behind */
+    if(merge->output_count == RDS_MERGE_OUTPUT)
+    {
+        merge->output_head = (merge->output_head + 1) % RDS_MERGE_OUTPUT;
+        merge->output_count--;
+    }
+
+    merge->output[(merge->output_head + merge->output_count) % RDS_MERGE_OUTPUT] = *group;
+    merge->output_count++;
+    if(rds_merge_tuned(merge))
+    {
+        merge->stats.output++;
+        merge->stats.output_bad += rds_merge_bad(group->errors);
+    }
+}
+
+static guint
+rds_merge_bad(guint errors)
+{
+    guint count = 0;
+    gint i;
+
+    for(i=0; i<3; i++)
+        if(RDS_MERGE_ERR(errors, i) == 3)
+            count++;
+    return count;
+}
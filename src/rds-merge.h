@@ -0,0 +1,62 @@
+#ifndef XDR_RDS_MERGE_H_
+#define XDR_RDS_MERGE_H_
+#include <glib.h>
+
+#define RDS_MERGE_PRIMARY   0
+#define RDS_MERGE_SECONDARY 1
+#define RDS_MERGE_SOURCES   2
+
+#define RDS_MERGE_PENDING 8
+#define RDS_MERGE_OUTPUT  32
+
+/* Copies of one group arrive within this time (microseconds),
+ * a group missed by the other tuner is passed on after it */
+#define RDS_MERGE_WINDOW 150000
+
+typedef struct rds_merge_group
+{
+    gint64 time;
+    gint pi;
+    gint pi_err_level;
+    guint16 data[3];
+    guint errors;
+} rds_merge_group_t;
+
+/* Counted since the primary tuner was tuned */
+typedef struct rds_merge_stats
+{
+    guint64 groups[RDS_MERGE_SOURCES];
+    guint64 bad[RDS_MERGE_SOURCES];     /* uncorrectable blocks */
+    guint64 single[RDS_MERGE_SOURCES];  /* groups the other tuner missed */
+    guint64 merged;                     /* groups received by both */
+    guint64 improved;                   /* blocks better than the primary copy */
+    guint64 output;
+    guint64 output_bad;
+} rds_merge_stats_t;
+
+/* Merges RDS of two tuners on the same frequency, block by block.
+ * Fed by both reader threads, drained by the primary one. */
+typedef struct rds_merge
+{
+    GMutex lock;
+    gint freq[RDS_MERGE_SOURCES];
+    gint pi[RDS_MERGE_SOURCES];
+    gint pi_err_level[RDS_MERGE_SOURCES];
+    rds_merge_group_t pending[RDS_MERGE_SOURCES][RDS_MERGE_PENDING];
+    gint pending_count[RDS_MERGE_SOURCES];
+    rds_merge_group_t output[RDS_MERGE_OUTPUT];
+    gint output_head;
+    gint output_count;
+    rds_merge_stats_t stats;
+} rds_merge_t;
+
+rds_merge_t* rds_merge_new();
+void rds_merge_free(rds_merge_t*);
+void rds_merge_freq(rds_merge_t*, gint, gint);
+void rds_merge_pi(rds_merge_t*, gint, gint, gint);
+void rds_merge_group(rds_merge_t*, gint, gint64, const guint16*, guint);
+gboolean rds_merge_pop(rds_merge_t*, gint64, rds_merge_group_t*);
+gboolean rds_merge_active(rds_merge_t*);
+void rds_merge_get_stats(rds_merge_t*, rds_merge_stats_t*);
+
+#endif
@@ -0,0 +1,118 @@
+#include <glib.h>
+#include <math.h>
+#include <string.h>
+#include "rds-stats.h"
+
+void
+rds_stats_reset(rds_stats_t *stats,
+                gint64       now)
+{
+    gint i;
+
+    memset(stats, 0, sizeof(rds_stats_t));
+    stats->tuned = now;
+    for(i=0; i<RDS_STATS_LATENCIES; i++)
+        stats->latency[i] = -1;
+}
+
+void
+rds_stats_pi(rds_stats_t *stats,
+             gint         err_level)
+{
+    /* Block A arrives separately as the PI code */
+    stats->blocks[RDS_STATS_BLOCK_A]++;
+    stats->errors[RDS_STATS_BLOCK_A][CLAMP(err_level, 0, 3)]++;
+}
+
+void
+rds_stats_group(rds_stats_t   *stats,
+                const guint16 *data,
+                guint          errors)
+{
+    guint err[] = { (errors&3), ((errors&12)>>2), ((errors&48)>>4) };
+    gint i;
+
+    for(i=0; i<3; i++)
+    {
+        stats->blocks[RDS_STATS_BLOCK_B+i]++;
+        stats->errors[RDS_STATS_BLOCK_B+i][err[i]]++;
+    }
+
+    stats->groups++;
+
+    /* The group type is known only from a correctable block B */
+    if(err[RDS_BLOCK_B] < 3)
+        stats->types[data[RDS_BLOCK_B] >> 11]++;
+}
+
+void
+rds_stats_mark(rds_stats_t *stats,
+               gint         latency,
+               gint64       now)
+{
+    /* Only the first occurrence after a tune counts */
+    if(stats->tuned && stats->latency[latency] < 0)
+        stats->latency[latency] = now - stats->tuned;
+}
+
+gdouble
+rds_stats_bler(const rds_stats_t *stats,
+               gint               block)
+{
+    /* Uncorrectable blocks, NAN without data */
+    if(!stats->blocks[block])
+        return NAN;
+    return (gdouble)stats->errors[block][3] / stats->blocks[block];
+}
+
+gdouble
+rds_stats_rate(const rds_stats_t *stats,
+               gint64             now)
+{
+    /* Groups per second since the tune */
+    if(!stats->tuned || now <= stats->tuned)
+        return NAN;
+    return stats->groups * (gdouble)G_USEC_PER_SEC / (now - stats->tuned);
+}
+
+gchar*
+rds_stats_summary(const rds_stats_t *stats,
+                  gint64             now)
+{
+    /* One line: groups/s, BLER per block, latencies and the group type histogram */
+    static const gchar blocks[] = "ABCD";
+    static const gchar *latencies[] = { "PI", "PS", "RT" };
+    GString *string = g_string_new(NULL);
+    gdouble value;
+    gint i, group;
+
+    /* Values without data are shown as "-" */
+    g_string_append_printf(string, "%u groups, ", stats->groups);
+    if(isnan(value = rds_stats_rate(stats, now)))
+        g_string_append(string, "-/s; BLER");
+    else
+        g_string_append_printf(string, "%.1f/s; BLER", value);
+
+    for(i=0; i<RDS_STATS_BLOCKS; i++)
+    {
+        if(isnan(value = rds_stats_bler(stats, i)))
+            g_string_append_printf(string, " %c -", blocks[i]);
+        else
+            g_string_append_printf(string, " %c %.1f%%", blocks[i], value * 100.0);
+    }
+
+    for(i=0; i<RDS_STATS_LATENCIES; i++)
+    {
+        if(stats->latency[i] >= 0)
+            g_string_append_printf(string, "; %s %d ms", latencies[i], (gint)(stats->latency[i] / 1000));
+        else
+            g_string_append_printf(string, "; %s -", latencies[i]);
+    }
+
+    g_string_append(string, ";");
+    for(group=0; group<RDS_GROUP_COUNT; group++)
+        if(stats->types[group])
+            g_string_append_printf(string, " %d%c:%u", group >> 1, (group & 1) ? 'B' : 'A', stats->types[group]);
+
+    return g_string_free(string, FALSE);
+}
@@ -0,0 +1,42 @@
+#ifndef XDR_RDS_STATS_H_
+#define XDR_RDS_STATS_H_
+#include <glib.h>
+#include "rds-decoder.h"
+
+enum rds_stats_block
+{
+    RDS_STATS_BLOCK_A,
+    RDS_STATS_BLOCK_B,
+    RDS_STATS_BLOCK_C,
+    RDS_STATS_BLOCK_D,
+    RDS_STATS_BLOCKS
+};
+
+enum rds_stats_latency
+{
+    RDS_STATS_PI,
+    RDS_STATS_PS,
+    RDS_STATS_RT,
+    RDS_STATS_LATENCIES
+};
+
+/* Reception quality since the last tune, error counts per block and level */
+typedef struct rds_stats
+{
+    gint64 tuned;
+    guint blocks[RDS_STATS_BLOCKS];
+    guint errors[RDS_STATS_BLOCKS][4];
+    guint groups;
+    guint types[RDS_GROUP_COUNT];
+    gint64 latency[RDS_STATS_LATENCIES];  /* microseconds, -1 until reached */
+} rds_stats_t;
+
+void rds_stats_reset(rds_stats_t*, gint64);
+void rds_stats_pi(rds_stats_t*, gint);
+void rds_stats_group(rds_stats_t*, const guint16*, guint);
+void rds_stats_mark(rds_stats_t*, gint, gint64);
+gdouble rds_stats_bler(const rds_stats_t*, gint);
+gdouble rds_stats_rate(const rds_stats_t*, gint64);
+gchar* rds_stats_summary(const rds_stats_t*, gint64);
+
+#endif
@@ -0,0 +1,74 @@
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rds-timing.h"
+
+static gint rds_timing_compare(const void*, const void*);
+
+void
+rds_timing_tune(rds_timing_t *timing,
+                gint64        now,
+                gint          mode)
+{
+    rds_timing_finish(timing);
+    timing->tuned = now;
+    timing->mode = mode;
+}
+
+void
+rds_timing_ps(rds_timing_t *timing,
+              gint64        now,
+              gboolean      complete)
+{
+    /* Only the last change of a complete PS counts */
+    if(!timing->tuned)
+        return;
+    timing->ps_stable = (complete ? now : 0);
+}
+
+void
+rds_timing_finish(rds_timing_t *timing)
+{
+    guint *count = &timing->count[timing->mode];
+
+    if(timing->tuned && timing->ps_stable)
+    {
+        timing->samples[timing->mode][*count % RDS_TIMING_TUNES] = (timing->ps_stable - timing->tuned) / 1000;
+        (*count)++;
+    }
+
+    timing->tuned = 0;
+    timing->ps_stable = 0;
+}
+
+gint
+rds_timing_median(const rds_timing_t *timing,
+                  gint                mode)
+{
+    /* Median in milliseconds over the last tunes, -1 without samples */
+    guint32 sorted[RDS_TIMING_TUNES];
+    guint n = rds_timing_count(timing, mode);
+
+    if(!n)
+        return -1;
+
+    memcpy(sorted, timing->samples[mode], n * sizeof(guint32));
+    qsort(sorted, n, sizeof(guint32), rds_timing_compare);
+    return (n % 2) ? sorted[n/2] : (sorted[n/2-1] + sorted[n/2]) / 2;
+}
+
+guint
+rds_timing_count(const rds_timing_t *timing,
+                 gint                mode)
+{
+    return MIN(timing->count[mode], RDS_TIMING_TUNES);
+}
+
+static gint
+rds_timing_compare(const void *a,
+                   const void *b)
+{
+    guint32 x = *(const guint32*)a;
+    guint32 y = *(const guint32*)b;
+    return (x > y) - (x < y);
+}
@@ -0,0 +1,31 @@
+#ifndef XDR_RDS_TIMING_H_
+#define XDR_RDS_TIMING_H_
+#include <glib.h>
+
+#define RDS_TIMING_TUNES 256
+
+enum rds_ps_mode
+{
+    RDS_PS_MODE_STANDARD,
+    RDS_PS_MODE_PROGRESSIVE,
+    RDS_PS_MODE_VOTING,
+    RDS_PS_MODE_COUNT
+};
+
+/* Time from tuning until the PS reached its final value, per PS mode */
+typedef struct rds_timing
+{
+    gint64 tuned;
+    gint64 ps_stable;
+    gint mode;
+    guint32 samples[RDS_PS_MODE_COUNT][RDS_TIMING_TUNES];
+    guint count[RDS_PS_MODE_COUNT];
+} rds_timing_t;
+
+void rds_timing_tune(rds_timing_t*, gint64, gint);
+void rds_timing_ps(rds_timing_t*, gint64, gboolean);
+void rds_timing_finish(rds_timing_t*);
+gint rds_timing_median(const rds_timing_t*, gint);
+guint rds_timing_count(const rds_timing_t*, gint);
+
+#endif
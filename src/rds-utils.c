@@ -11,3 +11,19 @@ rds_utils_pty_to_string(gboolean rbds, gint number)
 
     return (number >= 0 && number < 32) ? pty_list[(gint)rbds][number] : "Invalid";
 }
+
+const gchar*
+rds_utils_ecc_to_string(gint ecc,
+                        gint pi)
+{
+    static const gchar* const ecc_list[][16] =
+    {
+        {"??", "DE", "DZ", "AD", "IL", "IT", "BE", "RU", "PS", "AL", "AT", "HU", "MT", "DE", "??", "EG" },
+        {"??", "GR", "CY", "SM", "CH", "JO", "FI", "LU", "BG", "DK", "GI", "IQ", "GB", "LY", "RO", "FR" },
+        {"??", "MA", "CZ", "PL", "VA", "SK", "SY", "TN", "??", "LI", "IS", "MC", "LT", "YU", "ES", "NO" },
+        {"??", "??", "IE", "TR", "MK", "??", "??", "??", "NL", "LV", "LB", "??", "HR", "??", "SE", "BY" },
+        {"??", "MD", "EE", "??", "??", "??", "UA", "??", "PT", "SI", "??", "??", "??", "??", "??", "BA" },
+    };
+
+    return (ecc >= 0xE0 && ecc <= 0xE4) ? ecc_list[ecc & 7][(guint16)pi >> 12] : "??";
+}
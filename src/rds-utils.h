@@ -2,6 +2,7 @@
 #define XDR_RDS_UTILS_H_
 
 const gchar* rds_utils_pty_to_string(gboolean, gint);
+const gchar* rds_utils_ecc_to_string(gint, gint);
 
 #endif
 
@@ -0,0 +1,87 @@
+#include <glib.h>
+#include <string.h>
+#include "rds-vote.h"
+
+#define RDS_VOTE_MAX_WEIGHT 64
+
+/* Vote weight of a character received with a given block error level */
+static const guchar rds_vote_weights[] = { 8, 3, 1 };
+
+void
+rds_vote_reset(rds_vote_t *votes,
+               gint        count)
+{
+    memset(votes, 0, sizeof(rds_vote_t) * count);
+}
+
+gint
+rds_vote_add(rds_vote_t *vote,
+             guchar      value,
+             gint        err_level)
+{
+    /* Returns the committed byte or -1 if there is no consensus yet */
+    gint i, slot = 0;
+    gint best, second;
+
+    if(err_level < 0 || err_level >= (gint)G_N_ELEMENTS(rds_vote_weights))
+        return -1;
+
+    for(i=0; i<RDS_VOTE_CANDIDATES; i++)
+    {
+        if(vote->weight[i] && vote->value[i] == value)
+        {
+            slot = i;
+            break;
+        }
+        if(vote->weight[i] < vote->weight[slot])
+            slot = i;
+    }
+
+    /* A new candidate replaces the weakest one */
+    if(i == RDS_VOTE_CANDIDATES)
+    {
+        vote->value[slot] = value;
+        vote->weight[slot] = 0;
+    }
+
+    vote->weight[slot] += rds_vote_weights[err_level];
+
+    /* Age the histogram, so a changed character can take over */
+    if(vote->weight[slot] >= RDS_VOTE_MAX_WEIGHT)
+        for(i=0; i<RDS_VOTE_CANDIDATES; i++)
+            vote->weight[i] /= 2;
+
+    best = rds_vote_leader(vote, &second);
+    if(best < 0 ||
+       vote->weight[best] < RDS_VOTE_THRESHOLD ||
+       vote->weight[best] < 2 * second)
+        return -1;
+
+    return vote->value[best];
+}
+
+gint
+rds_vote_leader(const rds_vote_t *vote,
+                gint             *second)
+{
+    /* Index of the leading candidate, -1 if there are no votes */
+    gint i, best = -1;
+
+    *second = 0;
+    for(i=0; i<RDS_VOTE_CANDIDATES; i++)
+    {
+        if(!vote->weight[i])
+            continue;
+        if(best < 0 || vote->weight[i] > vote->weight[best])
+        {
+            if(best >= 0)
+                *second = vote->weight[best];
+            best = i;
+        }
+        else if(vote->weight[i] > *second)
+        {
+            *second = vote->weight[i];
+        }
+    }
+    return best;
+}
@@ -0,0 +1,19 @@
+#ifndef XDR_RDS_VOTE_H_
+#define XDR_RDS_VOTE_H_
+#include <glib.h>
+
+#define RDS_VOTE_CANDIDATES 4
+#define RDS_VOTE_THRESHOLD  16
+
+/* Weighted histogram of candidate bytes for one character position */
+typedef struct rds_vote
+{
+    guchar value[RDS_VOTE_CANDIDATES];
+    guchar weight[RDS_VOTE_CANDIDATES];
+} rds_vote_t;
+
+void rds_vote_reset(rds_vote_t*, gint);
+gint rds_vote_add(rds_vote_t*, guchar, gint);
+gint rds_vote_leader(const rds_vote_t*, gint*);
+
+#endif
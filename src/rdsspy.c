@@ -199,15 +199,16 @@ rdsspy_reset()
 }
 
 void
-rdsspy_send(gint   pi,
-            gchar *msg,
-            guint  errors)
+rdsspy_send(gint           pi,
+            const guint16 *data,
+            guint          errors)
 {
     if(!rdsspy_is_connected())
         return;
 
     gchar groups[4][5];
     gchar out[25];
+    gint i;
 
     /* 1st block (PI code) */
     if(pi >= 0)
@@ -219,37 +220,13 @@ rdsspy_send(gint   pi,
         g_snprintf(groups[0], 5, "----");
     }
 
-    /* 2nd block */
-    if((errors&3) == 0)
+    /* 2nd, 3rd and 4th block */
+    for(i=0; i<3; i++)
     {
-        strncpy(groups[1], msg, 4);
-        groups[1][4] = 0;
-    }
-    else
-    {
-        g_snprintf(groups[1], 5, "----");
-    }
-
-    /* 3rd block */
-    if((errors&12) == 0)
-    {
-        strncpy(groups[2], msg+4, 4);
-        groups[2][4] = 0;
-    }
-    else
-    {
-        g_snprintf(groups[2], 5, "----");
-    }
-
-    /* 4th block */
-    if((errors&48) == 0)
-    {
-        strncpy(groups[3], msg+8, 4);
-        groups[3][4] = 0;
-    }
-    else
-    {
-        g_snprintf(groups[3], 5, "----");
+        if(((errors >> (i*2)) & 3) == 0)
+            g_snprintf(groups[i+1], 5, "%04X", data[i]);
+        else
+            g_snprintf(groups[i+1], 5, "----");
     }
 
     g_snprintf(out, sizeof(out), "G:\r\n%s%s%s%s\r\n\r\n", groups[0], groups[1], groups[2], groups[3]);
@@ -43,7 +43,7 @@ static GtkWidget *page_rds, *table_rds;
 static GtkWidget *l_pty, *c_pty;
 static GtkWidget *x_rds_reset, *l_rds_timeout, *s_rds_timeout;
 static GtkWidget *l_ps_error, *l_ps_info_error, *c_ps_info_error, *l_ps_data_error, *c_ps_data_error;
-static GtkWidget *x_psprog, *l_rt_error, *l_rt_info_error, *c_rt_info_error, *l_rt_data_error, *c_rt_data_error;
+static GtkWidget *x_psprog, *x_psvote, *l_rt_error, *l_rt_info_error, *c_rt_info_error, *l_rt_data_error, *c_rt_data_error, *x_rtvote;
 
 /* Antenna page */
 static GtkWidget *page_ant, *table_ant;
@@ -344,7 +344,7 @@ settings_dialog(gint tab_num)
     gtk_container_set_border_width(GTK_CONTAINER(page_rds), 4);
     gtk_notebook_append_page(GTK_NOTEBOOK(notebook), page_rds, gtk_label_new("RDS"));
 
-    table_rds = gtk_table_new(12, 2, TRUE);
+    table_rds = gtk_table_new(14, 2, TRUE);
     gtk_table_set_homogeneous(GTK_TABLE(table_rds), FALSE);
     gtk_table_set_row_spacings(GTK_TABLE(table_rds), 4);
     gtk_table_set_col_spacings(GTK_TABLE(table_rds), 4);
@@ -409,6 +409,12 @@ settings_dialog(gint tab_num)
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(x_psprog), conf.rds_ps_progressive);
     gtk_table_attach(GTK_TABLE(table_rds), x_psprog, 0, 2, row, row+1, GTK_EXPAND|GTK_FILL, 0, 0, 0);
 
+    row++;
+    x_psvote = gtk_check_button_new_with_label("PS voting correction");
+    gtk_widget_set_tooltip_text(x_psvote, "Collect weighted votes for each character and show it only after a clear majority. Ignores the error correction settings above and takes precedence over the progressive correction. Useful for weak or fading signals.");
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(x_psvote), conf.rds_ps_voting);
+    gtk_table_attach(GTK_TABLE(table_rds), x_psvote, 0, 2, row, row+1, GTK_EXPAND|GTK_FILL, 0, 0, 0);
+
     row++;
     gtk_table_attach(GTK_TABLE(table_rds), gtk_hseparator_new(), 0, 2, row, row+1, GTK_EXPAND|GTK_FILL, 0, 0, 0);
 
@@ -440,6 +446,12 @@ settings_dialog(gint tab_num)
     gtk_combo_box_set_active(GTK_COMBO_BOX(c_rt_data_error), conf.rds_rt_data_error);
     gtk_table_attach(GTK_TABLE(table_rds), c_rt_data_error, 1, 2, row, row+1, GTK_EXPAND|GTK_FILL, 0, 0, 0);
 
+    row++;
+    x_rtvote = gtk_check_button_new_with_label("Radio Text voting correction");
+    gtk_widget_set_tooltip_text(x_rtvote, "Collect weighted votes for each character and show it only after a clear majority. Ignores the error correction settings above.");
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(x_rtvote), conf.rds_rt_voting);
+    gtk_table_attach(GTK_TABLE(table_rds), x_rtvote, 0, 2, row, row+1, GTK_EXPAND|GTK_FILL, 0, 0, 0);
+
 
     /* Antenna page */
     page_ant = gtk_vbox_new(FALSE, 5);
@@ -1025,8 +1037,11 @@ settings_dialog(gint tab_num)
     conf.rds_ps_info_error = gtk_combo_box_get_active(GTK_COMBO_BOX(c_ps_info_error));
     conf.rds_ps_data_error = gtk_combo_box_get_active(GTK_COMBO_BOX(c_ps_data_error));
     conf.rds_ps_progressive = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(x_psprog));
+    conf.rds_ps_voting = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(x_psvote));
     conf.rds_rt_info_error = gtk_combo_box_get_active(GTK_COMBO_BOX(c_rt_info_error));
     conf.rds_rt_data_error = gtk_combo_box_get_active(GTK_COMBO_BOX(c_rt_data_error));
+    conf.rds_rt_voting = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(x_rtvote));
+    tuner_rds_configure();
 
     /* Antenna page */
     conf.ant_show_alignment = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(x_alignment));
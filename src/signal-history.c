@@ -0,0 +1,219 @@
+#include <glib.h>
+#include <math.h>
+#include "signal-history.h"
+
+static void signal_bucket_empty(signal_bucket_t*);
+static void signal_bucket_add(signal_bucket_t*, const signal_bucket_t*, gboolean);
+static const signal_history_level_t* signal_history_level(const signal_history_t*, guint, guint*, guint*);
+static const signal_bucket_t* signal_history_bucket(const signal_history_level_t*, guint64);
+
+signal_history_t*
+signal_history_new()
+{
+    signal_history_t *history = g_new(signal_history_t, 1);
+    signal_history_clear(history);
+    return history;
+}
+
+void
+signal_history_free(signal_history_t *history)
+{
+    g_free(history);
+}
+
+void
+signal_history_clear(signal_history_t *history)
+{
+    gint i;
+
+    for(i=0; i<SIGNAL_HISTORY_LEVELS; i++)
+    {
+        history->levels[i].total = 0;
+        history->levels[i].partial_len = 0;
+        signal_bucket_empty(&history->levels[i].partial);
+    }
+    history->samples = 0;
+}
+
+void
+signal_history_push(signal_history_t *history,
+                    gfloat            value,
+                    gfloat            avg,
+                    gboolean          stereo,
+                    gboolean          rds,
+                    gint              freq)
+{
+    /* NAN is a gap, it takes its place in time but has no signal */
+    signal_history_level_t *level;
+    signal_bucket_t sample;
+    guint len = 1;
+    gint i;
+
+    sample.min = sample.max = value;
+    sample.mean = value;
+    sample.samples = !isnan(value);
+    sample.stereo = (sample.samples && stereo);
+    sample.rds = (sample.samples && rds);
+    sample.freq = freq;
+
+    /* Each level sums up the raw samples itself,
+     * a bucket is closed when its length is reached */
+    for(i=0; i<SIGNAL_HISTORY_LEVELS; i++)
+    {
+        level = &history->levels[i];
+        signal_bucket_add(&level->partial, &sample, !level->partial_len);
+        if(!i)
+            level->partial.mean = avg;
+
+        if(++level->partial_len == len)
+        {
+            level->buckets[level->total % SIGNAL_HISTORY_LEN] = level->partial;
+            level->total++;
+            level->partial_len = 0;
+            signal_bucket_empty(&level->partial);
+        }
+        len *= SIGNAL_HISTORY_FACTOR;
+    }
+    history->samples++;
+}
+
+guint
+signal_history_read(const signal_history_t *history,
+                    guint                   zoom,
+                    guint64                 since,
+                    signal_bucket_t        *out,
+                    guint                   count)
+{
+    /* Fills the buckets of count pixels, the newest first, each one
+     * covering zoom samples */
+    const signal_history_level_t *level;
+    const signal_bucket_t *bucket;
+    guint64 first, last, start, pixel, b;
+    guint factor, per_pixel;
+    guint n;
+
+    level = signal_history_level(history, zoom, &factor, &per_pixel);
+    last = level->total + (level->partial_len ? 1 : 0);
+    if(!last)
+        return 0;
+    last--;
+
+    first = (level->total > SIGNAL_HISTORY_LEN ? level->total - SIGNAL_HISTORY_LEN : 0);
+    first = MAX(first, since / factor);
+    if(first > last)
+        return 0;
+
+    /* Pixels are aligned to the buckets, so the graph scrolls steadily */
+    pixel = last / per_pixel;
+    for(n=0; n<count; n++, pixel--)
+    {
+        start = pixel * per_pixel;
+        if(start + per_pixel <= first)
+            break;
+
+        signal_bucket_empty(&out[n]);
+        for(b=MAX(start, first); b<start+per_pixel && b<=last; b++)
+        {
+            bucket = signal_history_bucket(level, b);
+            signal_bucket_add(&out[n], bucket, b == MAX(start, first));
+        }
+
+        if(!pixel)
+        {
+            n++;
+            break;
+        }
+    }
+    return n;
+}
+
+guint64
+signal_history_pixels(const signal_history_t *history,
+                      guint                   zoom)
+{
+    /* Number of the newest pixel plus one, pixels are aligned to the buckets */
+    const signal_history_level_t *level;
+    guint factor, per_pixel;
+    guint64 last;
+
+    level = signal_history_level(history, zoom, &factor, &per_pixel);
+    last = level->total + (level->partial_len ? 1 : 0);
+    return (last ? (last - 1) / per_pixel + 1 : 0);
+}
+
+static const signal_history_level_t*
+signal_history_level(const signal_history_t *history,
+                     guint                   zoom,
+                     guint                  *factor,
+                     guint                  *per_pixel)
+{
+    /* The highest level that divides the zoom is used,
+     * so a pixel never merges more than a few buckets */
+    gint i = 0;
+
+    zoom = MAX(zoom, 1);
+    *factor = 1;
+    while(i + 1 < SIGNAL_HISTORY_LEVELS &&
+          zoom % (*factor * SIGNAL_HISTORY_FACTOR) == 0)
+    {
+        *factor *= SIGNAL_HISTORY_FACTOR;
+        i++;
+    }
+    *per_pixel = zoom / *factor;
+    return &history->levels[i];
+}
+
+static void
+signal_bucket_empty(signal_bucket_t *bucket)
+{
+    bucket->min = NAN;
+    bucket->max = NAN;
+    bucket->mean = NAN;
+    bucket->samples = 0;
+    bucket->stereo = 0;
+    bucket->rds = 0;
+    bucket->freq = 0;
+}
+
+static void
+signal_bucket_add(signal_bucket_t       *bucket,
+                  const signal_bucket_t *other,
+                  gboolean               first)
+{
+    guint samples = bucket->samples + other->samples;
+
+    if(first)
+        bucket->freq = other->freq;
+    else if(bucket->freq != other->freq)
+        bucket->freq = 0;
+
+    if(!other->samples)
+        return;
+
+    if(!bucket->samples)
+    {
+        bucket->min = other->min;
+        bucket->max = other->max;
+        bucket->mean = other->mean;
+    }
+    else
+    {
+        bucket->min = MIN(bucket->min, other->min);
+        bucket->max = MAX(bucket->max, other->max);
+        bucket->mean += (other->mean - bucket->mean) * other->samples / samples;
+    }
+
+    bucket->samples = samples;
+    bucket->stereo += other->stereo;
+    bucket->rds += other->rds;
+}
+
+static const signal_bucket_t*
+signal_history_bucket(const signal_history_level_t *level,
+                      guint64                       n)
+{
+    /* The newest bucket may still be filling up */
+    if(n == level->total)
+        return &level->partial;
+    return &level->buckets[n % SIGNAL_HISTORY_LEN];
+}
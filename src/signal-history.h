@@ -0,0 +1,44 @@
+#ifndef XDR_SIGNAL_HISTORY_H_
+#define XDR_SIGNAL_HISTORY_H_
+#include <glib.h>
+
+/* Raw samples and buckets of 10, 100 and 1000 samples */
+#define SIGNAL_HISTORY_LEVELS 4
+#define SIGNAL_HISTORY_FACTOR 10
+
+/* Buckets kept at each level, the oldest ones are overwritten */
+#define SIGNAL_HISTORY_LEN 4096
+
+typedef struct signal_bucket
+{
+    gfloat min;
+    gfloat max;
+    gfloat mean;    /* raw samples: the average of the last samples */
+    guint samples;  /* samples with a signal, gaps are not counted */
+    guint stereo;
+    guint rds;
+    gint freq;      /* 0 if retuned within the bucket */
+} signal_bucket_t;
+
+typedef struct signal_history_level
+{
+    signal_bucket_t buckets[SIGNAL_HISTORY_LEN];
+    guint64 total;
+    signal_bucket_t partial;
+    guint partial_len;
+} signal_history_level_t;
+
+typedef struct signal_history
+{
+    signal_history_level_t levels[SIGNAL_HISTORY_LEVELS];
+    guint64 samples;
+} signal_history_t;
+
+signal_history_t* signal_history_new();
+void signal_history_free(signal_history_t*);
+void signal_history_clear(signal_history_t*);
+void signal_history_push(signal_history_t*, gfloat, gfloat, gboolean, gboolean, gint);
+guint64 signal_history_pixels(const signal_history_t*, guint);
+guint signal_history_read(const signal_history_t*, guint, guint64, signal_bucket_t*, guint);
+
+#endif
@@ -0,0 +1,175 @@
+#include <glib.h>
+#include <math.h>
+#include "signal-stats.h"
+
+#define SIGNAL_WINDOW_VALUE(window, n) ((window)->values[(n) % SIGNAL_WINDOW_MAX])
+
+static void signal_window_queue(const signal_window_t*, guint*, guint*, guint*, guint, gboolean);
+
+void
+signal_window_init(signal_window_t *window,
+                   guint            size)
+{
+    window->size = CLAMP(size, 1, SIGNAL_WINDOW_MAX);
+    signal_window_reset(window);
+}
+
+void
+signal_window_reset(signal_window_t *window)
+{
+    window->count = 0;
+    window->max_head = window->max_len = 0;
+    window->min_head = window->min_len = 0;
+    window->sum = 0.0;
+    window->sum_sq = 0.0;
+}
+
+void
+signal_window_push(signal_window_t *window,
+                   gfloat           value)
+{
+    guint n = window->count++;
+    gfloat old;
+
+    if(n >= window->size)
+    {
+        old = SIGNAL_WINDOW_VALUE(window, n - window->size);
+        window->sum -= old;
+        window->sum_sq -= (gdouble)old * old;
+    }
+
+    SIGNAL_WINDOW_VALUE(window, n) = value;
+    window->sum += value;
+    window->sum_sq += (gdouble)value * value;
+
+    signal_window_queue(window, window->max_queue, &window->max_head, &window->max_len, n, TRUE);
+    signal_window_queue(window, window->min_queue, &window->min_head, &window->min_len, n, FALSE);
+}
+
+guint
+signal_window_len(const signal_window_t *window)
+{
+    return MIN(window->count, window->size);
+}
+
+gfloat
+signal_window_max(const signal_window_t *window)
+{
+    if(!window->max_len)
+        return NAN;
+    return SIGNAL_WINDOW_VALUE(window, window->max_queue[window->max_head]);
+}
+
+gfloat
+signal_window_min(const signal_window_t *window)
+{
+    if(!window->min_len)
+        return NAN;
+    return SIGNAL_WINDOW_VALUE(window, window->min_queue[window->min_head]);
+}
+
+gdouble
+signal_window_mean(const signal_window_t *window)
+{
+    guint len = signal_window_len(window);
+    return (len ? window->sum / len : NAN);
+}
+
+gdouble
+signal_window_var(const signal_window_t *window)
+{
+    guint len = signal_window_len(window);
+    gdouble mean;
+
+    if(!len)
+        return NAN;
+    mean = window->sum / len;
+    return MAX(window->sum_sq / len - mean * mean, 0.0);
+}
+
+static void
+signal_window_queue(const signal_window_t *window,
+                    guint                 *queue,
+                    guint                 *head,
+                    guint                 *len,
+                    guint                  n,
+                    gboolean               max)
+{
+    /* Samples that can no longer be the extreme are dropped from the tail,
+     * the one that left the window from the head, each at most once */
+    gfloat value = SIGNAL_WINDOW_VALUE(window, n);
+    gfloat last;
+
+    if(*len && queue[*head] + window->size <= n)
+    {
+        *head = (*head + 1) % SIGNAL_WINDOW_MAX;
+        (*len)--;
+    }
+
+    while(*len)
+    {
+        last = SIGNAL_WINDOW_VALUE(window, queue[(*head + *len - 1) % SIGNAL_WINDOW_MAX]);
+        if(max ? (last > value) : (last < value))
+            break;
+        (*len)--;
+    }
+
+    queue[(*head + *len) % SIGNAL_WINDOW_MAX] = n;
+    (*len)++;
+}
+
+void
+signal_stats_reset(signal_stats_t *stats)
+{
+    stats->max = NAN;
+    stats->sum = 0.0;
+    stats->samples = 0;
+    stats->mean = 0.0;
+    stats->m2 = 0.0;
+    stats->smoothed = NAN;
+    signal_window_init(&stats->peak, SIGNAL_STATS_PEAK_WINDOW);
+    signal_window_init(&stats->avg, SIGNAL_STATS_AVG_WINDOW);
+}
+
+void
+signal_stats_add(signal_stats_t *stats,
+                 gfloat          value)
+{
+    gdouble delta;
+
+    if(isnan(stats->max) || value > stats->max)
+        stats->max = value;
+    stats->sum += value;
+    stats->samples++;
+
+    /* Welford's running variance */
+    delta = value - stats->mean;
+    stats->mean += delta / stats->samples;
+    stats->m2 += delta * (value - stats->mean);
+
+    if(isnan(stats->smoothed))
+        stats->smoothed = value;
+    else
+        stats->smoothed += SIGNAL_STATS_SMOOTHING * (value - stats->smoothed);
+
+    signal_window_push(&stats->peak, value);
+    signal_window_push(&stats->avg, value);
+}
+
+gdouble
+signal_stats_avg(const signal_stats_t *stats)
+{
+    return (stats->samples ? stats->sum / stats->samples : NAN);
+}
+
+gdouble
+signal_stats_var(const signal_stats_t *stats)
+{
+    return (stats->samples ? stats->m2 / stats->samples : NAN);
+}
+
+gdouble
+signal_stats_smoothed(const signal_stats_t *stats)
+{
+    return stats->smoothed;
+}
@@ -0,0 +1,59 @@
+#ifndef XDR_SIGNAL_STATS_H_
+#define XDR_SIGNAL_STATS_H_
+#include <glib.h>
+
+#define SIGNAL_WINDOW_MAX 64
+
+/* Samples of the peak hold and of the graph average */
+#define SIGNAL_STATS_PEAK_WINDOW 4
+#define SIGNAL_STATS_AVG_WINDOW  3
+
+/* Weight of the newest sample in the smoothed level */
+#define SIGNAL_STATS_SMOOTHING 0.2
+
+/* Sliding window over the last samples, the maximum and minimum
+ * are kept in monotonic queues of sample numbers */
+typedef struct signal_window
+{
+    gfloat values[SIGNAL_WINDOW_MAX];
+    guint size;
+    guint count;
+    guint max_queue[SIGNAL_WINDOW_MAX];
+    guint max_head;
+    guint max_len;
+    guint min_queue[SIGNAL_WINDOW_MAX];
+    guint min_head;
+    guint min_len;
+    gdouble sum;
+    gdouble sum_sq;
+} signal_window_t;
+
+/* Counted since the tuner was tuned, each sample is added once */
+typedef struct signal_stats
+{
+    gfloat max;
+    gdouble sum;
+    guint samples;
+    gdouble mean;
+    gdouble m2;
+    gdouble smoothed;
+    signal_window_t peak;
+    signal_window_t avg;
+} signal_stats_t;
+
+void signal_window_init(signal_window_t*, guint);
+void signal_window_reset(signal_window_t*);
+void signal_window_push(signal_window_t*, gfloat);
+guint signal_window_len(const signal_window_t*);
+gfloat signal_window_max(const signal_window_t*);
+gfloat signal_window_min(const signal_window_t*);
+gdouble signal_window_mean(const signal_window_t*);
+gdouble signal_window_var(const signal_window_t*);
+
+void signal_stats_reset(signal_stats_t*);
+void signal_stats_add(signal_stats_t*, gfloat);
+gdouble signal_stats_avg(const signal_stats_t*);
+gdouble signal_stats_var(const signal_stats_t*);
+gdouble signal_stats_smoothed(const signal_stats_t*);
+
+#endif
@@ -0,0 +1,301 @@
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef G_OS_WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#endif
+#include "station-db.h"
+
+/* File: a header followed by a power-of-two open addressing table,
+ * probed linearly from a hash of (PI, frequency). The table is used
+ * straight from the mapping, so opening it costs no parsing. */
+#define STATION_DB_MAGIC    "XDRSTDB1"
+#define STATION_DB_INITIAL  4096
+#define STATION_DB_LOAD_NUM 7
+#define STATION_DB_LOAD_DEN 10
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+typedef struct station_db_header
+{
+    gchar magic[8];
+    guint32 entry_size;
+    guint32 capacity;
+    guint32 count;
+    guint32 reserved[11];
+} station_db_header_t;
+
+G_STATIC_ASSERT(sizeof(station_db_entry_t) == 64);
+G_STATIC_ASSERT(sizeof(station_db_header_t) == 64);
+
+struct station_db
+{
+    gint fd;
+#ifdef G_OS_WIN32
+    HANDLE mapping;
+#endif
+    gpointer map;
+    gsize size;
+    station_db_header_t *header;
+    station_db_entry_t *entries;
+};
+
+static gboolean station_db_map(station_db_t*, gsize);
+static void station_db_unmap(station_db_t*);
+static gboolean station_db_create(station_db_t*, guint32);
+static gboolean station_db_valid(const station_db_t*);
+static gboolean station_db_grow(station_db_t*);
+static guint32 station_db_hash(gint, gint);
+static station_db_entry_t* station_db_find(const station_db_t*, gint, gint);
+
+station_db_t*
+station_db_open(const gchar *path)
+{
+    station_db_t *db;
+    gint fd;
+    off_t size;
+
+    fd = g_open(path, O_RDWR | O_CREAT | O_BINARY, 0600);
+    if(fd < 0)
+        return NULL;
+
+    db = g_new0(station_db_t, 1);
+    db->fd = fd;
+
+    size = lseek(fd, 0, SEEK_END);
+    if(size >= (off_t)sizeof(station_db_header_t) &&
+       station_db_map(db, size) &&
+       station_db_valid(db))
+        return db;
+
+    /* A missing or damaged database is started over */
+    station_db_unmap(db);
+    if(!station_db_create(db, STATION_DB_INITIAL))
+    {
+        station_db_close(db);
+        return NULL;
+    }
+    return db;
+}
+
+void
+station_db_close(station_db_t *db)
+{
+    station_db_unmap(db);
+    close(db->fd);
+    g_free(db);
+}
+
+const station_db_entry_t*
+station_db_lookup(const station_db_t *db,
+                  gint                pi,
+                  gint                freq)
+{
+    station_db_entry_t *entry;
+
+    /* The mapping is lost only if a failed grow could not restore it */
+    if(!db->map)
+        return NULL;
+
+    entry = station_db_find(db, pi, freq);
+    return (entry->freq ? entry : NULL);
+}
+
+station_db_entry_t*
+station_db_insert(station_db_t *db,
+                  gint          pi,
+                  gint          freq)
+{
+    /* The returned entry is valid until the next insert */
+    station_db_entry_t *entry;
+
+    if(freq <= 0 || !db->map)
+        return NULL;
+
+    entry = station_db_find(db, pi, freq);
+    if(entry->freq)
+        return entry;
+
+    if((db->header->count + 1) * STATION_DB_LOAD_DEN > db->header->capacity * STATION_DB_LOAD_NUM)
+    {
+        if(!station_db_grow(db))
+            return NULL;
+        entry = station_db_find(db, pi, freq);
+    }
+
+    memset(entry, 0, sizeof(station_db_entry_t));
+    entry->freq = freq;
+    entry->pi = pi;
+    entry->pty = 0xFF;
+    db->header->count++;
+    return entry;
+}
+
+guint
+station_db_count(const station_db_t *db)
+{
+    return (db->map ? db->header->count : 0);
+}
+
+static gboolean
+station_db_map(station_db_t *db,
+               gsize         size)
+{
+#ifdef G_OS_WIN32
+    HANDLE file = (HANDLE)_get_osfhandle(db->fd);
+
+    if(_chsize_s(db->fd, size))
+        return FALSE;
+
+    db->mapping = CreateFileMapping(file, NULL, PAGE_READWRITE,
+                                    (DWORD)((guint64)size >> 32), (DWORD)size, NULL);
+    if(!db->mapping)
+        return FALSE;
+
+    db->map = MapViewOfFile(db->mapping, FILE_MAP_WRITE, 0, 0, size);
+    if(!db->map)
+    {
+        CloseHandle(db->mapping);
+        db->mapping = NULL;
+        return FALSE;
+    }
+#else
+    if(ftruncate(db->fd, size) < 0)
+        return FALSE;
+
+    db->map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, db->fd, 0);
+    if(db->map == MAP_FAILED)
+    {
+        db->map = NULL;
+        return FALSE;
+    }
+#endif
+    db->size = size;
+    db->header = db->map;
+    db->entries = (station_db_entry_t*)(db->header + 1);
+    return TRUE;
+}
+
+static void
+station_db_unmap(station_db_t *db)
+{
+    if(!db->map)
+        return;
+
+#ifdef G_OS_WIN32
+    FlushViewOfFile(db->map, 0);
+    UnmapViewOfFile(db->map);
+    CloseHandle(db->mapping);
+    db->mapping = NULL;
+#else
+    msync(db->map, db->size, MS_ASYNC);
+    munmap(db->map, db->size);
+#endif
+    db->map = NULL;
+    db->header = NULL;
+    db->entries = NULL;
+}
+
+static gboolean
+station_db_create(station_db_t *db,
+                  guint32       capacity)
+{
+    gsize size = sizeof(station_db_header_t) + (gsize)capacity * sizeof(station_db_entry_t);
+
+    if(!station_db_map(db, size))
+        return FALSE;
+
+    memset(db->map, 0, size);
+    memcpy(db->header->magic, STATION_DB_MAGIC, sizeof(db->header->magic));
+    db->header->entry_size = sizeof(station_db_entry_t);
+    db->header->capacity = capacity;
+    db->header->count = 0;
+    return TRUE;
+}
+
+static gboolean
+station_db_valid(const station_db_t *db)
+{
+    const station_db_header_t *header = db->header;
+
+    return !memcmp(header->magic, STATION_DB_MAGIC, sizeof(header->magic)) &&
+           header->entry_size == sizeof(station_db_entry_t) &&
+           header->capacity &&
+           !(header->capacity & (header->capacity - 1)) &&
+           header->count < header->capacity &&
+           db->size == sizeof(station_db_header_t) + (gsize)header->capacity * sizeof(station_db_entry_t);
+}
+
+static gboolean
+station_db_grow(station_db_t *db)
+{
+    /* The current table is copied aside and rehashed into one of double
+     * size. If the larger one cannot be mapped, the copy is put back. */
+    guint32 capacity = db->header->capacity;
+    gsize size = db->size;
+    station_db_header_t *old;
+    station_db_entry_t *old_entries, *entry;
+    guint32 i;
+
+    old = g_memdup(db->map, size);
+    old_entries = (station_db_entry_t*)(old + 1);
+    station_db_unmap(db);
+
+    if(!station_db_create(db, capacity * 2))
+    {
+        if(station_db_map(db, size))
+            memcpy(db->map, old, size);
+        g_free(old);
+        return FALSE;
+    }
+
+    for(i=0; i<capacity; i++)
+    {
+        if(!old_entries[i].freq)
+            continue;
+        entry = station_db_find(db, old_entries[i].pi, old_entries[i].freq);
+        *entry = old_entries[i];
+        db->header->count++;
+    }
+
+    g_free(old);
+    return TRUE;
+}
+
+static guint32
+station_db_hash(gint pi,
+                gint freq)
+{
+    guint32 h = (guint32)pi * 0x9E3779B1u ^ (guint32)freq * 0x85EBCA77u;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+}
+
+static station_db_entry_t*
+station_db_find(const station_db_t *db,
+                gint                pi,
+                gint                freq)
+{
+    /* Matching entry or the empty slot where it belongs */
+    guint32 mask = db->header->capacity - 1;
+    guint32 i = station_db_hash(pi, freq) & mask;
+    station_db_entry_t *entry;
+
+    for(;;)
+    {
+        entry = &db->entries[i];
+        if(!entry->freq ||
+           (entry->freq == (guint32)freq && entry->pi == (guint16)pi))
+            return entry;
+        i = (i + 1) & mask;
+    }
+}
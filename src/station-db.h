@@ -0,0 +1,33 @@
+#ifndef XDR_STATION_DB_H_
+#define XDR_STATION_DB_H_
+#include <glib.h>
+
+#define STATION_DB_PS_LEN  8
+#define STATION_DB_AF_MAX 25
+
+#define STATION_DB_HAS_PS 0x01
+
+/* One (PI, frequency) slot, 64 bytes in the native byte order */
+typedef struct station_db_entry
+{
+    gint64 last_heard;  /* Unix time in seconds */
+    guint32 freq;       /* kHz, zero marks an empty slot */
+    guint16 pi;
+    guint8 pty;         /* 0xFF when unknown */
+    guint8 ecc;         /* zero when unknown */
+    gchar ps[STATION_DB_PS_LEN];
+    guint8 af[STATION_DB_AF_MAX];
+    guint8 af_count;
+    guint8 flags;
+    guint8 reserved[13];
+} station_db_entry_t;
+
+typedef struct station_db station_db_t;
+
+station_db_t* station_db_open(const gchar*);
+void station_db_close(station_db_t*);
+const station_db_entry_t* station_db_lookup(const station_db_t*, gint, gint);
+station_db_entry_t* station_db_insert(station_db_t*, gint, gint);
+guint station_db_count(const station_db_t*);
+
+#endif
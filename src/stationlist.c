@@ -31,7 +31,7 @@ static struct sockaddr_in stationlist_client_addr;
 static gint stationlist_sender;
 static GMutex stationlist_mutex;
 static GSList *stationlist_buffer;
-static guint8 stationlist_af_buffer[STATIONLIST_AF_BUFF_LEN];
+static gchar stationlist_af_buffer[STATIONLIST_AF_BUFF_LEN*2+1];
 static guint8 stationlist_af_buffer_pos;
 
 static gpointer stationlist_server(gpointer);
@@ -169,17 +169,26 @@ static void
 stationlist_cmd(gchar *param,
                 gchar *value)
 {
+    /* Runs in the SRCP thread, the tuner state is read from the snapshot */
+    tuner_state_t state;
+
     if(!g_ascii_strcasecmp(param, "freq"))
     {
         if(!g_ascii_strcasecmp(value, "?"))
-            stationlist_freq(tuner_get_freq());
+        {
+            tuner_snapshot_read(&tuner.snapshot, &state);
+            stationlist_freq(state.freq - state.offset[CLAMP(state.antenna, 0, TUNER_STATE_ANTENNAS-1)]);
+        }
         else
             g_idle_add(stationlist_set_freq, GINT_TO_POINTER(atoi(value)));
     }
     else if(!g_ascii_strcasecmp(param, "bandwidth"))
     {
         if(!g_ascii_strcasecmp(value, "?"))
-            stationlist_bw(tuner_filter_bw(tuner.filter));
+        {
+            tuner_snapshot_read(&tuner.snapshot, &state);
+            stationlist_bw(tuner_filter_bw(state.filter));
+        }
         else
             g_idle_add(stationlist_set_bw, GINT_TO_POINTER(atoi(value)));
     }
@@ -248,7 +257,7 @@ stationlist_ecc(guchar ecc)
 }
 
 void
-stationlist_ps(gchar *ps)
+stationlist_ps(const gchar *ps)
 {
     if(stationlist_is_up())
     {
@@ -257,8 +266,8 @@ stationlist_ps(gchar *ps)
 }
 
 void
-stationlist_rt(gint   n,
-               gchar *rt)
+stationlist_rt(gint         n,
+               const gchar *rt)
 {
     GString *msg;
     gchar *msg_full;
@@ -289,48 +298,50 @@ stationlist_af(gint af)
 {
     if(stationlist_is_up())
     {
-        stationlist_af_buffer[stationlist_af_buffer_pos] = af;
+        /* Only the two hex digits of the new slot are rewritten */
+        static const gchar hex[] = "0123456789ABCDEF";
+        stationlist_af_buffer[stationlist_af_buffer_pos*2] = hex[(af >> 4) & 0xF];
+        stationlist_af_buffer[stationlist_af_buffer_pos*2+1] = hex[af & 0xF];
         stationlist_af_buffer_pos = (stationlist_af_buffer_pos + 1) % STATIONLIST_AF_BUFF_LEN;
 
-        stationlist_add(g_strdup("af"),
-                        g_strdup_printf("%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X",
-                                        stationlist_af_buffer[0],
-                                        stationlist_af_buffer[1],
-                                        stationlist_af_buffer[2],
-                                        stationlist_af_buffer[3],
-                                        stationlist_af_buffer[4],
-                                        stationlist_af_buffer[5],
-                                        stationlist_af_buffer[6],
-                                        stationlist_af_buffer[7],
-                                        stationlist_af_buffer[8],
-                                        stationlist_af_buffer[9],
-                                        stationlist_af_buffer[10],
-                                        stationlist_af_buffer[11],
-                                        stationlist_af_buffer[12],
-                                        stationlist_af_buffer[13],
-                                        stationlist_af_buffer[14],
-                                        stationlist_af_buffer[15],
-                                        stationlist_af_buffer[16],
-                                        stationlist_af_buffer[17],
-                                        stationlist_af_buffer[18],
-                                        stationlist_af_buffer[19],
-                                        stationlist_af_buffer[20],
-                                        stationlist_af_buffer[21],
-                                        stationlist_af_buffer[22],
-                                        stationlist_af_buffer[23],
-                                        stationlist_af_buffer[24])
-                       );
+        stationlist_add(g_strdup("af"), g_strdup(stationlist_af_buffer));
     }
 }
 
 void
-stationlist_af_clear()
+stationlist_rds(const rds_decoder_t *decoder,
+                const rds_event_t   *event,
+                gpointer             user_data)
 {
-    gint i;
-    for(i=0; i<STATIONLIST_AF_BUFF_LEN; i++)
+    switch(event->type)
     {
-        stationlist_af_buffer[i] = 0;
+    case RDS_EVENT_PI:
+        stationlist_pi(decoder->pi);
+        break;
+    case RDS_EVENT_PTY:
+        stationlist_pty(event->value);
+        break;
+    case RDS_EVENT_ECC:
+        if(event->value >= 0xE0 && event->value <= 0xE4)
+            stationlist_ecc(event->value);
+        break;
+    case RDS_EVENT_AF:
+        stationlist_af(event->value);
+        break;
+    case RDS_EVENT_PS:
+        stationlist_ps(event->ps.text);
+        break;
+    case RDS_EVENT_RT:
+        stationlist_rt(event->rt.flag, event->rt.text);
+        break;
     }
+}
+
+void
+stationlist_af_clear()
+{
+    memset(stationlist_af_buffer, '0', STATIONLIST_AF_BUFF_LEN*2);
+    stationlist_af_buffer[STATIONLIST_AF_BUFF_LEN*2] = 0;
     stationlist_af_buffer_pos = 0;
 }
 
@@ -1,5 +1,10 @@
 #ifndef XDR_STATIONLIST_H_
 #define XDR_STATIONLIST_H_
+#include "rds-decoder.h"
+
+#define STATIONLIST_RDS_EVENTS (RDS_EVENT_MASK(RDS_EVENT_PI) | RDS_EVENT_MASK(RDS_EVENT_PTY) | \
+                                RDS_EVENT_MASK(RDS_EVENT_ECC) | RDS_EVENT_MASK(RDS_EVENT_AF) | \
+                                RDS_EVENT_MASK(RDS_EVENT_PS) | RDS_EVENT_MASK(RDS_EVENT_RT))
 
 typedef struct
 {
@@ -16,12 +21,14 @@ void stationlist_rcvlevel(gint);
 void stationlist_pi(gint);
 void stationlist_pty(gint);
 void stationlist_ecc(guchar);
-void stationlist_ps(gchar*);
-void stationlist_rt(gint, gchar*);
+void stationlist_ps(const gchar*);
+void stationlist_rt(gint, const gchar*);
 void stationlist_bw(gint filter);
 void stationlist_af(gint af);
 void stationlist_af_clear();
 
+void stationlist_rds(const rds_decoder_t*, const rds_event_t*, gpointer);
+
 #endif
 
 
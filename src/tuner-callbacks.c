@@ -4,14 +4,16 @@
 #include "ui-tuner-update.h"
 #include "tuner.h"
 #include "conf.h"
+#include "log.h"
 
 #include "rdsspy.h"
+#include "ui-connect.h"
 
 #define DEFAULT_SAMPLING_INTERVAL 66
 
-#define RDS_BLOCK_B 0
-#define RDS_BLOCK_C 1
-#define RDS_BLOCK_D 2
+static void tuner_station_cached();
+static void tuner_rds_sync();
+static void tuner_rds_restore();
 
 gboolean
 tuner_ready(gpointer data)
@@ -21,6 +23,37 @@ tuner_ready(gpointer data)
     return FALSE;
 }
 
+gboolean
+tuner_diversity_ready(gpointer data)
+{
+    tuner.diversity_ready = TRUE;
+    tuner_diversity_tune();
+    return FALSE;
+}
+
+gboolean
+tuner_diversity_disconnect(gpointer data)
+{
+    /* The merge has already been detached by the reader thread */
+    tuner.diversity = NULL;
+    tuner.diversity_ready = FALSE;
+    connection_merge_release();
+    return FALSE;
+}
+
+gboolean
+tuner_diversity_scan(gpointer data)
+{
+    tuner_scan_free((tuner_scan_t*)data);
+    return FALSE;
+}
+
+gboolean
+tuner_diversity_ignore(gpointer data)
+{
+    return FALSE;
+}
+
 gboolean
 tuner_unauthorized(gpointer data)
 {
@@ -31,8 +64,8 @@ tuner_unauthorized(gpointer data)
 gboolean
 tuner_disconnect(gpointer data)
 {
-    tuner_clear_all(); /* tuner.thread = NULL */
-    g_free(data); /* free tuner_thread_t */
+    tuner_clear_all(); /* tuner.thread = NULL, tuner_thread_t is released by its queue */
+    connection_merge_release();
 
     rdsspy_reset();
     return FALSE;
@@ -42,6 +75,11 @@ gboolean
 tuner_freq(gpointer data)
 {
     gint freq = GPOINTER_TO_INT(data);
+    gint64 now = g_get_monotonic_time();
+
+    /* Reception statistics of the frequency being left go to its log */
+    log_stats(&tuner.rds_stats, now);
+
     if(freq != tuner.freq ||
        (tuner.prevantenna != tuner.antenna &&
         tuner.offset[tuner.prevantenna] != tuner.offset[tuner.antenna]))
@@ -50,18 +88,22 @@ tuner_freq(gpointer data)
         tuner.prevantenna = tuner.antenna;
         tuner.freq = freq;
     }
+    tuner_diversity_tune();
 
 
+    /* The reader thread has already switched its RDS state to the new frequency */
     tuner_clear_signal();
-    tuner_clear_rds();
+    tuner_clear_rds_view();
     ui_update_freq();
 
-    tuner.signal     = NAN;
-    tuner.signal_max = NAN;
-    tuner.signal_sum = 0.0;
-    tuner.signal_samples = 0;
+    tuner.signal = NAN;
     tuner.ready_tuned = TRUE;
+    rds_timing_tune(&tuner.rds_timing, now, tuner_ps_mode());
+    rds_stats_reset(&tuner.rds_stats, now);
+    tuner_rds_sync();
 
+    if(tuner.rds_archive)
+        rds_archive_freq(tuner.rds_archive, tuner_get_freq());
     rdsspy_reset();
     return FALSE;
 }
@@ -70,6 +112,7 @@ gboolean
 tuner_daa(gpointer data)
 {
     tuner.daa = GPOINTER_TO_INT(data);
+    ui_update_controls();
     return FALSE;
 }
 
@@ -83,10 +126,7 @@ tuner_signal(gpointer data)
             tuner.rds--;
 
         tuner.signal = signal->value;
-        if(isnan(tuner.signal_max) || tuner.signal > tuner.signal_max)
-            tuner.signal_max = tuner.signal;
-        tuner.signal_sum += tuner.signal;
-        tuner.signal_samples++;
+        signal_stats_add(&tuner.signal_stats, tuner.signal);
         ui_update_signal();
 
         tuner.stereo = signal->stereo & SIGNAL_STEREO;
@@ -94,7 +134,6 @@ tuner_signal(gpointer data)
         ui_update_stereo_flag();
         ui_update_rds_flag();
     }
-    g_free(data);
     return FALSE;
 }
 
@@ -121,191 +160,264 @@ tuner_pi(gpointer data)
     gint err_level = (GPOINTER_TO_INT(data) & 0x30000) >> 16;
     gint interval = (tuner.sampling_interval ? tuner.sampling_interval : DEFAULT_SAMPLING_INTERVAL);
 
-    if(err_level > tuner.rds_pi_err_level &&
-       tuner.rds_pi != pi)
+    rds_stats_pi(&tuner.rds_stats, err_level);
+    tuner_rds_sync();
+    if(tuner.rds_archive)
+        rds_archive_pi(tuner.rds_archive, pi, err_level);
+    if(tuner.rds_decoder.pi != pi)
         return FALSE;
 
     /* RDS stream: 1187.5 bps
      * One group: 104 bits (each has PI code) */
     tuner.rds = ceil(1000 * 104 / 1187.5 / interval) + 1;
     tuner.rds_reset_timer = g_get_real_time();
-
-    tuner.rds_pi = pi;
-    if(err_level < tuner.rds_pi_err_level)
-        tuner.rds_pi_err_level = err_level;
-
-    ui_update_pi();
+    ui_update_rds_reset();
     return FALSE;
 }
 
 gboolean
-tuner_rds(gpointer msg_ptr)
+tuner_rds(gpointer ptr)
 {
-    gchar *msg = (gchar*)msg_ptr;
-    guint data[3], errors, i;
+    tuner_rds_t *rds = (tuner_rds_t*)ptr;
+    const rds_decoder_t *decoder = &tuner.rds_decoder;
+
+    rds_stats_group(&tuner.rds_stats, rds->data, rds->errors);
+    tuner_rds_sync();
+    if(tuner.rds_archive)
+        rds_archive_group(tuner.rds_archive, g_get_real_time(), rds->data, rds->errors);
+
+    /* RDS Spy takes raw groups, without PI when the RDS flag is off */
+    if(decoder->pi >= 0 && !decoder->provisional)
+        rdsspy_send((tuner.rds ? decoder->pi : -1), rds->data, rds->errors);
+    return FALSE;
+}
 
-    if(tuner.rds_pi < 0)
+void
+tuner_rds_decoded(const rds_decoder_t *decoder,
+                  const rds_event_t   *event,
+                  gpointer             user_data)
+{
+    /* Mirror the decoder state for the user interface */
+    switch(event->type)
     {
-        g_free(msg);
-        return FALSE;
+    case RDS_EVENT_PI:
+        /* The decoder keeps alternative frequencies per PI */
+        if(tuner.rds_pi >= 0 && tuner.rds_pi != decoder->pi)
+            ui_clear_af();
+        tuner.rds_pi = decoder->pi;
+        tuner.rds_pi_err_level = decoder->pi_err_level;
+        ui_update_pi();
+        tuner_station_cached();
+        break;
+    case RDS_EVENT_PTY:
+        tuner.rds_pty = event->value;
+        ui_update_pty();
+        break;
+    case RDS_EVENT_TP:
+        tuner.rds_tp = event->value;
+        ui_update_tp();
+        break;
+    case RDS_EVENT_TA:
+        tuner.rds_ta = event->value;
+        ui_update_ta();
+        break;
+    case RDS_EVENT_MS:
+        tuner.rds_ms = event->value;
+        ui_update_ms();
+        break;
+    case RDS_EVENT_AF:
+        ui_update_af(event->value);
+        break;
+    case RDS_EVENT_PS:
+        rds_timing_ps(&tuner.rds_timing, g_get_monotonic_time(), rds_decoder_ps_complete(decoder));
+        /* A cached name stays until the received one is complete */
+        if(tuner.rds_ps_cached && !rds_decoder_ps_complete(decoder))
+            break;
+        memcpy(tuner.rds_ps, event->ps.text, sizeof(tuner.rds_ps));
+        memcpy(tuner.rds_ps_err, event->ps.err, sizeof(tuner.rds_ps_err));
+        tuner.rds_ps_avail = TRUE;
+        tuner.rds_ps_cached = FALSE;
+        ui_update_ps();
+        break;
+    case RDS_EVENT_RT:
+        memcpy(tuner.rds_rt[event->rt.flag], event->rt.text, sizeof(tuner.rds_rt[event->rt.flag]));
+        tuner.rds_rt_avail[event->rt.flag] = TRUE;
+        ui_update_rt(event->rt.flag);
+        break;
+    case RDS_EVENT_RESTORE:
+        /* Confirmed state is replayed, discarded state is cleared */
+        if(event->value)
+        {
+            tuner.rds_ps_cached = FALSE;
+            ui_clear_af();
+        }
+        else
+            tuner_clear_rds_data();
+        break;
     }
+}
+
+void
+tuner_rds_station(const rds_decoder_t *decoder,
+                  const rds_event_t   *event,
+                  gpointer             user_data)
+{
+    /* Store confirmed data of an error-free PI in the station database */
+    station_db_entry_t *entry;
+    gint i;
+
+    if(!tuner.station_db || decoder->pi_err_level)
+        return;
+
+    if(!(entry = station_db_insert(tuner.station_db, decoder->pi, tuner_get_freq())))
+        return;
 
-    for(i=0; i<3; i++)
+    entry->last_heard = g_get_real_time() / G_USEC_PER_SEC;
+
+    switch(event->type)
     {
-        gchar hex[5];
-        strncpy(hex, msg+i*4, 4);
-        hex[4] = 0;
-        sscanf(hex, "%x", &data[i]);
+    case RDS_EVENT_PTY:
+        entry->pty = event->value;
+        break;
+    case RDS_EVENT_ECC:
+        entry->ecc = event->value;
+        break;
+    case RDS_EVENT_AF:
+        for(i=0; i<entry->af_count; i++)
+            if(entry->af[i] == event->value)
+                break;
+        if(i == entry->af_count && entry->af_count < STATION_DB_AF_MAX)
+            entry->af[entry->af_count++] = event->value;
+        break;
+    case RDS_EVENT_PS:
+        if(!rds_decoder_ps_complete(decoder))
+            break;
+        for(i=0; i<RDS_PS_LEN; i++)
+            if(event->ps.err[i])
+                break;
+        if(i < RDS_PS_LEN)
+            break;
+        memcpy(entry->ps, event->ps.text, STATION_DB_PS_LEN);
+        entry->flags |= STATION_DB_HAS_PS;
+        break;
     }
-    sscanf(msg+12, "%x", &errors);
-
-    guchar group = (data[RDS_BLOCK_B] & 0xF000) >> 12;
-    gboolean flag = (data[RDS_BLOCK_B] & 0x0800) >> 11;
-    guchar err[] = { (errors&3), ((errors&12)>>2), ((errors&48)>>4) };
+}
 
-    rdsspy_send((tuner.rds ? tuner.rds_pi : -1), msg, errors);
+void
+tuner_rds_stats(const rds_decoder_t *decoder,
+                const rds_event_t   *event,
+                gpointer             user_data)
+{
+    /* Time from the tune to the first PI, complete PS and complete RT */
+    gint64 now = g_get_monotonic_time();
 
-    // PTY, TP, TA, MS, AF, ECC: error-free blocks
-    if(!err[RDS_BLOCK_B])
+    switch(event->type)
     {
-        gchar pty = (data[RDS_BLOCK_B] & 0x03E0) >> 5;
-        gchar tp = (data[RDS_BLOCK_B] & 0x400) >> 10;
+    case RDS_EVENT_PI:
+        rds_stats_mark(&tuner.rds_stats, RDS_STATS_PI, now);
+        break;
+    case RDS_EVENT_PS:
+        if(rds_decoder_ps_complete(decoder))
+            rds_stats_mark(&tuner.rds_stats, RDS_STATS_PS, now);
+        break;
+    case RDS_EVENT_RT:
+        if(rds_decoder_rt_complete(decoder, event->rt.flag))
+            rds_stats_mark(&tuner.rds_stats, RDS_STATS_RT, now);
+        break;
+    }
+}
 
-        if(tuner.rds_pty != pty)
-        {
-            tuner.rds_pty = pty;
-            ui_update_pty();
-        }
+static void
+tuner_rds_sync()
+{
+    /* Renders what the reader thread has decoded since the last call */
+    static tuner_state_t state;
+    gboolean provisional = tuner.rds_decoder.provisional;
 
-        if(tuner.rds_tp != tp)
-        {
-            tuner.rds_tp = tp;
-            ui_update_tp();
-        }
+    if(tuner_snapshot_sequence(&tuner.snapshot) == tuner.rds_synced)
+        return;
+    tuner.rds_synced = tuner_snapshot_read(&tuner.snapshot, &state);
 
-        if(group == 0)
-        {
-            gchar ta = (data[RDS_BLOCK_B] & 0x10) >> 4;
-            gchar ms = (data[RDS_BLOCK_B] & 0x8) >> 3;
-            if(tuner.rds_ta != ta)
-            {
-                tuner.rds_ta = ta;
-                ui_update_ta();
-            }
-            if(tuner.rds_ms != ms)
-            {
-                tuner.rds_ms = ms;
-                ui_update_ms();
-            }
-
-            // AF
-            if(!err[RDS_BLOCK_C] && !flag)
-            {
-                guchar af[] = { data[RDS_BLOCK_C] >> 8, data[RDS_BLOCK_C] & 0xFF };
-                for(i=0; i<2; i++)
-                    if(af[i]>0 && af[i]<205)
-                        ui_update_af(af[i]);
-            }
-        }
+    /* A state of another frequency or from before a reset is not shown */
+    if(state.freq != tuner.freq || state.generation != tuner.rds_generation)
+        return;
 
-        // ECC
-        if(group == 1 && !flag && !err[RDS_BLOCK_C])
-        {
-            if(!(data[RDS_BLOCK_C] >> 12))
-            {
-                guchar ecc = data[RDS_BLOCK_C] & 255;
-                if(tuner.rds_ecc != ecc)
-                {
-                    tuner.rds_ecc = ecc;
-                    ui_update_ecc();
-                }
-            }
-        }
+    rds_decoder_sync(&tuner.rds_decoder, &state.rds);
+    if(!provisional && tuner.rds_decoder.provisional)
+        tuner_rds_restore();
+}
+
+static void
+tuner_rds_restore()
+{
+    /* Provisional state of a recently tuned frequency, shown until the first PI */
+    const rds_decoder_t *decoder = &tuner.rds_decoder;
+    gint i;
+
+    tuner.rds_pi = decoder->pi;
+    tuner.rds_pi_err_level = decoder->pi_err_level;
+    ui_update_pi();
+    tuner.rds_pty = decoder->pty;
+    ui_update_pty();
+    tuner.rds_tp = decoder->tp;
+    ui_update_tp();
+    tuner.rds_ta = decoder->ta;
+    ui_update_ta();
+    tuner.rds_ms = decoder->ms;
+    ui_update_ms();
+
+    if(rds_decoder_ps_avail(decoder))
+    {
+        memcpy(tuner.rds_ps, decoder->ps, sizeof(tuner.rds_ps));
+        memcpy(tuner.rds_ps_err, decoder->ps_err, sizeof(tuner.rds_ps_err));
+        tuner.rds_ps_avail = TRUE;
+        tuner.rds_ps_cached = TRUE;
+        ui_update_ps();
     }
 
-    // PS: user-defined error correction
-    if(conf.rds_ps_progressive || err[RDS_BLOCK_B] <= conf.rds_ps_info_error)
+    for(i=0; i<2; i++)
     {
-        if(err[RDS_BLOCK_B] < 3 &&
-           err[RDS_BLOCK_D] < 3 &&
-           group == 0 &&
-           (conf.rds_ps_progressive || (err[RDS_BLOCK_D] <= conf.rds_ps_data_error)))
+        if(rds_decoder_rt_avail(decoder, i))
         {
-            gchar pos = data[RDS_BLOCK_B] & 3;
-            gchar ps[] = { data[RDS_BLOCK_D] >> 8, data[RDS_BLOCK_D] & 0xFF };
-            gboolean changed = FALSE;
-            guchar e = 2*err[RDS_BLOCK_B] + 3*err[RDS_BLOCK_D];
-
-            for(i=0; i<2; i++)
-            {
-                // only ASCII printable characters
-                if(ps[i] >= 32 && ps[i] < 127)
-                {
-                    gint p = pos*2+i;
-                    if(!conf.rds_ps_progressive || tuner.rds_ps_err[p] >= e)
-                    {
-                        if(tuner.rds_ps[p] != ps[i] || tuner.rds_ps_err[p] > e)
-                        {
-                            tuner.rds_ps[p] = ps[i];
-                            tuner.rds_ps_err[p] = e;
-                            changed = TRUE;
-                        }
-                    }
-                }
-            }
-
-            if(changed)
-            {
-                tuner.rds_ps_avail = TRUE;
-                ui_update_ps(TRUE);
-            }
+            memcpy(tuner.rds_rt[i], decoder->rt[i], sizeof(tuner.rds_rt[i]));
+            tuner.rds_rt_avail[i] = TRUE;
+            ui_update_rt(i);
         }
     }
 
-    // RT: user-defined error correction
-    if(err[RDS_BLOCK_B] <= conf.rds_rt_info_error)
+    for(i=0; i<decoder->af.count; i++)
+        ui_update_af(decoder->af.freq[i]);
+}
+
+static void
+tuner_station_cached()
+{
+    /* Show the last confirmed name of a known station until its PS is received */
+    const station_db_entry_t *entry;
+
+    if(!tuner.station_db || (tuner.rds_ps_avail && !tuner.rds_ps_cached))
+        return;
+
+    entry = station_db_lookup(tuner.station_db, tuner.rds_pi, tuner_get_freq());
+    if(entry && (entry->flags & STATION_DB_HAS_PS))
     {
-        if(group == 2)
-        {
-            short pos  = (data[RDS_BLOCK_B] & 15);
-            gboolean flag = (data[RDS_BLOCK_B] & 16) >> 4;
-            gchar rt[] = { data[RDS_BLOCK_C]>>8, data[RDS_BLOCK_C]&0xFF, data[RDS_BLOCK_D]>>8, data[RDS_BLOCK_D]&0xFF };
-            gboolean changed = FALSE;
-
-            for(i=0; i<4; i++)
-            {
-                if(tuner.rds_rt[flag][pos*4+i] == rt[i])
-                    continue;
-
-                if(rt[i] == 0x0D) // end of the RadioText message
-                {
-                    if ((i <= 1 && (errors&15) == 0) || (i >= 2 && (errors&51) == 0))
-                    {
-                        tuner.rds_rt[flag][pos*4+i] = 0;
-                        changed = TRUE;
-                    }
-                }
-                // only ASCII printable characters
-                else if(rt[i] >= 32 && rt[i] < 127)
-                {
-                    if( (i <= 1 && ((errors&12)>>2) <= conf.rds_rt_data_error) || (i >= 2 && ((errors&48)>>4) <= conf.rds_rt_data_error) )
-                    {
-                        tuner.rds_rt[flag][pos*4+i] = rt[i];
-                        changed = TRUE;
-                    }
-                }
-            }
-
-            if(changed)
-            {
-                tuner.rds_rt_avail[flag] = TRUE;
-                ui_update_rt(flag);
-            }
-        }
+        memcpy(tuner.rds_ps, entry->ps, STATION_DB_PS_LEN);
+        tuner.rds_ps[STATION_DB_PS_LEN] = 0;
+        memset(tuner.rds_ps_err, 0, sizeof(tuner.rds_ps_err));
+        tuner.rds_ps_avail = TRUE;
+        tuner.rds_ps_cached = TRUE;
+    }
+    else if(tuner.rds_ps_cached)
+    {
+        tuner.rds_ps_avail = FALSE;
+        tuner.rds_ps_cached = FALSE;
+    }
+    else
+    {
+        return;
     }
 
-    g_free(msg);
-    return FALSE;
+    ui_update_ps();
 }
 
 gboolean
@@ -334,6 +446,7 @@ gboolean
 tuner_volume(gpointer data)
 {
     tuner.volume = GPOINTER_TO_INT(data);
+    ui_update_controls();
     return FALSE;
 }
 
@@ -341,6 +454,7 @@ gboolean
 tuner_agc(gpointer data)
 {
     tuner.agc = GPOINTER_TO_INT(data);
+    ui_update_controls();
     return FALSE;
 }
 
@@ -348,6 +462,7 @@ gboolean
 tuner_deemphasis(gpointer data)
 {
     tuner.deemphasis = GPOINTER_TO_INT(data);
+    ui_update_controls();
     return FALSE;
 }
 
@@ -355,6 +470,7 @@ gboolean
 tuner_antenna(gpointer data)
 {
     tuner.antenna = GPOINTER_TO_INT(data);
+    ui_update_controls();
     if(conf.ant_clear_rds)
     {
         tuner_clear_rds();
@@ -379,6 +495,7 @@ tuner_gain(gpointer data)
     tuner.rfgain = (gain == 10 || gain == 11);
     tuner.ifgain = (gain ==  1 || gain == 11);
     tuner_clear_signal();
+    ui_update_controls();
     return FALSE;
 }
 
@@ -391,6 +508,7 @@ tuner_mode(gpointer data)
     ui_update_mode();
     tuner.filter = -1;
     ui_update_filter();
+    ui_update_controls();
     return FALSE;
 }
 
@@ -399,6 +517,7 @@ tuner_filter(gpointer data)
 {
     tuner.filter = GPOINTER_TO_INT(data);
     ui_update_filter();
+    ui_update_controls();
     return FALSE;
 }
 
@@ -406,6 +525,7 @@ gboolean
 tuner_squelch(gpointer data)
 {
     tuner.squelch = GPOINTER_TO_INT(data);
+    ui_update_controls();
     return FALSE;
 }
 
@@ -416,6 +536,7 @@ tuner_rotator(gpointer data)
     tuner.rotator = abs(rotator);
     tuner.rotator_waiting = (rotator < 0);
     ui_update_rotator();
+    ui_update_controls();
     return FALSE;
 }
 
@@ -1,8 +1,13 @@
 #ifndef XDR_TUNER_CALLBACKS_H_
 #define XDR_TUNER_CALLBACKS_H_
 #include <glib.h>
+#include "rds-decoder.h"
 
 gboolean tuner_ready(gpointer);
+gboolean tuner_diversity_ready(gpointer);
+gboolean tuner_diversity_disconnect(gpointer);
+gboolean tuner_diversity_scan(gpointer);
+gboolean tuner_diversity_ignore(gpointer);
 gboolean tuner_unauthorized(gpointer);
 gboolean tuner_disconnect(gpointer);
 gboolean tuner_freq(gpointer);
@@ -28,5 +33,9 @@ gboolean tuner_sampling_interval(gpointer);
 gboolean tuner_online(gpointer);
 gboolean tuner_online_guests(gpointer);
 
+void tuner_rds_decoded(const rds_decoder_t*, const rds_event_t*, gpointer);
+void tuner_rds_station(const rds_decoder_t*, const rds_event_t*, gpointer);
+void tuner_rds_stats(const rds_decoder_t*, const rds_event_t*, gpointer);
+
 #endif
 
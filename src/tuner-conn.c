@@ -29,6 +29,7 @@ tuner_open_serial(const gchar *serial_port,
 #ifdef G_OS_WIN32
     HANDLE serial;
     DCB dcbSerialParams = {0};
+    COMMTIMEOUTS timeouts = {0};
 
     g_snprintf(path, sizeof(path), "\\\\.\\%s", serial_port);
     serial = CreateFile(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
@@ -48,6 +49,15 @@ tuner_open_serial(const gchar *serial_port,
         CloseHandle(serial);
         return CONN_SERIAL_FAIL_PARM_W;
     }
+    /* Complete a read as soon as any data is available */
+    timeouts.ReadIntervalTimeout = MAXDWORD;
+    timeouts.ReadTotalTimeoutMultiplier = MAXDWORD;
+    timeouts.ReadTotalTimeoutConstant = 200;
+    if(!SetCommTimeouts(serial, &timeouts))
+    {
+        CloseHandle(serial);
+        return CONN_SERIAL_FAIL_PARM_W;
+    }
     *fd = (gintptr)serial;
 #else
     struct termios options;
@@ -0,0 +1,460 @@
+#include <glib.h>
+#include <string.h>
+#include "tuner-parse.h"
+#include "tuner-scan.h"
+
+#define PARSE_INT_DIGITS   9
+#define PARSE_FRAC_DIGITS  6
+
+typedef struct tuner_command
+{
+    gboolean (*parse)(tuner_parser_t*, gint, const gchar*);
+    gint event;
+} tuner_command_t;
+
+static gboolean tuner_parse_value(tuner_parser_t*, gint, const gchar*);
+static gboolean tuner_parse_ok(tuner_parser_t*, gint, const gchar*);
+static gboolean tuner_parse_shutdown(tuner_parser_t*, gint, const gchar*);
+static gboolean tuner_parse_notify(tuner_parser_t*, gint, const gchar*);
+static gboolean tuner_parse_signal(tuner_parser_t*, gint, const gchar*);
+static gboolean tuner_parse_pi(tuner_parser_t*, gint, const gchar*);
+static gboolean tuner_parse_rds(tuner_parser_t*, gint, const gchar*);
+static gboolean tuner_parse_scan(tuner_parser_t*, gint, const gchar*);
+static gboolean tuner_parse_online(tuner_parser_t*, gint, const gchar*);
+static gboolean tuner_parse_auth(tuner_parser_t*, gint, const gchar*);
+static void tuner_parse_post(tuner_parser_t*, tuner_event_t*);
+
+/* Indexed by the command byte */
+static const tuner_command_t tuner_commands[256] =
+{
+    ['O'] = { tuner_parse_ok,       TUNER_EVENT_READY             }, /* Tuner startup */
+    ['X'] = { tuner_parse_shutdown, 0                             }, /* Tuner shutdown */
+    ['T'] = { tuner_parse_value,    TUNER_EVENT_FREQ              }, /* Tuned frequency */
+    ['V'] = { tuner_parse_value,    TUNER_EVENT_DAA               }, /* DAA tuning voltage */
+    ['S'] = { tuner_parse_signal,   TUNER_EVENT_SIGNAL            }, /* Signal strength and quality indicators */
+    ['P'] = { tuner_parse_pi,       TUNER_EVENT_PI                }, /* PI code */
+    ['R'] = { tuner_parse_rds,      TUNER_EVENT_RDS               }, /* RDS data */
+    ['U'] = { tuner_parse_scan,     TUNER_EVENT_SCAN              }, /* Spectral scan */
+    ['N'] = { tuner_parse_value,    TUNER_EVENT_PILOT             }, /* Stereo pilot injection level estimation */
+    ['Y'] = { tuner_parse_value,    TUNER_EVENT_VOLUME            }, /* Sound volume control */
+    ['A'] = { tuner_parse_value,    TUNER_EVENT_AGC               }, /* RF AGC threshold */
+    ['D'] = { tuner_parse_value,    TUNER_EVENT_DEEMPHASIS        }, /* De-emphasis */
+    ['Z'] = { tuner_parse_value,    TUNER_EVENT_ANTENNA           }, /* Antenna switch */
+    ['G'] = { tuner_parse_value,    TUNER_EVENT_GAIN              }, /* RF & IF gain setting */
+    ['M'] = { tuner_parse_value,    TUNER_EVENT_MODE              }, /* FM / AM mode */
+    ['F'] = { tuner_parse_value,    TUNER_EVENT_FILTER            }, /* Filter */
+    ['Q'] = { tuner_parse_value,    TUNER_EVENT_SQUELCH           }, /* Squelch */
+    ['C'] = { tuner_parse_value,    TUNER_EVENT_ROTATOR           }, /* Rotator control */
+    ['I'] = { tuner_parse_value,    TUNER_EVENT_SAMPLING_INTERVAL }, /* Custom signal level sampling interval */
+    ['!'] = { tuner_parse_notify,   TUNER_EVENT_EVENT             }, /* External event */
+    ['o'] = { tuner_parse_online,   TUNER_EVENT_ONLINE            }, /* Online users (network) */
+    ['a'] = { tuner_parse_auth,     TUNER_EVENT_READY             }  /* Authorization (network) */
+};
+
+void
+tuner_parser_init(tuner_parser_t *parser,
+                  tuner_queue_t  *queue)
+{
+    parser->queue = queue;
+    parser->tracker = NULL;
+    parser->merge = NULL;
+    parser->lossless = FALSE;
+    parser->lines = 0;
+    parser->invalid = 0;
+    parser->scan_allocs = 0;
+    parser->ready = FALSE;
+    parser->probes = 0;
+}
+
+gboolean
+tuner_parse(tuner_parser_t *parser,
+            const gchar    *line)
+{
+    const tuner_command_t *command = &tuner_commands[(guchar)line[0]];
+
+    parser->lines++;
+    if(!command->parse)
+        return TRUE;
+
+    return command->parse(parser, command->event, line+1);
+}
+
+gboolean
+tuner_parse_int(const gchar **str,
+                gint         *value)
+{
+    const gchar *ptr = *str;
+    gboolean negative = FALSE;
+    gint result = 0;
+    gint digits = 0;
+
+    if(*ptr == '-' || *ptr == '+')
+        negative = (*ptr++ == '-');
+
+    while(*ptr >= '0' && *ptr <= '9')
+    {
+        if(++digits > PARSE_INT_DIGITS)
+            return FALSE;
+        result = result * 10 + (*ptr++ - '0');
+    }
+
+    if(!digits)
+        return FALSE;
+
+    *value = (negative ? -result : result);
+    *str = ptr;
+    return TRUE;
+}
+
+gint
+tuner_parse_hex(const gchar *str,
+                gint         len)
+{
+    gint value = 0;
+    gint digit;
+
+    while(len--)
+    {
+        digit = g_ascii_xdigit_value(*str++);
+        if(digit < 0)
+            return -1;
+        value = (value << 4) | digit;
+    }
+    return value;
+}
+
+gboolean
+tuner_parse_fixed(const gchar **str,
+                  gfloat       *value)
+{
+    static const gint scale[PARSE_FRAC_DIGITS+1] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+    const gchar *ptr = *str;
+    gboolean negative = FALSE;
+    gint integer = 0;
+    gint fraction = 0;
+    gint digits = 0;
+    gint frac_digits = 0;
+
+    if(*ptr == '-' || *ptr == '+')
+        negative = (*ptr++ == '-');
+
+    while(*ptr >= '0' && *ptr <= '9')
+    {
+        if(++digits > PARSE_INT_DIGITS)
+            return FALSE;
+        integer = integer * 10 + (*ptr++ - '0');
+    }
+
+    if(*ptr == '.')
+    {
+        ptr++;
+        while(*ptr >= '0' && *ptr <= '9')
+        {
+            /* Excess precision is ignored */
+            if(frac_digits < PARSE_FRAC_DIGITS)
+            {
+                fraction = fraction * 10 + (*ptr - '0');
+                frac_digits++;
+            }
+            digits++;
+            ptr++;
+        }
+    }
+
+    if(!digits)
+        return FALSE;
+
+    *value = integer + fraction / (gdouble)scale[frac_digits];
+    if(negative)
+        *value = -*value;
+    *str = ptr;
+    return TRUE;
+}
+
+static gboolean
+tuner_parse_value(tuner_parser_t *parser,
+                  gint            type,
+                  const gchar    *msg)
+{
+    tuner_event_t event;
+
+    event.type = type;
+    if(!tuner_parse_int(&msg, &event.data.value) || *msg)
+    {
+        parser->invalid++;
+        return TRUE;
+    }
+
+    tuner_parse_post(parser, &event);
+    return TRUE;
+}
+
+static gboolean
+tuner_parse_ok(tuner_parser_t *parser,
+               gint            type,
+               const gchar    *msg)
+{
+    tuner_event_t event;
+
+    if(msg[0] == 'K')
+    {
+        /* A slow tuner may answer several startup probes,
+         * only the first of these OKs is reported */
+        if(parser->probes > 0)
+        {
+            parser->probes--;
+            if(parser->ready)
+                return TRUE;
+        }
+        parser->ready = TRUE;
+        event.type = type;
+        event.data.value = FALSE;
+        tuner_parse_post(parser, &event);
+    }
+    return TRUE;
+}
+
+static gboolean
+tuner_parse_shutdown(tuner_parser_t *parser,
+                     gint            type,
+                     const gchar    *msg)
+{
+    return FALSE;
+}
+
+static gboolean
+tuner_parse_notify(tuner_parser_t *parser,
+                   gint            type,
+                   const gchar    *msg)
+{
+    tuner_event_t event;
+
+    event.type = type;
+    event.data.value = 0;
+    tuner_parse_post(parser, &event);
+    return TRUE;
+}
+
+static gboolean
+tuner_parse_signal(tuner_parser_t *parser,
+                   gint            type,
+                   const gchar    *msg)
+{
+    tuner_event_t event;
+    gint cci, aci;
+
+    if(!msg[0])
+    {
+        parser->invalid++;
+        return TRUE;
+    }
+
+    event.type = type;
+    switch(msg[0])
+    {
+    case 's':
+        event.data.signal.stereo = SIGNAL_STEREO;
+        break;
+    case 'S':
+        event.data.signal.stereo = SIGNAL_STEREO | SIGNAL_FORCED_MONO;
+        break;
+    case 'M':
+        event.data.signal.stereo = SIGNAL_FORCED_MONO;
+        break;
+    default:
+        event.data.signal.stereo = SIGNAL_MONO;
+        break;
+    }
+
+    msg++;
+    if(!tuner_parse_fixed(&msg, &event.data.signal.value))
+    {
+        parser->invalid++;
+        return TRUE;
+    }
+    tuner_parse_post(parser, &event);
+
+    if(*msg++ == ',' && tuner_parse_int(&msg, &cci))
+    {
+        event.type = TUNER_EVENT_CCI;
+        event.data.value = cci;
+        tuner_parse_post(parser, &event);
+
+        if(*msg++ == ',' && tuner_parse_int(&msg, &aci))
+        {
+            event.type = TUNER_EVENT_ACI;
+            event.data.value = aci;
+            tuner_parse_post(parser, &event);
+        }
+    }
+    return TRUE;
+}
+
+static gboolean
+tuner_parse_pi(tuner_parser_t *parser,
+               gint            type,
+               const gchar    *msg)
+{
+    tuner_event_t event;
+    gint pi = tuner_parse_hex(msg, 4);
+    gint err = 0;
+
+    if(pi < 0)
+    {
+        parser->invalid++;
+        return TRUE;
+    }
+
+    /* Each question mark is an error level */
+    for(msg += 4; *msg; msg++)
+        if(*msg == '?')
+            err++;
+
+    event.type = type;
+    event.data.value = pi | (MIN(err, 3) << 16);
+    tuner_parse_post(parser, &event);
+    return TRUE;
+}
+
+static gboolean
+tuner_parse_rds(tuner_parser_t *parser,
+                gint            type,
+                const gchar    *msg)
+{
+    tuner_event_t event;
+    gint i, value;
+
+    /* Three blocks and error levels: exactly 14 hex digits */
+    for(i=0; i<3; i++)
+    {
+        if((value = tuner_parse_hex(msg+i*4, 4)) < 0)
+        {
+            parser->invalid++;
+            return TRUE;
+        }
+        event.data.rds.data[i] = value;
+    }
+
+    if((value = tuner_parse_hex(msg+12, 2)) < 0 || msg[14])
+    {
+        parser->invalid++;
+        return TRUE;
+    }
+    event.data.rds.errors = value;
+
+    event.type = type;
+    tuner_parse_post(parser, &event);
+    return TRUE;
+}
+
+static gboolean
+tuner_parse_scan(tuner_parser_t *parser,
+                 gint            type,
+                 const gchar    *msg)
+{
+    tuner_event_t event;
+    tuner_scan_t *scan = tuner_scan_parse(msg);
+
+    if(!scan)
+    {
+        parser->invalid++;
+        return TRUE;
+    }
+
+    /* The only payload allocated on the heap, other events are passed by value */
+    parser->scan_allocs++;
+    event.type = type;
+    event.data.ptr = scan;
+    if(!tuner_queue_push(parser->queue, &event, FALSE))
+        tuner_scan_free(scan);
+    return TRUE;
+}
+
+static gboolean
+tuner_parse_online(tuner_parser_t *parser,
+                   gint            type,
+                   const gchar    *msg)
+{
+    tuner_event_t event;
+    gint online, guests;
+
+    if(!tuner_parse_int(&msg, &online))
+    {
+        parser->invalid++;
+        return TRUE;
+    }
+
+    event.type = type;
+    event.data.value = online;
+    tuner_parse_post(parser, &event);
+
+    if(*msg++ == ',' && tuner_parse_int(&msg, &guests))
+    {
+        event.type = TUNER_EVENT_ONLINE_GUESTS;
+        event.data.value = guests;
+        tuner_parse_post(parser, &event);
+    }
+    return TRUE;
+}
+
+static gboolean
+tuner_parse_auth(tuner_parser_t *parser,
+                 gint            type,
+                 const gchar    *msg)
+{
+    tuner_event_t event;
+    gint auth;
+
+    if(!tuner_parse_int(&msg, &auth))
+    {
+        parser->invalid++;
+        return TRUE;
+    }
+
+    if(!auth)
+    {
+        event.type = TUNER_EVENT_UNAUTHORIZED;
+        event.data.value = 0;
+        tuner_parse_post(parser, &event);
+        return FALSE;
+    }
+
+    if(auth == 1)
+    {
+        /* Guest access */
+        event.type = type;
+        event.data.value = TRUE;
+        tuner_parse_post(parser, &event);
+    }
+    return TRUE;
+}
+
+static void
+tuner_parse_post(tuner_parser_t *parser,
+                 tuner_event_t  *event)
+{
+    gboolean reliable;
+
+    if(parser->tracker)
+        tuner_tracker_event(parser->tracker, event);
+    else if(parser->merge)
+        tuner_merge_event(parser->merge, RDS_MERGE_SECONDARY, event);
+
+    /* Samples may be dropped when the queue is full,
+     * state changes have to wait for some room */
+    switch(event->type)
+    {
+    case TUNER_EVENT_SIGNAL:
+    case TUNER_EVENT_CCI:
+    case TUNER_EVENT_ACI:
+    case TUNER_EVENT_PI:
+    case TUNER_EVENT_RDS:
+        reliable = parser->lossless;
+        break;
+    default:
+        reliable = TRUE;
+        break;
+    }
+
+    tuner_queue_push(parser->queue, event, reliable);
+}
@@ -0,0 +1,27 @@
+#ifndef XDR_TUNER_PARSE_H_
+#define XDR_TUNER_PARSE_H_
+#include <glib.h>
+#include "tuner-queue.h"
+#include "tuner-state.h"
+
+typedef struct tuner_parser
+{
+    tuner_queue_t *queue;
+    tuner_tracker_t *tracker;  /* optional, decodes before posting */
+    rds_merge_t *merge;        /* optional, RDS of a secondary tuner */
+    gboolean lossless;         /* samples wait for room too, e.g. a replay */
+    guint lines;
+    guint invalid;
+    guint scan_allocs;
+    gboolean ready;  /* OK banner received */
+    gint probes;     /* startup probes without an answer yet */
+} tuner_parser_t;
+
+void tuner_parser_init(tuner_parser_t*, tuner_queue_t*);
+gboolean tuner_parse(tuner_parser_t*, const gchar*);
+
+gboolean tuner_parse_int(const gchar**, gint*);
+gint tuner_parse_hex(const gchar*, gint);
+gboolean tuner_parse_fixed(const gchar**, gfloat*);
+
+#endif
@@ -0,0 +1,115 @@
+#include <glib.h>
+#include "tuner-queue.h"
+
+#define TUNER_QUEUE_WAIT 1000
+
+/* Single-producer/single-consumer ring:
+ * tail is written only by the producer (tuner thread),
+ * head is written only by the consumer (main loop) */
+struct tuner_queue
+{
+    tuner_event_t events[TUNER_QUEUE_SIZE];
+    volatile gint head;
+    volatile gint tail;
+    volatile gint armed;
+    volatile gint peak;
+    volatile gint dropped;
+    void (*wakeup)(gpointer);
+    gpointer wakeup_data;
+};
+
+tuner_queue_t*
+tuner_queue_new(void     (*wakeup)(gpointer),
+                gpointer   wakeup_data)
+{
+    tuner_queue_t *queue = g_new(tuner_queue_t, 1);
+    queue->head = 0;
+    queue->tail = 0;
+    queue->armed = FALSE;
+    queue->peak = 0;
+    queue->dropped = 0;
+    queue->wakeup = wakeup;
+    queue->wakeup_data = wakeup_data;
+    return queue;
+}
+
+void
+tuner_queue_free(tuner_queue_t *queue)
+{
+    g_free(queue);
+}
+
+gboolean
+tuner_queue_push(tuner_queue_t       *queue,
+                 const tuner_event_t *event,
+                 gboolean             wait)
+{
+    gint tail = queue->tail;
+    gint next = (tail + 1) % TUNER_QUEUE_SIZE;
+    gint depth;
+
+    while(next == g_atomic_int_get(&queue->head))
+    {
+        if(!wait)
+        {
+            g_atomic_int_inc(&queue->dropped);
+            return FALSE;
+        }
+        /* The consumer is armed already, it will make some room */
+        g_usleep(TUNER_QUEUE_WAIT);
+    }
+
+    queue->events[tail] = *event;
+    g_atomic_int_set(&queue->tail, next);
+
+    depth = (next - g_atomic_int_get(&queue->head) + TUNER_QUEUE_SIZE) % TUNER_QUEUE_SIZE;
+    if(depth > queue->peak)
+        g_atomic_int_set(&queue->peak, depth);
+
+    /* Wake up the consumer only once per batch */
+    if(g_atomic_int_compare_and_exchange(&queue->armed, FALSE, TRUE) &&
+       queue->wakeup)
+        queue->wakeup(queue->wakeup_data);
+
+    return TRUE;
+}
+
+gboolean
+tuner_queue_pop(tuner_queue_t *queue,
+                tuner_event_t *event)
+{
+    gint head = queue->head;
+
+    if(head == g_atomic_int_get(&queue->tail))
+        return FALSE;
+
+    *event = queue->events[head];
+    g_atomic_int_set(&queue->head, (head + 1) % TUNER_QUEUE_SIZE);
+    return TRUE;
+}
+
+void
+tuner_queue_disarm(tuner_queue_t *queue)
+{
+    /* Must be called before draining the queue,
+     * so that no event is left without a wakeup */
+    g_atomic_int_set(&queue->armed, FALSE);
+}
+
+gint
+tuner_queue_depth(tuner_queue_t *queue)
+{
+    return (g_atomic_int_get(&queue->tail) - g_atomic_int_get(&queue->head) + TUNER_QUEUE_SIZE) % TUNER_QUEUE_SIZE;
+}
+
+gint
+tuner_queue_peak(tuner_queue_t *queue)
+{
+    return g_atomic_int_get(&queue->peak);
+}
+
+guint
+tuner_queue_dropped(tuner_queue_t *queue)
+{
+    return (guint)g_atomic_int_get(&queue->dropped);
+}
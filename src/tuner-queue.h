@@ -0,0 +1,79 @@
+#ifndef XDR_TUNER_QUEUE_H_
+#define XDR_TUNER_QUEUE_H_
+#include <glib.h>
+
+#define TUNER_QUEUE_SIZE 1024
+
+#define SIGNAL_MONO             0
+#define SIGNAL_STEREO           1
+#define SIGNAL_FORCED_MONO  (1<<1)
+
+enum tuner_event_type
+{
+    TUNER_EVENT_READY,
+    TUNER_EVENT_UNAUTHORIZED,
+    TUNER_EVENT_DISCONNECT,
+    TUNER_EVENT_FREQ,
+    TUNER_EVENT_DAA,
+    TUNER_EVENT_SIGNAL,
+    TUNER_EVENT_CCI,
+    TUNER_EVENT_ACI,
+    TUNER_EVENT_PI,
+    TUNER_EVENT_RDS,
+    TUNER_EVENT_SCAN,
+    TUNER_EVENT_PILOT,
+    TUNER_EVENT_VOLUME,
+    TUNER_EVENT_AGC,
+    TUNER_EVENT_DEEMPHASIS,
+    TUNER_EVENT_ANTENNA,
+    TUNER_EVENT_EVENT,
+    TUNER_EVENT_GAIN,
+    TUNER_EVENT_MODE,
+    TUNER_EVENT_FILTER,
+    TUNER_EVENT_SQUELCH,
+    TUNER_EVENT_ROTATOR,
+    TUNER_EVENT_SAMPLING_INTERVAL,
+    TUNER_EVENT_ONLINE,
+    TUNER_EVENT_ONLINE_GUESTS,
+    TUNER_EVENT_COUNT
+};
+
+typedef struct tuner_signal
+{
+    gfloat value;
+    gboolean stereo;
+} tuner_signal_t;
+
+/* RDS group without the PI block */
+typedef struct tuner_rds
+{
+    guint16 data[3];
+    guint8 errors;
+} tuner_rds_t;
+
+typedef struct tuner_event
+{
+    gint type;
+    union
+    {
+        gint value;
+        gpointer ptr;
+        tuner_signal_t signal;
+        tuner_rds_t rds;
+    } data;
+} tuner_event_t;
+
+typedef struct tuner_queue tuner_queue_t;
+
+tuner_queue_t* tuner_queue_new(void (*)(gpointer), gpointer);
+void tuner_queue_free(tuner_queue_t*);
+
+gboolean tuner_queue_push(tuner_queue_t*, const tuner_event_t*, gboolean);
+gboolean tuner_queue_pop(tuner_queue_t*, tuner_event_t*);
+void tuner_queue_disarm(tuner_queue_t*);
+
+gint tuner_queue_depth(tuner_queue_t*);
+gint tuner_queue_peak(tuner_queue_t*);
+guint tuner_queue_dropped(tuner_queue_t*);
+
+#endif
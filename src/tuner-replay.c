@@ -0,0 +1,164 @@
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include "tuner-replay.h"
+#include "tuner-parse.h"
+
+/* Session file: one tuner line per record, prefixed with
+ * the time elapsed since the previous record in milliseconds:
+ * "<delta> <line>\n", lines beginning with '#' are comments */
+#define REPLAY_HEADER "# xdr-gtk tuner session\n"
+#define REPLAY_BUFFER 10000
+
+struct tuner_replay
+{
+    FILE *file;
+    gchar line[REPLAY_BUFFER];
+};
+
+static GMutex record_lock;
+static FILE *record_file = NULL;
+static gint64 record_last = 0;
+static gdouble replay_speed = TUNER_REPLAY_REALTIME;
+
+gboolean
+tuner_record_start(const gchar *path)
+{
+    FILE *file = g_fopen(path, "w");
+
+    if(!file)
+        return FALSE;
+
+    fputs(REPLAY_HEADER, file);
+    g_mutex_lock(&record_lock);
+    if(record_file)
+        fclose(record_file);
+    record_file = file;
+    record_last = 0;
+    g_mutex_unlock(&record_lock);
+    return TRUE;
+}
+
+void
+tuner_record_line(const gchar *line)
+{
+    gint64 now, delta;
+
+    /* Unlocked check, the recorder is started before any connection */
+    if(!record_file)
+        return;
+
+    g_mutex_lock(&record_lock);
+    if(record_file)
+    {
+        now = g_get_monotonic_time();
+        if(!record_last)
+            record_last = now;
+        /* The clock advances by whole written milliseconds only,
+         * so the truncated remainder is carried to the next record */
+        delta = MAX(now - record_last, 0) / 1000;
+        record_last += delta * 1000;
+        fprintf(record_file, "%" G_GINT64_FORMAT " %s\n", delta, line);
+    }
+    g_mutex_unlock(&record_lock);
+}
+
+void
+tuner_record_flush()
+{
+    g_mutex_lock(&record_lock);
+    if(record_file)
+        fflush(record_file);
+    g_mutex_unlock(&record_lock);
+}
+
+void
+tuner_record_stop()
+{
+    g_mutex_lock(&record_lock);
+    if(record_file)
+    {
+        fclose(record_file);
+        record_file = NULL;
+    }
+    g_mutex_unlock(&record_lock);
+}
+
+gboolean
+tuner_replay_open(const gchar *path,
+                  gintptr     *fd)
+{
+    gint ret = g_open(path, O_RDONLY, 0);
+
+    if(ret < 0)
+        return FALSE;
+
+    *fd = ret;
+    return TRUE;
+}
+
+void
+tuner_replay_set_speed(gdouble speed)
+{
+    replay_speed = MAX(speed, TUNER_REPLAY_NO_DELAY);
+}
+
+gdouble
+tuner_replay_get_speed()
+{
+    return replay_speed;
+}
+
+tuner_replay_t*
+tuner_replay_new(gintptr fd)
+{
+    tuner_replay_t *replay;
+    FILE *file = fdopen(fd, "r");
+
+    if(!file)
+        return NULL;
+
+    replay = g_new(tuner_replay_t, 1);
+    replay->file = file;
+    return replay;
+}
+
+gboolean
+tuner_replay_next(tuner_replay_t  *replay,
+                  gint64          *delay,
+                  const gchar    **line)
+{
+    const gchar *ptr;
+    gint delta;
+    gsize len;
+
+    while(fgets(replay->line, sizeof(replay->line), replay->file))
+    {
+        len = strlen(replay->line);
+        while(len && (replay->line[len-1] == '\n' || replay->line[len-1] == '\r'))
+            replay->line[--len] = 0;
+
+        if(!len || replay->line[0] == '#')
+            continue;
+
+        /* Malformed records are skipped */
+        ptr = replay->line;
+        if(!tuner_parse_int(&ptr, &delta) || delta < 0 || *ptr != ' ' || !ptr[1])
+            continue;
+
+        *delay = (gint64)delta * 1000;
+        *line = ptr + 1;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+void
+tuner_replay_free(tuner_replay_t *replay)
+{
+    /* This also closes the file descriptor */
+    fclose(replay->file);
+    g_free(replay);
+}
@@ -0,0 +1,24 @@
+#ifndef XDR_TUNER_REPLAY_H_
+#define XDR_TUNER_REPLAY_H_
+#include <glib.h>
+
+/* Replay speed factor, 0 means as fast as possible */
+#define TUNER_REPLAY_REALTIME 1.0
+#define TUNER_REPLAY_NO_DELAY 0.0
+
+typedef struct tuner_replay tuner_replay_t;
+
+gboolean tuner_record_start(const gchar*);
+void tuner_record_line(const gchar*);
+void tuner_record_flush();
+void tuner_record_stop();
+
+gboolean tuner_replay_open(const gchar*, gintptr*);
+void tuner_replay_set_speed(gdouble);
+gdouble tuner_replay_get_speed();
+
+tuner_replay_t* tuner_replay_new(gintptr);
+gboolean tuner_replay_next(tuner_replay_t*, gint64*, const gchar**);
+void tuner_replay_free(tuner_replay_t*);
+
+#endif
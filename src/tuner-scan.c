@@ -1,26 +1,24 @@
-#include <gtk/gtk.h>
+#include <glib.h>
 #include <string.h>
-#include <stdlib.h>
 #include <math.h>
 #include "tuner-scan.h"
-#ifdef G_OS_WIN32
-#include "win32.h"
-#endif
+#include "tuner-parse.h"
 
 tuner_scan_t*
-tuner_scan_parse(gchar *msg)
+tuner_scan_parse(const gchar *msg)
 {
     tuner_scan_t *scan;
-    gchar *ptr, *freq, *value;
+    const gchar *ptr;
+    gint freq;
+    gfloat value;
     gint n = 0;
     gint i;
 
     if(!msg)
         return NULL;
 
-    for(i=0; i<strlen(msg); i++)
-        if(msg[i] == ',')
-            n++;
+    for(ptr = msg; (ptr = strchr(ptr, ',')); ptr++)
+        n++;
 
     if(!n)
         return NULL;
@@ -31,20 +29,27 @@ tuner_scan_parse(gchar *msg)
     scan->signals = g_new(tuner_scan_node_t, n);
 
     i = 0;
-    while((ptr = strsep(&msg, ",")) && i < n)
+    ptr = msg;
+    while(*ptr && i < n)
     {
-        freq = strsep(&ptr, "=");
-        value = strsep(&ptr, "=");
-        if(freq && value)
+        /* freq=value, */
+        if(tuner_parse_int(&ptr, &freq) &&
+           *ptr == '=' &&
+           (++ptr, tuner_parse_fixed(&ptr, &value)))
         {
-            scan->signals[i].freq = atoi(freq);
-            scan->signals[i].signal = g_ascii_strtod(value, NULL);
+            scan->signals[i].freq = freq;
+            scan->signals[i].signal = value;
             if(scan->signals[i].signal > scan->max)
                 scan->max = ceil(scan->signals[i].signal);
             if(scan->signals[i].signal < scan->min)
                 scan->min = floor(scan->signals[i].signal);
             i++;
         }
+
+        while(*ptr && *ptr != ',')
+            ptr++;
+        if(*ptr)
+            ptr++;
     }
 
     if(!i)
@@ -1,5 +1,6 @@
 #ifndef XDR_TUNER_SCAN_H_
 #define XDR_TUNER_SCAN_H_
+#include <glib.h>
 
 typedef struct tuner_scan_node
 {
@@ -15,7 +16,7 @@ typedef struct tuner_scan
     gint max;
 } tuner_scan_t;
 
-tuner_scan_t* tuner_scan_parse(gchar*);
+tuner_scan_t* tuner_scan_parse(const gchar*);
 tuner_scan_t* tuner_scan_copy(tuner_scan_t*);
 void tuner_scan_free(tuner_scan_t*);
 
@@ -0,0 +1,223 @@
+#include <glib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "tuner-state.h"
+
+static void tuner_tracker_tune(tuner_tracker_t*, gint);
+
+void
+tuner_snapshot_publish(tuner_snapshot_t    *snapshot,
+                       const tuner_state_t *state)
+{
+    /* Writers are serialized, only an ending connection may overlap a new one */
+    g_mutex_lock(&snapshot->write_lock);
+    g_atomic_int_inc(&snapshot->sequence);
+    /* The odd sequence is visible before any byte of the copy */
+    atomic_thread_fence(memory_order_release);
+    memcpy(&snapshot->state, state, sizeof(tuner_state_t));
+    g_atomic_int_inc(&snapshot->sequence);
+    g_mutex_unlock(&snapshot->write_lock);
+}
+
+gint
+tuner_snapshot_read(tuner_snapshot_t *snapshot,
+                    tuner_state_t    *state)
+{
+    /* Lock-free, returns the sequence of the copied version */
+    gint before, after;
+
+    for(;;)
+    {
+        before = g_atomic_int_get(&snapshot->sequence);
+        if(before & 1)
+        {
+            g_thread_yield();
+            continue;
+        }
+        memcpy(state, (const void*)&snapshot->state, sizeof(tuner_state_t));
+        /* The copy is complete before the sequence is checked again */
+        atomic_thread_fence(memory_order_acquire);
+        after = g_atomic_int_get(&snapshot->sequence);
+        if(before == after)
+            return before;
+    }
+}
+
+gint
+tuner_snapshot_sequence(tuner_snapshot_t *snapshot)
+{
+    return g_atomic_int_get(&snapshot->sequence);
+}
+
+tuner_tracker_t*
+tuner_tracker_new(tuner_snapshot_t *snapshot)
+{
+    tuner_tracker_t *tracker = g_new(tuner_tracker_t, 1);
+
+    tracker->snapshot = snapshot;
+    tracker->state.generation = 0;
+    tracker->state.freq = 0;
+    tracker->state.filter = -1;
+    tracker->state.antenna = 0;
+    memset(tracker->state.offset, 0, sizeof(tracker->state.offset));
+    rds_decoder_init(&tracker->state.rds);
+    rds_cache_clear(&tracker->cache);
+    tracker->merge = NULL;
+    tracker->generation = 0;
+    tracker->config_changed = FALSE;
+    g_mutex_init(&tracker->config_lock);
+    memset(&tracker->config, 0, sizeof(rds_decoder_config_t));
+    memset(tracker->offset, 0, sizeof(tracker->offset));
+
+    tuner_snapshot_publish(snapshot, &tracker->state);
+    return tracker;
+}
+
+void
+tuner_tracker_free(tuner_tracker_t *tracker)
+{
+    g_mutex_clear(&tracker->config_lock);
+    g_free(tracker);
+}
+
+void
+tuner_tracker_event(tuner_tracker_t     *tracker,
+                    const tuner_event_t *event)
+{
+    /* Runs in the reader thread, publishes the state after every change */
+    tuner_state_t *state = &tracker->state;
+    gint generation = g_atomic_int_get(&tracker->generation);
+    gboolean changed = FALSE;
+    rds_merge_group_t group;
+
+    if(g_atomic_int_get(&tracker->config_changed))
+    {
+        g_mutex_lock(&tracker->config_lock);
+        state->rds.config = tracker->config;
+        memcpy(state->offset, tracker->offset, sizeof(state->offset));
+        tracker->config_changed = FALSE;
+        g_mutex_unlock(&tracker->config_lock);
+        changed = TRUE;
+    }
+
+    if(state->generation != generation)
+    {
+        state->generation = generation;
+        rds_decoder_reset(&state->rds);
+        changed = TRUE;
+    }
+
+    switch(event->type)
+    {
+    case TUNER_EVENT_FREQ:
+        tuner_tracker_tune(tracker, event->data.value);
+        changed = TRUE;
+        break;
+    case TUNER_EVENT_FILTER:
+        state->filter = event->data.value;
+        changed = TRUE;
+        break;
+    case TUNER_EVENT_ANTENNA:
+        state->antenna = event->data.value;
+        changed = TRUE;
+        break;
+    case TUNER_EVENT_PI:
+        /* Also with a merge: a weak signal may bring PI codes without groups.
+         * A merged group repeats it, which the decoder takes as no change. */
+        rds_decoder_pi(&state->rds, event->data.value & 0xFFFF, (event->data.value & 0x30000) >> 16);
+        changed = TRUE;
+        break;
+    case TUNER_EVENT_RDS:
+        if(tracker->merge)
+            break;
+        rds_decoder_group(&state->rds, event->data.rds.data, event->data.rds.errors);
+        changed = TRUE;
+        break;
+    }
+
+    if(tracker->merge)
+    {
+        /* Groups of both tuners go through the merge, drained on every event */
+        tuner_merge_event(tracker->merge, RDS_MERGE_PRIMARY, event);
+        while(rds_merge_pop(tracker->merge, g_get_monotonic_time(), &group))
+        {
+            if(group.pi >= 0)
+                rds_decoder_pi(&state->rds, group.pi, group.pi_err_level);
+            rds_decoder_group(&state->rds, group.data, group.errors);
+            changed = TRUE;
+        }
+    }
+
+    if(changed)
+        tuner_snapshot_publish(tracker->snapshot, state);
+}
+
+gint
+tuner_tracker_reset(tuner_tracker_t *tracker)
+{
+    /* Any thread: the decoder is reset before the next event,
+     * states of older generations are to be ignored by readers */
+    return g_atomic_int_add(&tracker->generation, 1) + 1;
+}
+
+void
+tuner_tracker_config(tuner_tracker_t            *tracker,
+                     const rds_decoder_config_t *config)
+{
+    g_mutex_lock(&tracker->config_lock);
+    tracker->config = *config;
+    g_atomic_int_set(&tracker->config_changed, TRUE);
+    g_mutex_unlock(&tracker->config_lock);
+}
+
+void
+tuner_tracker_offsets(tuner_tracker_t *tracker,
+                      const gint      *offset)
+{
+    /* Published with the state, the frequency of the antenna is read in one copy */
+    g_mutex_lock(&tracker->config_lock);
+    memcpy(tracker->offset, offset, sizeof(tracker->offset));
+    g_atomic_int_set(&tracker->config_changed, TRUE);
+    g_mutex_unlock(&tracker->config_lock);
+}
+
+void
+tuner_merge_event(rds_merge_t         *merge,
+                  gint                 source,
+                  const tuner_event_t *event)
+{
+    /* Any reader thread: the tuning and RDS of one tuner */
+    switch(event->type)
+    {
+    case TUNER_EVENT_FREQ:
+        rds_merge_freq(merge, source, event->data.value);
+        break;
+    case TUNER_EVENT_DISCONNECT:
+        rds_merge_freq(merge, source, 0);
+        break;
+    case TUNER_EVENT_PI:
+        rds_merge_pi(merge, source, event->data.value & 0xFFFF, (event->data.value & 0x30000) >> 16);
+        break;
+    case TUNER_EVENT_RDS:
+        rds_merge_group(merge, source, g_get_monotonic_time(), event->data.rds.data, event->data.rds.errors);
+        break;
+    }
+}
+
+static void
+tuner_tracker_tune(tuner_tracker_t *tracker,
+                   gint             freq)
+{
+    /* Confirmed RDS state is kept per frequency, a cached one is restored */
+    rds_decoder_t *decoder = &tracker->state.rds;
+    const rds_decoder_t *saved;
+
+    if(decoder->pi >= 0 && !decoder->provisional)
+        rds_cache_store(&tracker->cache, tracker->state.freq, decoder);
+
+    rds_decoder_reset(decoder);
+    tracker->state.freq = freq;
+
+    if((saved = rds_cache_lookup(&tracker->cache, freq)))
+        rds_decoder_restore(decoder, saved);
+}
@@ -0,0 +1,58 @@
+#ifndef XDR_TUNER_STATE_H_
+#define XDR_TUNER_STATE_H_
+#include <glib.h>
+#include "tuner-queue.h"
+#include "rds-decoder.h"
+#include "rds-cache.h"
+#include "rds-merge.h"
+
+#define TUNER_STATE_ANTENNAS 4
+
+/* Tuner and RDS state as decoded by the reader thread */
+typedef struct tuner_state
+{
+    gint generation;  /* RDS resets requested so far */
+    gint freq;        /* as reported by the tuner */
+    gint filter;
+    gint antenna;
+    gint offset[TUNER_STATE_ANTENNAS];  /* frequency offset of each antenna */
+    rds_decoder_t rds;
+} tuner_state_t;
+
+/* Seqlock: an odd sequence marks a write in progress,
+ * readers retry until they get a copy of one version */
+typedef struct tuner_snapshot
+{
+    volatile gint sequence;
+    GMutex write_lock;
+    tuner_state_t state;
+} tuner_snapshot_t;
+
+/* Reader side of the state, fed with every parsed event */
+typedef struct tuner_tracker
+{
+    tuner_snapshot_t *snapshot;
+    tuner_state_t state;
+    rds_cache_t cache;
+    rds_merge_t *merge;  /* optional, RDS of a second tuner is merged in */
+    volatile gint generation;
+    volatile gint config_changed;
+    GMutex config_lock;
+    rds_decoder_config_t config;
+    gint offset[TUNER_STATE_ANTENNAS];
+} tuner_tracker_t;
+
+void tuner_snapshot_publish(tuner_snapshot_t*, const tuner_state_t*);
+gint tuner_snapshot_read(tuner_snapshot_t*, tuner_state_t*);
+gint tuner_snapshot_sequence(tuner_snapshot_t*);
+
+tuner_tracker_t* tuner_tracker_new(tuner_snapshot_t*);
+void tuner_tracker_free(tuner_tracker_t*);
+void tuner_tracker_event(tuner_tracker_t*, const tuner_event_t*);
+gint tuner_tracker_reset(tuner_tracker_t*);
+void tuner_tracker_config(tuner_tracker_t*, const rds_decoder_config_t*);
+void tuner_tracker_offsets(tuner_tracker_t*, const gint*);
+
+void tuner_merge_event(rds_merge_t*, gint, const tuner_event_t*);
+
+#endif
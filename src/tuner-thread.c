@@ -0,0 +1,858 @@
+#include <glib.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef G_OS_WIN32
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0501
+#endif
+#include <winsock2.h>
+#include <windows.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <poll.h>
+#include <errno.h>
+#endif
+
+#include "tuner-thread.h"
+#include "tuner-queue.h"
+#include "tuner-parse.h"
+#include "tuner-replay.h"
+
+#define DEBUG_READ  0
+#define DEBUG_WRITE 1
+
+#define SERIAL_BUFFER 10000
+#define READ_BUFFER    4096
+#define WRITE_LIMIT   65536
+
+/* Serial startup handshake (microseconds) */
+#define STARTUP_PROBE_INTERVAL   250000
+#define STARTUP_TIMEOUT         5000000
+
+/* Time left to the writer to flush the last commands (microseconds) */
+#define WRITER_STOP_TIMEOUT     2000000
+
+typedef struct tuner_thread
+{
+    gintptr fd;
+    gint type;  /* TUNER_THREAD_SERIAL, TUNER_THREAD_SOCKET or TUNER_THREAD_REPLAY */
+    volatile gboolean canceled;
+#ifdef G_OS_WIN32
+    HANDLE cancel_event;
+#else
+    gint cancel_pipe[2];
+#endif
+    volatile gint ref_count;
+    const tuner_handler_t *handlers;
+    tuner_queue_t *queue;
+    guint queue_dropped;
+    tuner_parser_t parser;
+    tuner_tracker_t *tracker;
+
+    /* Outbound commands, gathered by tuner_write()
+     * and flushed by the writer thread */
+    GThread *writer;
+    GMutex write_lock;
+    GCond write_cond;
+    GString *write_pending;
+    gboolean write_stop;
+    gboolean write_done;
+    guint write_commands;
+    guint write_flushes;
+} tuner_thread_t;
+
+typedef struct tuner_reader
+{
+    gchar line[SERIAL_BUFFER];
+    gint pos;
+} tuner_reader_t;
+
+typedef struct tuner_startup
+{
+    gboolean probing;
+    gint64 start;
+    gint64 next_probe;
+    gint64 settled;  /* answers to the last probes are in by then */
+} tuner_startup_t;
+
+static gpointer tuner_thread(gpointer);
+static void tuner_thread_unref(gpointer);
+static void tuner_thread_wakeup(gpointer);
+static gboolean tuner_thread_dispatch(gpointer);
+static gint tuner_startup(tuner_thread_t*, tuner_startup_t*, tuner_reader_t*);
+static gboolean tuner_read(tuner_thread_t*, tuner_reader_t*, gchar*, gint);
+static void tuner_replay(tuner_thread_t*);
+static gboolean tuner_thread_sleep(tuner_thread_t*, gint64);
+static gpointer tuner_writer(gpointer);
+static void tuner_writer_stop(tuner_thread_t*);
+static void tuner_writer_abort(tuner_thread_t*);
+static void tuner_restart(gintptr);
+static gboolean tuner_write_serial(gintptr, gchar*, int);
+
+gpointer
+tuner_thread_new(gint                   type,
+                 gintptr                fd,
+                 const tuner_handler_t *handlers,
+                 tuner_tracker_t       *tracker,
+                 rds_merge_t           *merge)
+{
+    tuner_thread_t *thread = g_malloc(sizeof(tuner_thread_t));
+    g_assert(type == TUNER_THREAD_SERIAL ||
+             type == TUNER_THREAD_SOCKET ||
+             type == TUNER_THREAD_REPLAY);
+
+    thread->fd = fd;
+    thread->type = type;
+    thread->canceled = FALSE;
+#ifdef G_OS_WIN32
+    thread->cancel_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+#else
+    if(pipe(thread->cancel_pipe) < 0)
+        thread->cancel_pipe[0] = thread->cancel_pipe[1] = -1;
+#endif
+    thread->ref_count = 1; /* released by the tuner thread itself */
+    thread->handlers = handlers;
+    thread->queue = tuner_queue_new(tuner_thread_wakeup, thread);
+    thread->queue_dropped = 0;
+    tuner_parser_init(&thread->parser, thread->queue);
+    /* A replay has no live source to keep up with, it waits for the main loop */
+    thread->parser.lossless = (type == TUNER_THREAD_REPLAY);
+
+    /* RDS is decoded by the reader, before the events reach the main loop.
+     * The tracker comes configured and is owned by the thread from now on */
+    thread->tracker = tracker;
+    thread->parser.tracker = thread->tracker;
+
+    /* With a merge, a thread without its own state is the secondary tuner */
+    if(thread->tracker)
+        thread->tracker->merge = merge;
+    else
+        thread->parser.merge = merge;
+
+    g_mutex_init(&thread->write_lock);
+    g_cond_init(&thread->write_cond);
+    thread->write_pending = g_string_sized_new(256);
+    thread->write_stop = FALSE;
+    thread->write_done = FALSE;
+    thread->write_commands = 0;
+    thread->write_flushes = 0;
+
+    /* The writer is joined by the tuner thread before the fd is closed */
+    thread->writer = g_thread_new("tuner-writer", tuner_writer, (gpointer)thread);
+    g_thread_unref(g_thread_new("tuner", tuner_thread, (gpointer)thread));
+    return thread;
+}
+
+void
+tuner_thread_cancel(gpointer ptr)
+{
+    tuner_thread_t *thread = (tuner_thread_t*)ptr;
+#ifndef G_OS_WIN32
+    gchar c = 0;
+#endif
+
+    thread->canceled = TRUE;
+    /* Wake up the reader blocked on the device */
+#ifdef G_OS_WIN32
+    SetEvent(thread->cancel_event);
+#else
+    if(write(thread->cancel_pipe[1], &c, 1) < 0)
+        g_print("thread cancel: %p (wakeup failed)\n", ptr);
+#endif
+}
+
+gint
+tuner_thread_rds_reset(gpointer ptr)
+{
+    /* Returns the generation of states published after the reset */
+    tuner_thread_t *thread = (tuner_thread_t*)ptr;
+
+    if(!thread || !thread->tracker)
+        return 0;
+    return tuner_tracker_reset(thread->tracker);
+}
+
+void
+tuner_thread_rds_config(gpointer                    ptr,
+                        const rds_decoder_config_t *config)
+{
+    tuner_thread_t *thread = (tuner_thread_t*)ptr;
+
+    if(thread && thread->tracker)
+        tuner_tracker_config(thread->tracker, config);
+}
+
+void
+tuner_thread_offsets(gpointer    ptr,
+                     const gint *offset)
+{
+    tuner_thread_t *thread = (tuner_thread_t*)ptr;
+
+    if(thread && thread->tracker)
+        tuner_tracker_offsets(thread->tracker, offset);
+}
+
+static void
+tuner_thread_unref(gpointer data)
+{
+    tuner_thread_t *thread = (tuner_thread_t*)data;
+
+    if(!g_atomic_int_dec_and_test(&thread->ref_count))
+        return;
+
+    g_print("thread free: %p (lines: %u, invalid: %u, queue peak: %d, dropped: %u, scan allocations: %u)\n",
+            data,
+            thread->parser.lines,
+            thread->parser.invalid,
+            tuner_queue_peak(thread->queue),
+            tuner_queue_dropped(thread->queue),
+            thread->parser.scan_allocs);
+    g_print("thread writes: %p (commands: %u, flushes: %u)\n",
+            data,
+            thread->write_commands,
+            thread->write_flushes);
+    tuner_queue_free(thread->queue);
+    if(thread->tracker)
+        tuner_tracker_free(thread->tracker);
+    g_string_free(thread->write_pending, TRUE);
+    g_cond_clear(&thread->write_cond);
+    g_mutex_clear(&thread->write_lock);
+#ifdef G_OS_WIN32
+    CloseHandle(thread->cancel_event);
+#else
+    close(thread->cancel_pipe[0]);
+    close(thread->cancel_pipe[1]);
+#endif
+    g_free(thread);
+}
+
+static void
+tuner_thread_wakeup(gpointer data)
+{
+    tuner_thread_t *thread = (tuner_thread_t*)data;
+
+    /* Every pending dispatch holds a reference to the thread */
+    g_atomic_int_inc(&thread->ref_count);
+    g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, tuner_thread_dispatch, thread, tuner_thread_unref);
+}
+
+static gboolean
+tuner_thread_dispatch(gpointer data)
+{
+    tuner_thread_t *thread = (tuner_thread_t*)data;
+    tuner_event_t event;
+
+    tuner_queue_disarm(thread->queue);
+    while(tuner_queue_pop(thread->queue, &event))
+    {
+        switch(thread->handlers[event.type].payload)
+        {
+        case PAYLOAD_RECORD:
+            /* Records are valid only for the duration of the call */
+            thread->handlers[event.type].func(&event.data);
+            break;
+        case PAYLOAD_HEAP:
+            thread->handlers[event.type].func(event.data.ptr);
+            break;
+        default:
+            thread->handlers[event.type].func(GINT_TO_POINTER(event.data.value));
+            break;
+        }
+    }
+
+    /* Report backpressure when the main loop cannot keep up */
+    if(thread->queue_dropped != tuner_queue_dropped(thread->queue))
+    {
+        thread->queue_dropped = tuner_queue_dropped(thread->queue);
+        g_print("thread queue: %p (depth: %d, peak: %d, dropped: %u)\n",
+                data,
+                tuner_queue_depth(thread->queue),
+                tuner_queue_peak(thread->queue),
+                thread->queue_dropped);
+    }
+    return FALSE;
+}
+
+static gpointer
+tuner_thread(gpointer data)
+{
+    tuner_thread_t *thread = (tuner_thread_t*)data;
+    tuner_reader_t reader;
+    tuner_startup_t startup;
+    gchar block[READ_BUFFER];
+    tuner_event_t event;
+    gint timeout;
+    gint len;
+
+#ifdef G_OS_WIN32
+    HANDLE handles[2];
+    DWORD len_in = 0;
+    BOOL fWaitingOnRead = FALSE;
+    DWORD state;
+    OVERLAPPED osReader = {0};
+    WSAEVENT socket_event = WSA_INVALID_EVENT;
+#else
+    struct pollfd fds[2];
+    gint n;
+#endif
+
+    g_print("thread start: %p\n", data);
+
+    if(thread->type == TUNER_THREAD_REPLAY)
+    {
+        tuner_replay(thread);
+        goto tuner_thread_cleanup;
+    }
+
+#ifdef G_OS_WIN32
+    if(thread->type == TUNER_THREAD_SERIAL)
+    {
+        osReader.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+        if(osReader.hEvent == NULL)
+            goto tuner_thread_cleanup;
+        handles[0] = osReader.hEvent;
+    }
+    else
+    {
+        /* This also switches the socket into non-blocking mode */
+        socket_event = WSACreateEvent();
+        if(socket_event == WSA_INVALID_EVENT ||
+           WSAEventSelect(thread->fd, socket_event, FD_READ | FD_CLOSE) == SOCKET_ERROR)
+            goto tuner_thread_cleanup;
+        handles[0] = socket_event;
+    }
+    handles[1] = thread->cancel_event;
+#else
+    fds[0].fd = thread->fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = thread->cancel_pipe[0];
+    fds[1].events = POLLIN;
+#endif
+
+    if(thread->canceled)
+        goto tuner_thread_cleanup;
+
+    reader.pos = 0;
+    startup.start = g_get_monotonic_time();
+    startup.next_probe = startup.start;
+    startup.settled = 0;
+    startup.probing = (thread->type == TUNER_THREAD_SERIAL);
+
+    if(startup.probing)
+    {
+        /* Drop anything left over from before the port was opened */
+#ifdef G_OS_WIN32
+        PurgeComm((HANDLE)thread->fd, PURGE_RXCLEAR | PURGE_TXCLEAR);
+#else
+        tcflush(thread->fd, TCIOFLUSH);
+#endif
+    }
+    else
+        tuner_write(thread, "x");
+
+    /* Block until there is some data or the thread is canceled */
+    while(!thread->canceled)
+    {
+        timeout = tuner_startup(thread, &startup, &reader);
+#ifdef G_OS_WIN32
+        if(thread->type == TUNER_THREAD_SOCKET)
+        {
+            state = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+            if(state != WAIT_OBJECT_0)
+                break;
+            WSAResetEvent(socket_event);
+            len = recv(thread->fd, block, sizeof(block), 0);
+            if(len == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK)
+                continue;
+            if(len <= 0)
+                break;
+        }
+        else
+        {
+            if (!fWaitingOnRead)
+            {
+                if (!ReadFile((HANDLE)thread->fd, block, sizeof(block), &len_in, &osReader))
+                {
+                    if (GetLastError() != ERROR_IO_PENDING)
+                        break;
+                    else
+                        fWaitingOnRead = TRUE;
+                }
+            }
+
+            if (fWaitingOnRead)
+            {
+                state = WaitForMultipleObjects(2, handles, FALSE, (timeout < 0 ? INFINITE : (DWORD)timeout));
+                if(state == WAIT_TIMEOUT)
+                    continue;
+                if(state != WAIT_OBJECT_0)
+                {
+                    /* The buffer must not be released with a read in progress */
+                    CancelIo((HANDLE)thread->fd);
+                    GetOverlappedResult((HANDLE)thread->fd, &osReader, &len_in, TRUE);
+                    break;
+                }
+
+                if (!GetOverlappedResult((HANDLE)thread->fd, &osReader, &len_in, FALSE))
+                    break;
+
+                fWaitingOnRead = FALSE;
+            }
+            if(!len_in)
+            {
+                continue;
+            }
+            len = len_in;
+        }
+#else
+        /* Without the cancel pipe, fall back to polling the flag */
+        if(fds[1].fd < 0 && (timeout < 0 || timeout > 50))
+            timeout = 50;
+        n = poll(fds, 2, timeout);
+        if(!n || (n < 0 && errno == EINTR))
+            continue;
+        if(n < 0 || fds[1].revents)
+            break;
+        if((len = read(thread->fd, block, sizeof(block))) <= 0)
+            break;
+#endif
+        if(!tuner_read(thread, &reader, block, len))
+            break;
+    }
+
+tuner_thread_cleanup:
+#ifdef G_OS_WIN32
+    if(osReader.hEvent)
+        CloseHandle(osReader.hEvent);
+    if(socket_event != WSA_INVALID_EVENT)
+        WSACloseEvent(socket_event);
+#endif
+    tuner_writer_stop(thread);
+    if(thread->type == TUNER_THREAD_SOCKET)
+    {
+#ifdef G_OS_WIN32
+        shutdown(thread->fd, 2);
+        closesocket(thread->fd);
+#else
+        shutdown(thread->fd, 2);
+        close(thread->fd);
+#endif
+    }
+    else if(thread->type == TUNER_THREAD_SERIAL)
+    {
+        tuner_restart(thread->fd);
+#ifdef G_OS_WIN32
+        CloseHandle((HANDLE)thread->fd);
+#else
+        close(thread->fd);
+#endif
+    }
+
+    event.type = TUNER_EVENT_DISCONNECT;
+    event.data.value = 0;
+    if(thread->parser.merge)
+        tuner_merge_event(thread->parser.merge, RDS_MERGE_SECONDARY, &event);
+    else if(thread->tracker && thread->tracker->merge)
+        tuner_merge_event(thread->tracker->merge, RDS_MERGE_PRIMARY, &event);
+    tuner_queue_push(thread->queue, &event, TRUE);
+    tuner_record_flush();
+    g_print("thread stop: %p\n", data);
+    tuner_thread_unref(thread);
+    return NULL;
+}
+
+static void
+tuner_replay(tuner_thread_t *thread)
+{
+    tuner_replay_t *replay = tuner_replay_new(thread->fd);
+    gdouble speed = tuner_replay_get_speed();
+    const gchar *line;
+    gint64 start, due, delay;
+
+    if(!replay)
+        return;
+
+    start = due = g_get_monotonic_time();
+    while(!thread->canceled && tuner_replay_next(replay, &delay, &line))
+    {
+        if(speed > TUNER_REPLAY_NO_DELAY)
+        {
+            /* Keep the original timing, regardless of the parsing time */
+            due += (gint64)(delay / speed);
+            if(!tuner_thread_sleep(thread, due))
+                break;
+        }
+        if(!tuner_parse(&thread->parser, line))
+            break;
+    }
+
+    g_print("thread replay: %p (lines: %u, speed: %.1fx, time: %.3f s)\n",
+            (gpointer)thread,
+            thread->parser.lines,
+            speed,
+            (g_get_monotonic_time() - start) / 1000000.0);
+    tuner_replay_free(replay);
+}
+
+static gboolean
+tuner_thread_sleep(tuner_thread_t *thread,
+                   gint64          until)
+{
+    /* Returns FALSE when the thread gets canceled meanwhile */
+    gint64 now = g_get_monotonic_time();
+#ifndef G_OS_WIN32
+    struct pollfd fds;
+
+    fds.fd = thread->cancel_pipe[0];
+    fds.events = POLLIN;
+#endif
+
+    while(now < until && !thread->canceled)
+    {
+#ifdef G_OS_WIN32
+        WaitForSingleObject(thread->cancel_event, (DWORD)((until - now + 999) / 1000));
+#else
+        poll(&fds, 1, (gint)MIN((until - now + 999) / 1000, (fds.fd < 0 ? 50 : G_MAXINT)));
+#endif
+        now = g_get_monotonic_time();
+    }
+    return !thread->canceled;
+}
+
+static gint
+tuner_startup(tuner_thread_t  *thread,
+              tuner_startup_t *startup,
+              tuner_reader_t  *reader)
+{
+    /* Arduino may restart during port opening: probe it until
+     * the OK banner arrives instead of waiting a fixed time */
+    gint64 now;
+
+    if(!startup->probing)
+        return -1;
+
+    now = g_get_monotonic_time();
+    if(thread->parser.ready)
+    {
+        /* No more probes. OKs of the ones in flight are ignored for a while,
+         * after that an OK means the tuner has restarted. */
+        if(!startup->settled)
+        {
+            g_print("thread ready: %p (%" G_GINT64_FORMAT " ms)\n",
+                    (gpointer)thread,
+                    (now - startup->start) / 1000);
+            startup->settled = now + STARTUP_PROBE_INTERVAL;
+        }
+        if(now < startup->settled)
+            return (startup->settled - now + 999) / 1000;
+        thread->parser.probes = 0;
+        startup->probing = FALSE;
+        return -1;
+    }
+
+    if(now - startup->start >= STARTUP_TIMEOUT)
+    {
+        g_print("thread ready: %p (no response in %d ms)\n",
+                (gpointer)thread,
+                STARTUP_TIMEOUT / 1000);
+        startup->probing = FALSE;
+        return -1;
+    }
+
+    if(now >= startup->next_probe)
+    {
+        /* Drop a partial line received from the bootloader */
+        reader->pos = 0;
+        tuner_write(thread, "x");
+        thread->parser.probes++;
+        startup->next_probe = now + STARTUP_PROBE_INTERVAL;
+    }
+
+    return (startup->next_probe - now + 999) / 1000;
+}
+
+static gboolean
+tuner_read(tuner_thread_t *thread,
+           tuner_reader_t *reader,
+           gchar          *data,
+           gint            len)
+{
+    gchar *end = data + len;
+    gchar *newline;
+    gchar *line;
+    gint n;
+
+    /* Split everything received in one read into lines, only an incomplete
+     * tail is copied to the line buffer. A CR before the LF is dropped. */
+    while(data < end)
+    {
+        newline = memchr(data, '\n', end - data);
+        n = (newline ? newline : end) - data;
+
+        if(newline && !reader->pos)
+        {
+            /* Whole line is available, parse it in place */
+            *newline = 0;
+            if(n && data[n-1] == '\r')
+                data[--n] = 0;
+            if(n > SERIAL_BUFFER-1)
+                data[SERIAL_BUFFER-1] = 0;
+            line = data;
+        }
+        else
+        {
+            /* If this command is too long to
+             * fit into a buffer, clip it */
+            n = MIN(n, SERIAL_BUFFER-1-reader->pos);
+            memcpy(reader->line + reader->pos, data, n);
+            reader->pos += n;
+            if(!newline)
+                break;
+            if(reader->pos && reader->line[reader->pos-1] == '\r')
+                reader->pos--;
+            reader->line[reader->pos] = 0;
+            reader->pos = 0;
+            line = reader->line;
+        }
+        data = newline + 1;
+
+        if(!line[0])
+            continue;
+#if DEBUG_READ
+        g_print("read: %s\n", line);
+#endif
+        tuner_record_line(line);
+        if(!tuner_parse(&thread->parser, line))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+tuner_restart(gintptr fd)
+{
+#ifdef G_OS_WIN32
+    EscapeCommFunction((HANDLE)fd, CLRDTR);
+    EscapeCommFunction((HANDLE)fd, CLRRTS);
+    g_usleep(10000);
+    EscapeCommFunction((HANDLE)fd, SETDTR);
+    EscapeCommFunction((HANDLE)fd, SETRTS);
+#else
+    gint n;
+    if(ioctl(fd, TIOCMGET, &n) == -1)
+        return;
+    n &= ~(TIOCM_DTR | TIOCM_RTS);
+    ioctl(fd, TIOCMSET, &n);
+    g_usleep(10000);
+    n |=  (TIOCM_DTR | TIOCM_RTS);
+    ioctl(fd, TIOCMSET, &n);
+#endif
+}
+
+void
+tuner_write(gpointer  ptr,
+            gchar    *command)
+{
+    tuner_thread_t *thread;
+    gsize len;
+    gboolean queued = FALSE;
+
+    if(!ptr)
+        return;
+
+    thread = (tuner_thread_t*)ptr;
+    len = strlen(command);
+
+    /* Never block the caller, the writer thread will flush the commands */
+    g_mutex_lock(&thread->write_lock);
+    if(!thread->write_stop &&
+       thread->write_pending->len + len + 1 <= WRITE_LIMIT)
+    {
+        g_string_append_len(thread->write_pending, command, len);
+        g_string_append_c(thread->write_pending, '\n');
+        thread->write_commands++;
+        g_cond_signal(&thread->write_cond);
+        queued = TRUE;
+    }
+    g_mutex_unlock(&thread->write_lock);
+
+#if DEBUG_WRITE
+    g_print("write%s: %s\n",
+            (!queued ? " DROPPED" : ""),
+            command);
+#endif
+}
+
+static gpointer
+tuner_writer(gpointer data)
+{
+    tuner_thread_t *thread = (tuner_thread_t*)data;
+    GString *buffer = g_string_sized_new(256);
+    GString *swap;
+    gboolean stop;
+    gboolean ret;
+
+    g_mutex_lock(&thread->write_lock);
+    while(TRUE)
+    {
+        while(!thread->write_pending->len && !thread->write_stop)
+            g_cond_wait(&thread->write_cond, &thread->write_lock);
+
+        /* Pending commands are still sent when stopping (e.g. the X shutdown) */
+        if(!thread->write_pending->len)
+            break;
+
+        /* Take everything queued so far and send it at once */
+        swap = thread->write_pending;
+        thread->write_pending = buffer;
+        buffer = swap;
+        stop = thread->write_stop;
+        thread->write_flushes++;
+        g_mutex_unlock(&thread->write_lock);
+
+        if(thread->type == TUNER_THREAD_SERIAL)
+            ret = tuner_write_serial(thread->fd, buffer->str, buffer->len);
+        else if(thread->type == TUNER_THREAD_SOCKET)
+            ret = tuner_write_socket(thread->fd, buffer->str, buffer->len);
+        else
+            ret = TRUE; /* Commands to a replayed session are discarded */
+        g_string_truncate(buffer, 0);
+
+        g_mutex_lock(&thread->write_lock);
+        if(!ret)
+        {
+            /* The reader ends the connection and reports the disconnect */
+            g_print("write ERROR: %p\n", data);
+            thread->write_stop = TRUE;
+            tuner_thread_cancel(thread);
+            break;
+        }
+        if(stop)
+            break;
+    }
+    thread->write_done = TRUE;
+    g_cond_broadcast(&thread->write_cond);
+    g_mutex_unlock(&thread->write_lock);
+
+    g_string_free(buffer, TRUE);
+    return NULL;
+}
+
+static void
+tuner_writer_stop(tuner_thread_t *thread)
+{
+    gint64 deadline = g_get_monotonic_time() + WRITER_STOP_TIMEOUT;
+    gboolean done;
+
+    g_mutex_lock(&thread->write_lock);
+    thread->write_stop = TRUE;
+    g_cond_broadcast(&thread->write_cond);
+
+    /* The last commands are flushed, unless the write is stuck,
+     * e.g. the peer has stopped reading from the socket */
+    while(!thread->write_done)
+        if(!g_cond_wait_until(&thread->write_cond, &thread->write_lock, deadline))
+            break;
+    done = thread->write_done;
+    g_mutex_unlock(&thread->write_lock);
+
+    if(!done)
+        tuner_writer_abort(thread);
+    g_thread_join(thread->writer);
+}
+
+static void
+tuner_writer_abort(tuner_thread_t *thread)
+{
+    /* Makes a blocked write return, so the writer can be joined */
+    if(thread->type == TUNER_THREAD_SOCKET)
+    {
+        shutdown(thread->fd, 2);
+    }
+    else if(thread->type == TUNER_THREAD_SERIAL)
+    {
+#ifdef G_OS_WIN32
+        PurgeComm((HANDLE)thread->fd, PURGE_TXABORT | PURGE_TXCLEAR);
+#else
+        tcflush(thread->fd, TCOFLUSH);
+#endif
+    }
+}
+
+#ifdef G_OS_WIN32
+static gboolean
+tuner_write_serial(gintptr  fd,
+                   gchar   *msg,
+                   gint     len)
+{
+    OVERLAPPED osWrite = {0};
+    DWORD dwWritten;
+    osWrite.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if(osWrite.hEvent == NULL)
+        return FALSE;
+    if (!WriteFile((HANDLE)fd, msg, len, &dwWritten, &osWrite))
+        if (GetLastError() == ERROR_IO_PENDING)
+            if(WaitForSingleObject(osWrite.hEvent, INFINITE) == WAIT_OBJECT_0)
+                GetOverlappedResult((HANDLE)fd, &osWrite, &dwWritten, FALSE);
+    CloseHandle(osWrite.hEvent);
+    return TRUE;
+}
+#else
+static gboolean
+tuner_write_serial(gintptr  fd,
+                   gchar   *msg,
+                   gint     len)
+{
+    gint sent = 0;
+    gint n;
+    do
+    {
+        n = write(fd, msg+sent, len-sent);
+        if(n < 0)
+            return FALSE;
+        sent += n;
+    }
+    while(sent < len);
+    return TRUE;
+}
+#endif
+
+gboolean
+tuner_write_socket(gintptr  fd,
+                   gchar   *msg,
+                   gint     len)
+{
+    gint sent = 0;
+    gint n;
+
+    do
+    {
+#ifdef G_OS_WIN32
+        n = send(fd, msg+sent, len-sent, 0);
+        if(n < 0 && WSAGetLastError() == WSAEWOULDBLOCK)
+        {
+            /* The reader has switched the socket into non-blocking mode */
+            fd_set output;
+            FD_ZERO(&output);
+            FD_SET(fd, &output);
+            if(select(fd+1, NULL, &output, NULL, NULL) > 0)
+                continue;
+        }
+#else
+        n = send(fd, msg+sent, len-sent, MSG_NOSIGNAL);
+#endif
+        if(n < 0)
+        {
+            shutdown(fd, 2);
+            return FALSE;
+        }
+        sent += n;
+    }
+    while(sent < len);
+    return TRUE;
+}
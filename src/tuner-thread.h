@@ -0,0 +1,31 @@
+#ifndef XDR_TUNER_THREAD_H_
+#define XDR_TUNER_THREAD_H_
+#include <glib.h>
+#include "tuner-queue.h"
+#include "tuner-state.h"
+
+#define TUNER_THREAD_SERIAL 0
+#define TUNER_THREAD_SOCKET 1
+#define TUNER_THREAD_REPLAY 2
+
+/* How the event data is passed to its handler */
+#define PAYLOAD_VALUE  0
+#define PAYLOAD_RECORD 1
+#define PAYLOAD_HEAP   2
+
+/* Handlers run in the main loop, indexed by the event type */
+typedef struct tuner_handler
+{
+    GSourceFunc func;
+    gint payload;
+} tuner_handler_t;
+
+gpointer tuner_thread_new(gint, gintptr, const tuner_handler_t*, tuner_tracker_t*, rds_merge_t*);
+void tuner_thread_cancel(gpointer);
+gint tuner_thread_rds_reset(gpointer);
+void tuner_thread_rds_config(gpointer, const rds_decoder_config_t*);
+void tuner_thread_offsets(gpointer, const gint*);
+void tuner_write(gpointer, gchar*);
+gboolean tuner_write_socket(gintptr, gchar*, int);
+
+#endif
@@ -1,499 +1,83 @@
 #include <glib.h>
-#include <stdlib.h>
 #include <stdio.h>
-#include <string.h>
 #include <math.h>
-#include <unistd.h>
-#ifdef G_OS_WIN32
-#ifndef _WIN32_WINNT
-#define _WIN32_WINNT 0x0501
-#endif
-#include <winsock2.h>
-#include <windows.h>
-#include <ws2tcpip.h>
-#else
-#include <sys/ioctl.h>
-#include <sys/socket.h>
-#endif
-
 #include "tuner.h"
 #include "log.h"
+#include "stationlist.h"
 #include "tuner-callbacks.h"
 #include "ui-tuner-update.h"
 #include "conf.h"
 
-#define DEBUG_READ  0
-#define DEBUG_WRITE 1
+/* Antenna offsets are passed to the reader thread as they are */
+G_STATIC_ASSERT(ANT_COUNT == TUNER_STATE_ANTENNAS);
 
-#define SERIAL_BUFFER 10000
 tuner_t tuner;
 
-typedef struct tuner_thread
-{
-    gintptr fd;
-    gint type;  /* TUNER_THREAD_SERIAL or TUNER_THREAD_SOCKET */
-    volatile gboolean canceled;
-} tuner_thread_t;
-
-static gpointer tuner_thread(gpointer);
-static gboolean tuner_parse(gchar, gchar*);
-static void tuner_restart(gintptr);
-static gboolean tuner_write_serial(gintptr, gchar*, int);
-
-gpointer
-tuner_thread_new(gint    type,
-                 gintptr fd)
-{
-    tuner_thread_t *thread = g_malloc(sizeof(tuner_thread_t));
-    g_assert(type == TUNER_THREAD_SERIAL ||
-             type == TUNER_THREAD_SOCKET);
-
-    thread->fd = fd;
-    thread->type = type;
-    thread->canceled = FALSE;
-
-    g_thread_unref(g_thread_new("tuner", tuner_thread, (gpointer)thread));
-    return thread;
-}
-
-void
-tuner_thread_cancel(gpointer thread)
-{
-    ((tuner_thread_t*)thread)->canceled = TRUE;
-}
-
-static gpointer
-tuner_thread(gpointer data)
-{
-    tuner_thread_t *thread = (tuner_thread_t*)data;
-    gchar buffer[SERIAL_BUFFER];
-    gint pos = 0;
-
-    struct timeval timeout;
-    fd_set input;
-    gint n;
-
-    g_print("thread start: %p\n", data);
-
-#ifdef G_OS_WIN32
-    DWORD len_in = 0;
-    BOOL fWaitingOnRead = FALSE;
-    DWORD state;
-    OVERLAPPED osReader = {0};
-    if(thread->type == TUNER_THREAD_SERIAL)
-    {
-        osReader.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
-        if(osReader.hEvent == NULL)
-            goto tuner_thread_cleanup;
-    }
-#endif
-
-    /* Arduino may restart during port opening */
-    if(thread->type == TUNER_THREAD_SERIAL)
-        g_usleep(1750 * 1000);
-
-    if(thread->canceled)
-        goto tuner_thread_cleanup;
-
-    tuner_write(thread, "x");
-
-    while(!thread->canceled)
-    {
-#ifdef G_OS_WIN32
-        if(thread->type == TUNER_THREAD_SOCKET)
-        {
-            FD_ZERO(&input);
-            FD_SET(thread->fd, &input);
-            timeout.tv_sec  = 0;
-            timeout.tv_usec = 50000;
-            n = select(thread->fd+1, &input, NULL, NULL, &timeout);
-            if(!n)
-                continue;
-            if(n < 0 || recv(thread->fd, &buffer[pos], 1, 0) <= 0)
-                break;
-        }
-        else
-        {
-            if (!fWaitingOnRead)
-            {
-                if (!ReadFile((HANDLE)thread->fd, &buffer[pos], 1, &len_in, &osReader))
-                {
-                    if (GetLastError() != ERROR_IO_PENDING)
-                    {
-                        CloseHandle(osReader.hEvent);
-                        break;
-                    }
-                    else
-                    {
-                        fWaitingOnRead = TRUE;
-                    }
-                }
-            }
-
-            if (fWaitingOnRead)
-            {
-                state = WaitForSingleObject(osReader.hEvent, 200);
-                if(state == WAIT_TIMEOUT)
-                {
-                    continue;
-                }
-                if(state != WAIT_OBJECT_0)
-                {
-                    CloseHandle(osReader.hEvent);
-                    break;
-                }
-
-                if (!GetOverlappedResult((HANDLE)thread->fd, &osReader, &len_in, FALSE))
-                {
-                    CloseHandle(osReader.hEvent);
-                    break;
-                }
-
-                fWaitingOnRead = FALSE;
-            }
-            if(len_in != 1)
-            {
-                continue;
-            }
-        }
-#else
-        FD_ZERO(&input);
-        FD_SET(thread->fd, &input);
-        timeout.tv_sec  = 0;
-        timeout.tv_usec = 50000;
-        n = select(thread->fd+1, &input, NULL, NULL, &timeout);
-        if(!n)
-            continue;
-        if(n < 0 || read(thread->fd, &buffer[pos], 1) <= 0)
-            break;
-#endif
-        /* If this command is too long to
-         * fit into a buffer, clip it */
-        if(buffer[pos] != '\n')
-        {
-            if(pos != SERIAL_BUFFER-1)
-                pos++;
-            continue;
-        }
-        buffer[pos] = 0;
-        pos = 0;
-
-#if DEBUG_READ
-        g_print("read: %s\n", buffer);
-#endif
-        if(!tuner_parse(buffer[0], buffer+1))
-            break;
-    }
-
-tuner_thread_cleanup:
-    if(thread->type == TUNER_THREAD_SOCKET)
-    {
-#ifdef G_OS_WIN32
-        shutdown(thread->fd, 2);
-        closesocket(thread->fd);
-#else
-        shutdown(thread->fd, 2);
-        close(thread->fd);
-#endif
-    }
-    else
-    {
-        tuner_restart(thread->fd);
-#ifdef G_OS_WIN32
-        CloseHandle((HANDLE)thread->fd);
-#else
-        close(thread->fd);
-#endif
-    }
-
-    g_idle_add(tuner_disconnect, thread);
-    g_print("thread stop: %p\n", data);
-    return NULL;
-}
-
-static gboolean
-tuner_parse(gchar  c,
-            gchar *msg)
-{
-    if(c == 'O' && msg[0] == 'K')
-    {
-        /* Tuner startup */
-        g_idle_add(tuner_ready, NULL);
-    }
-    else if(c == 'X')
-    {
-        /* Tuner shutdown */
-        return FALSE;
-    }
-    else if(c == 'T')
-    {
-        /* Tuned frequency */
-        g_idle_add(tuner_freq, GINT_TO_POINTER(atoi(msg)));
-    }
-    else if(c == 'V')
-    {
-        /* DAA tuning voltage */
-        g_idle_add(tuner_daa, GINT_TO_POINTER(atoi(msg)));
-    }
-    else if(c == 'S' && strlen(msg) >= 2)
-    {
-        /* Signal strength and quality indicators */
-        tuner_signal_t *data = g_malloc(sizeof(tuner_signal_t));
-        gchar *ptr;
-        switch(msg[0])
-        {
-            case 's':
-                data->stereo = SIGNAL_STEREO;
-                break;
-            case 'S':
-                data->stereo = SIGNAL_STEREO | SIGNAL_FORCED_MONO;
-                break;
-            case 'M':
-                data->stereo = SIGNAL_FORCED_MONO;
-                break;
-            default:
-                data->stereo = SIGNAL_MONO;
-                break;
-        }
-        data->value = g_ascii_strtod(msg+1, NULL);
-        g_idle_add(tuner_signal, data);
-
-        if((ptr = strchr(msg, ',')))
-        {
-            g_idle_add(tuner_cci, GINT_TO_POINTER(atoi(ptr+1)));
-            if((ptr = strchr(ptr+1, ',')))
-                g_idle_add(tuner_aci, GINT_TO_POINTER(atoi(ptr+1)));
-        }
-    }
-    else if(c == 'P' && strlen(msg) >= 4)
-    {
-        /* PI code */
-        guint pi = strtoul(msg, NULL, 16);
-        guint8 err = 0;
-        gchar *ptr;
-
-        for(ptr = msg+4; *ptr; ptr++)
-            if(*ptr == '?')
-                err++;
-        pi |= (((err > 3) ? 3 : err) << 16);
-
-        g_idle_add(tuner_pi, GUINT_TO_POINTER(pi));
-    }
-    else if(c == 'R' && strlen(msg) == 14)
-    {
-        /* RDS data */
-        g_idle_add(tuner_rds, g_strdup(msg));
-    }
-    else if(c == 'U')
-    {
-        /* Spectral scan */
-        tuner_scan_t *scan = tuner_scan_parse(msg);
-        if(scan)
-            g_idle_add(tuner_scan, (gpointer)scan);
-    }
-    else if(c == 'N')
-    {
-        /* Stereo pilot injection level estimation */
-        g_idle_add(tuner_pilot, GINT_TO_POINTER(atoi(msg)));
-    }
-    else if(c == 'Y')
-    {
-        /* Sound volume control */
-        g_idle_add(tuner_volume, GINT_TO_POINTER(atoi(msg)));
-    }
-    else if(c == 'A')
-    {
-        /* RF AGC threshold */
-        g_idle_add(tuner_agc, GINT_TO_POINTER(atoi(msg)));
-    }
-    else if(c == 'D')
-    {
-        /* De-emphasis */
-        g_idle_add(tuner_deemphasis, GINT_TO_POINTER(atoi(msg)));
-    }
-    else if(c == 'Z')
-    {
-        /* Antenna switch */
-        g_idle_add(tuner_antenna, GINT_TO_POINTER(atoi(msg)));
-    }
-    else if(c == 'G')
-    {
-        /* RF & IF gain setting */
-        g_idle_add(tuner_gain, GINT_TO_POINTER(atoi(msg)));
-    }
-    else if(c == 'M')
-    {
-        /* FM / AM mode */
-        g_idle_add(tuner_mode, GINT_TO_POINTER(atoi(msg)));
-    }
-    else if(c == 'F')
-    {
-        /* Filter */
-        g_idle_add(tuner_filter, GINT_TO_POINTER(atoi(msg)));
-    }
-    else if(c == 'Q')
-    {
-        /* Squelch */
-        g_idle_add(tuner_squelch, GINT_TO_POINTER(atoi(msg)));
-    }
-    else if(c == 'C')
-    {
-        /* Rotator control */
-        g_idle_add(tuner_rotator, GINT_TO_POINTER(atoi(msg)));
-    }
-    else if(c == 'I')
-    {
-        /* Custom signal level sampling interval */
-        g_idle_add(tuner_sampling_interval, GINT_TO_POINTER(atoi(msg)));
-    }
-    else if(c == '!')
-    {
-        /* External event */
-        g_idle_add(tuner_event, NULL);
-    }
-    else if(c == 'o')
-    {
-        /* Online users (network) */
-        gchar *ptr;
-        g_idle_add(tuner_online, GINT_TO_POINTER(atoi(msg)));
-        if((ptr = strchr(msg, ',')))
-            g_idle_add(tuner_online_guests, GINT_TO_POINTER(atoi(ptr+1)));
-    }
-    else if(c == 'a')
-    {
-        /* Authorization (network) */
-        gint auth = atoi(msg);
-        if(!auth)
-        {
-            g_idle_add(tuner_unauthorized, NULL);
-            return FALSE;
-        }
-        else if(auth == 1)
-        {
-            g_idle_add(tuner_ready, GINT_TO_POINTER(TRUE));
-        }
-    }
-    return TRUE;
-}
-
-static void
-tuner_restart(gintptr fd)
-{
-#ifdef G_OS_WIN32
-    EscapeCommFunction((HANDLE)fd, CLRDTR);
-    EscapeCommFunction((HANDLE)fd, CLRRTS);
-    g_usleep(10000);
-    EscapeCommFunction((HANDLE)fd, SETDTR);
-    EscapeCommFunction((HANDLE)fd, SETRTS);
-#else
-    gint n;
-    if(ioctl(fd, TIOCMGET, &n) == -1)
-        return;
-    n &= ~(TIOCM_DTR | TIOCM_RTS);
-    ioctl(fd, TIOCMSET, &n);
-    g_usleep(10000);
-    n |=  (TIOCM_DTR | TIOCM_RTS);
-    ioctl(fd, TIOCMSET, &n);
-#endif
-}
-
-void
-tuner_write(gpointer  ptr,
-            gchar    *command)
-{
-    tuner_thread_t *thread;
-    gchar *msg;
-    gint len;
-    gboolean ret;
-
-    if(!ptr)
-        return;
-
-    thread = (tuner_thread_t*)ptr;
-    msg = g_strdup(command);
-    len = strlen(command);
-    msg[len++] = '\n';
-
-    if(thread->type == TUNER_THREAD_SERIAL)
-        ret = tuner_write_serial(thread->fd, msg, len);
-    else
-        ret = tuner_write_socket(thread->fd, msg, len);
-
-    g_free(msg);
-#if DEBUG_WRITE
-    g_print("write%s: %s\n",
-            (!ret ? " ERROR" : ""),
-            command);
-#endif
-}
-
-#ifdef G_OS_WIN32
-static gboolean
-tuner_write_serial(gintptr  fd,
-                   gchar   *msg,
-                   gint     len)
+const tuner_handler_t tuner_handlers[TUNER_EVENT_COUNT] =
 {
-    OVERLAPPED osWrite = {0};
-    DWORD dwWritten;
-    osWrite.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
-    if(osWrite.hEvent == NULL)
-        return FALSE;
-    if (!WriteFile((HANDLE)fd, msg, len, &dwWritten, &osWrite))
-        if (GetLastError() == ERROR_IO_PENDING)
-            if(WaitForSingleObject(osWrite.hEvent, INFINITE) == WAIT_OBJECT_0)
-                GetOverlappedResult((HANDLE)fd, &osWrite, &dwWritten, FALSE);
-    CloseHandle(osWrite.hEvent);
-    return TRUE;
-}
-#else
-static gboolean
-tuner_write_serial(gintptr  fd,
-                   gchar   *msg,
-                   gint     len)
+    [TUNER_EVENT_READY]             = { tuner_ready,             PAYLOAD_VALUE },
+    [TUNER_EVENT_UNAUTHORIZED]      = { tuner_unauthorized,      PAYLOAD_VALUE },
+    [TUNER_EVENT_DISCONNECT]        = { tuner_disconnect,        PAYLOAD_VALUE },
+    [TUNER_EVENT_FREQ]              = { tuner_freq,              PAYLOAD_VALUE },
+    [TUNER_EVENT_DAA]               = { tuner_daa,               PAYLOAD_VALUE },
+    [TUNER_EVENT_SIGNAL]            = { tuner_signal,            PAYLOAD_RECORD },
+    [TUNER_EVENT_CCI]               = { tuner_cci,               PAYLOAD_VALUE },
+    [TUNER_EVENT_ACI]               = { tuner_aci,               PAYLOAD_VALUE },
+    [TUNER_EVENT_PI]                = { tuner_pi,                PAYLOAD_VALUE },
+    [TUNER_EVENT_RDS]               = { tuner_rds,               PAYLOAD_RECORD },
+    [TUNER_EVENT_SCAN]              = { tuner_scan,              PAYLOAD_HEAP },
+    [TUNER_EVENT_PILOT]             = { tuner_pilot,             PAYLOAD_VALUE },
+    [TUNER_EVENT_VOLUME]            = { tuner_volume,            PAYLOAD_VALUE },
+    [TUNER_EVENT_AGC]               = { tuner_agc,               PAYLOAD_VALUE },
+    [TUNER_EVENT_DEEMPHASIS]        = { tuner_deemphasis,        PAYLOAD_VALUE },
+    [TUNER_EVENT_ANTENNA]           = { tuner_antenna,           PAYLOAD_VALUE },
+    [TUNER_EVENT_EVENT]             = { tuner_event,             PAYLOAD_VALUE },
+    [TUNER_EVENT_GAIN]              = { tuner_gain,              PAYLOAD_VALUE },
+    [TUNER_EVENT_MODE]              = { tuner_mode,              PAYLOAD_VALUE },
+    [TUNER_EVENT_FILTER]            = { tuner_filter,            PAYLOAD_VALUE },
+    [TUNER_EVENT_SQUELCH]           = { tuner_squelch,           PAYLOAD_VALUE },
+    [TUNER_EVENT_ROTATOR]           = { tuner_rotator,           PAYLOAD_VALUE },
+    [TUNER_EVENT_SAMPLING_INTERVAL] = { tuner_sampling_interval, PAYLOAD_VALUE },
+    [TUNER_EVENT_ONLINE]            = { tuner_online,            PAYLOAD_VALUE },
+    [TUNER_EVENT_ONLINE_GUESTS]     = { tuner_online_guests,     PAYLOAD_VALUE }
+};
+
+/* Secondary tuner: only its tuning and connection matter here,
+ * RDS goes to the merge straight from its reader thread */
+const tuner_handler_t tuner_diversity_handlers[TUNER_EVENT_COUNT] =
 {
-    gint sent = 0;
-    gint n;
-    do
-    {
-        n = write(fd, msg+sent, len-sent);
-        if(n < 0)
-            return FALSE;
-        sent += n;
-    }
-    while(sent < len);
-    return TRUE;
-}
-#endif
-
-gboolean
-tuner_write_socket(gintptr  fd,
-                   gchar   *msg,
-                   gint     len)
-{
-    gint sent = 0;
-    gint n;
-
-    do
-    {
-#ifdef G_OS_WIN32
-        n = send(fd, msg+sent, len-sent, 0);
-#else
-        n = send(fd, msg+sent, len-sent, MSG_NOSIGNAL);
-#endif
-        if(n < 0)
-        {
-            shutdown(fd, 2);
-            return FALSE;
-        }
-        sent += n;
-    }
-    while(sent < len);
-    return TRUE;
-}
+    [TUNER_EVENT_READY]             = { tuner_diversity_ready,      PAYLOAD_VALUE },
+    [TUNER_EVENT_UNAUTHORIZED]      = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_DISCONNECT]        = { tuner_diversity_disconnect, PAYLOAD_VALUE },
+    [TUNER_EVENT_FREQ]              = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_DAA]               = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_SIGNAL]            = { tuner_diversity_ignore,     PAYLOAD_RECORD },
+    [TUNER_EVENT_CCI]               = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_ACI]               = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_PI]                = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_RDS]               = { tuner_diversity_ignore,     PAYLOAD_RECORD },
+    [TUNER_EVENT_SCAN]              = { tuner_diversity_scan,       PAYLOAD_HEAP },
+    [TUNER_EVENT_PILOT]             = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_VOLUME]            = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_AGC]               = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_DEEMPHASIS]        = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_ANTENNA]           = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_EVENT]             = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_GAIN]              = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_MODE]              = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_FILTER]            = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_SQUELCH]           = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_ROTATOR]           = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_SAMPLING_INTERVAL] = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_ONLINE]            = { tuner_diversity_ignore,     PAYLOAD_VALUE },
+    [TUNER_EVENT_ONLINE_GUESTS]     = { tuner_diversity_ignore,     PAYLOAD_VALUE }
+};
 
 void tuner_clear_all()
 {
     log_cleanup();
+    rds_timing_finish(&tuner.rds_timing);
+    rds_stats_reset(&tuner.rds_stats, 0);
 
     tuner.freq = 0;
     tuner.prevfreq = 0;
@@ -511,7 +95,28 @@ void tuner_clear_all()
     tuner.aci = -1;
     ui_update_aci();
 
+    rds_decoder_init(&tuner.rds_decoder);
+    rds_decoder_subscribe(&tuner.rds_decoder,
+                          RDS_EVENT_MASK(RDS_EVENT_PI) | RDS_EVENT_MASK(RDS_EVENT_PTY) |
+                          RDS_EVENT_MASK(RDS_EVENT_TP) | RDS_EVENT_MASK(RDS_EVENT_TA) |
+                          RDS_EVENT_MASK(RDS_EVENT_MS) | RDS_EVENT_MASK(RDS_EVENT_AF) |
+                          RDS_EVENT_MASK(RDS_EVENT_PS) | RDS_EVENT_MASK(RDS_EVENT_RT) |
+                          RDS_EVENT_MASK(RDS_EVENT_RESTORE),
+                          tuner_rds_decoded, NULL);
+    rds_decoder_subscribe(&tuner.rds_decoder, LOG_RDS_EVENTS, log_rds, NULL);
+    rds_decoder_subscribe(&tuner.rds_decoder, STATIONLIST_RDS_EVENTS, stationlist_rds, NULL);
+    rds_decoder_subscribe(&tuner.rds_decoder,
+                          RDS_EVENT_MASK(RDS_EVENT_PI) | RDS_EVENT_MASK(RDS_EVENT_PTY) |
+                          RDS_EVENT_MASK(RDS_EVENT_ECC) | RDS_EVENT_MASK(RDS_EVENT_AF) |
+                          RDS_EVENT_MASK(RDS_EVENT_PS),
+                          tuner_rds_station, NULL);
+    rds_decoder_subscribe(&tuner.rds_decoder,
+                          RDS_EVENT_MASK(RDS_EVENT_PI) | RDS_EVENT_MASK(RDS_EVENT_PS) |
+                          RDS_EVENT_MASK(RDS_EVENT_RT),
+                          tuner_rds_stats, NULL);
+    tuner_rds_configure();
     tuner_clear_rds();
+    tuner.rds_generation = 0;
 
     tuner.ready = FALSE;
     tuner.ready_tuned = FALSE;
@@ -529,9 +134,7 @@ void tuner_clear_all()
 
 void tuner_clear_signal()
 {
-    tuner.signal_max = NAN;
-    tuner.signal_sum = 0.0;
-    tuner.signal_samples = 0;
+    signal_stats_reset(&tuner.signal_stats);
 
     tuner.stereo = FALSE;
     ui_update_stereo_flag();
@@ -539,11 +142,24 @@ void tuner_clear_signal()
 
 void tuner_clear_rds()
 {
-    gint i;
+    /* The reader thread discards its state too */
+    tuner.rds_generation = tuner_thread_rds_reset(tuner.thread);
+    tuner_clear_rds_view();
+}
 
+void tuner_clear_rds_view()
+{
     tuner.rds = 0;
     ui_update_rds_flag();
     tuner.rds_reset_timer = 0;
+    rds_decoder_reset(&tuner.rds_decoder);
+    tuner.rds_synced = -1;
+    tuner_clear_rds_data();
+}
+
+void tuner_clear_rds_data()
+{
+    gint i;
 
     tuner.rds_pi = -1;
     tuner.rds_pi_err_level = G_MAXINT;
@@ -561,14 +177,12 @@ void tuner_clear_rds()
     tuner.rds_pty = -1;
     ui_update_pty();
 
-    tuner.rds_ecc = -1;
-    ui_update_ecc();
-
     sprintf(tuner.rds_ps, "%8s", "");
     for(i=0; i<8; i++)
         tuner.rds_ps_err[i] = 0xFF;
     tuner.rds_ps_avail = FALSE;
-    ui_update_ps(FALSE);
+    tuner.rds_ps_cached = FALSE;
+    ui_update_ps();
 
     sprintf(tuner.rds_rt[0], "%64s", "");
     tuner.rds_rt_avail[0] = FALSE;
@@ -590,9 +204,56 @@ gint tuner_get_offset()
     return tuner.offset[tuner.antenna];
 }
 
+gint tuner_ps_mode()
+{
+    if(conf.rds_ps_voting)
+        return RDS_PS_MODE_VOTING;
+    if(conf.rds_ps_progressive)
+        return RDS_PS_MODE_PROGRESSIVE;
+    return RDS_PS_MODE_STANDARD;
+}
+
+void tuner_rds_configure()
+{
+    /* Decoding runs in the reader thread, the copy needs the same settings */
+    rds_decoder_config_t *config = &tuner.rds_decoder.config;
+
+    config->ps_info_error = conf.rds_ps_info_error;
+    config->ps_data_error = conf.rds_ps_data_error;
+    config->ps_progressive = conf.rds_ps_progressive;
+    config->ps_voting = conf.rds_ps_voting;
+    config->rt_info_error = conf.rds_rt_info_error;
+    config->rt_data_error = conf.rds_rt_data_error;
+    config->rt_voting = conf.rds_rt_voting;
+    tuner_thread_rds_config(tuner.thread, config);
+}
+
+tuner_tracker_t* tuner_new_tracker()
+{
+    /* Configured before the reader thread starts, its first group is decoded with the settings */
+    tuner_tracker_t *tracker = tuner_tracker_new(&tuner.snapshot);
+
+    tuner_tracker_config(tracker, &tuner.rds_decoder.config);
+    tuner_tracker_offsets(tracker, tuner.offset);
+    return tracker;
+}
+
+void tuner_diversity_tune()
+{
+    /* The secondary tuner follows the frequency reported by the primary one */
+    gchar buffer[16];
+
+    if(!tuner.diversity || !tuner.diversity_ready || tuner.freq <= 0)
+        return;
+
+    g_snprintf(buffer, sizeof(buffer), "T%d", tuner.freq);
+    tuner_write(tuner.diversity, buffer);
+}
+
 void tuner_set_offset(gint antenna,
                       gint offset)
 {
     if(antenna >= 0 && antenna <= ANT_COUNT)
         tuner.offset[antenna] = offset;
+    tuner_thread_offsets(tuner.thread, tuner.offset);
 }
@@ -3,17 +3,18 @@
 #include <glib.h>
 #include "conf.h"
 #include "tuner-filters.h"
-
-#define TUNER_THREAD_SERIAL 0
-#define TUNER_THREAD_SOCKET 1
+#include "tuner-queue.h"
+#include "tuner-thread.h"
+#include "rds-decoder.h"
+#include "signal-stats.h"
+#include "rds-stats.h"
+#include "rds-timing.h"
+#include "station-db.h"
+#include "rds-archive.h"
 
 #define MODE_FM 0
 #define MODE_AM 1
 
-#define SIGNAL_MONO             0
-#define SIGNAL_STEREO           1
-#define SIGNAL_FORCED_MONO  (1<<1)
-
 #define TUNER_FREQ_MIN 100
 #define TUNER_FREQ_MAX 200000
 
@@ -24,12 +25,6 @@ typedef struct signal_data
     gboolean stereo;
 } signal_data_t;
 
-typedef struct tuner_signal
-{
-    gfloat value;
-    gboolean stereo;
-} tuner_signal_t;
-
 typedef struct tuner
 {
     gint mode;
@@ -39,9 +34,7 @@ typedef struct tuner
 
     gint     sampling_interval;
     gfloat   signal;
-    gfloat   signal_max;
-    gdouble  signal_sum;
-    guint    signal_samples;
+    signal_stats_t signal_stats;
     gboolean stereo;
 
     gint     cci;
@@ -55,12 +48,23 @@ typedef struct tuner
     gint     rds_ta;
     gint     rds_ms;
     gint     rds_pty;
-    gint     rds_ecc;
     gchar    rds_ps[9];
     guchar   rds_ps_err[8];
     gboolean rds_ps_avail;
+    gboolean rds_ps_cached;
     gchar    rds_rt[2][65];
     gboolean rds_rt_avail[2];
+    rds_decoder_t rds_decoder;  /* copy of the reader thread decoder */
+    gint     rds_synced;
+    gint     rds_generation;
+    rds_timing_t rds_timing;
+    rds_stats_t rds_stats;
+    tuner_snapshot_t snapshot;  /* published by the reader thread */
+    station_db_t *station_db;
+    rds_archive_t *rds_archive;
+    gpointer diversity;        /* secondary tuner thread */
+    gboolean diversity_ready;
+    rds_merge_t *rds_merge;
 
     gint daa;
     gint volume;
@@ -99,16 +103,20 @@ typedef struct tuner
 
 extern tuner_t tuner;
 
-gpointer tuner_thread_new(gint, gintptr);
-gboolean tuner_write_socket(gintptr, gchar*, int);
-void tuner_thread_cancel(gpointer);
-void tuner_write(gpointer, gchar*);
+extern const tuner_handler_t tuner_handlers[];
+extern const tuner_handler_t tuner_diversity_handlers[];
 
 void tuner_clear_all();
 void tuner_clear_signal();
 void tuner_clear_rds();
+void tuner_clear_rds_view();
+void tuner_clear_rds_data();
 gint tuner_get_freq();
 gint tuner_get_offset();
+gint tuner_ps_mode();
+void tuner_rds_configure();
+tuner_tracker_t* tuner_new_tracker();
+void tuner_diversity_tune();
 void tuner_set_offset(gint, gint);
 
 #endif
@@ -12,6 +12,7 @@
 #include "version.h"
 #include "tuner-conn.h"
 #include "tuner.h"
+#include "tuner-replay.h"
 #include "ui-tuner-set.h"
 #include "ui-signal.h"
 
@@ -63,6 +64,64 @@ connection_toggle()
     connection_dialog(FALSE);
 }
 
+void
+connection_replay(const gchar *path)
+{
+    gchar *name;
+    gintptr fd;
+
+    if(!tuner_replay_open(path, &fd))
+    {
+        ui_dialog(ui.window,
+                  GTK_MESSAGE_ERROR,
+                  "Replay",
+                  "Unable to open the tuner session:\n%s",
+                  path);
+        return;
+    }
+
+    name = g_path_get_basename(path);
+    g_snprintf(ui.window_title, 100, "%s / %s", APP_NAME, name);
+    g_free(name);
+    gtk_window_set_title(GTK_WINDOW(ui.window), ui.window_title);
+    signal_clear();
+
+    tuner.thread = tuner_thread_new(TUNER_THREAD_REPLAY, fd, tuner_handlers, tuner_new_tracker(), tuner.rds_merge);
+    connect_button(TRUE);
+}
+
+void
+connection_diversity(const gchar *serial)
+{
+    /* Second tuner on the same frequency, its RDS is merged into the primary one */
+    gintptr fd;
+
+    if(tuner_open_serial(serial, &fd) != CONN_SUCCESS)
+    {
+        ui_dialog(ui.window,
+                  GTK_MESSAGE_ERROR,
+                  "Diversity",
+                  "Unable to open the secondary tuner:\n%s",
+                  serial);
+        return;
+    }
+
+    if(!tuner.rds_merge)
+        tuner.rds_merge = rds_merge_new();
+    tuner.diversity = tuner_thread_new(TUNER_THREAD_SERIAL, fd, tuner_diversity_handlers, NULL, tuner.rds_merge);
+}
+
+void
+connection_merge_release()
+{
+    /* Both readers use the merge until their disconnect is dispatched */
+    if(tuner.rds_merge && !tuner.thread && !tuner.diversity)
+    {
+        rds_merge_free(tuner.rds_merge);
+        tuner.rds_merge = NULL;
+    }
+}
+
 void
 connection_dialog(gboolean auto_connect)
 {
@@ -120,6 +179,13 @@ connection_dialog(gboolean auto_connect)
         }
         closedir(d);
     }
+    /* Keep a configured port that is not listed above (e.g. a pseudo-terminal) */
+    if(gtk_combo_box_get_active(GTK_COMBO_BOX(c_serial)) < 0 &&
+       conf.serial && strlen(conf.serial))
+    {
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(c_serial), conf.serial);
+        gtk_combo_box_set_active(GTK_COMBO_BOX(c_serial), i);
+    }
 #endif
     g_signal_connect(c_serial, "changed", G_CALLBACK(connection_dialog_select), r_serial);
     gtk_box_pack_start(GTK_BOX(content), c_serial, TRUE, TRUE, 0);
@@ -375,7 +441,7 @@ connection_dialog_connected(gint mode,
     gtk_widget_set_sensitive(ui.b_connect, FALSE);
 
     wait_for_tuner = TRUE;
-    tuner.thread = tuner_thread_new(mode, fd);
+    tuner.thread = tuner_thread_new(mode, fd, tuner_handlers, tuner_new_tracker(), tuner.rds_merge);
 
     while(!tuner.ready && tuner.thread)
     {
@@ -4,6 +4,9 @@
 
 void connection_toggle();
 void connection_dialog(gboolean);
+void connection_replay(const gchar*);
+void connection_diversity(const gchar*);
+void connection_merge_release();
 gboolean connection_socket_callback(gpointer);
 gboolean connection_socket_callback_info(gpointer);
 void connection_socket_auth_fail();
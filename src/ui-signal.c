@@ -5,6 +5,7 @@
 #include "tuner.h"
 #include "conf.h"
 #include "ui-signal.h"
+#include "signal-history.h"
 
 #define GRAPH_FONT_SIZE  12
 
@@ -14,22 +15,41 @@
 
 #define GRAPH_SCALE_LINE_LENGTH 5
 
-typedef struct signal_sample
+enum
 {
-    gfloat value;
-    gboolean rds;
-    gboolean stereo;
-    gint freq;
-} signal_sample_t;
-
-typedef struct signal_buffer
+    GRAPH_COLOR_MONO,
+    GRAPH_COLOR_STEREO,
+    GRAPH_COLOR_RDS
+};
+
+/* Rendered graph: the scale and grid layer is redrawn only when
+ * the range changes, the columns are kept in a surface used as
+ * a ring, pixel n goes to the column n modulo the width */
+typedef struct graph_cache
 {
-    signal_sample_t *data;
-    gint len;
-    gint pos;
-} signal_buffer_t;
-
-signal_buffer_t s;
+    gboolean valid;
+    cairo_surface_t *scale;
+    cairo_surface_t *columns;
+    gint width;
+    gint height;
+    gint offset_left;
+    gint mode;
+    guint64 pixels;
+    gfloat *values;
+    guint8 *colors;
+    gint low;
+    gint high;
+} graph_cache_t;
+
+/* Samples per pixel, the history keeps about 4 million samples */
+static const guint graph_zoom[] = { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000 };
+static gint graph_zoom_level = 0;
+
+static signal_history_t *history;
+static guint64 history_start;
+static signal_bucket_t *graph_buckets;
+static gint graph_buckets_len;
+static graph_cache_t graph;
 
 static GdkColor graph_color_border;
 static GdkColor graph_color_scale;
@@ -41,6 +61,15 @@ static gint grid_pattern_len = sizeof(grid_pattern) / sizeof(grid_pattern[0]);
 
 static gboolean graph_draw(GtkWidget*, GdkEventExpose*, gpointer);
 static gboolean graph_click(GtkWidget*, GdkEventButton*, gpointer);
+static gboolean graph_scroll(GtkWidget*, GdkEventScroll*, gpointer);
+static void graph_update(GtkWidget*);
+static gboolean graph_read(guint64, gint);
+static gboolean graph_range();
+static void graph_paint_scale();
+static void graph_paint_columns();
+static void graph_paint_column(guint64);
+static void graph_range_limits(gint*, gint*);
+static void graph_invalidate();
 
 void
 signal_init()
@@ -50,12 +79,12 @@ signal_init()
     gdk_color_parse("#C8C8C8", &graph_color_grid);
     gdk_color_parse("#000000", &graph_color_font);
 
-    s.len = (ui.graph->allocation.width)-GRAPH_OFFSET_LEFT;
-    s.data = g_new(signal_sample_t, s.len);
+    history = signal_history_new();
 
-    gtk_widget_add_events(ui.graph, GDK_BUTTON_PRESS_MASK);
+    gtk_widget_add_events(ui.graph, GDK_BUTTON_PRESS_MASK | GDK_SCROLL_MASK);
     g_signal_connect(ui.graph, "expose-event", G_CALLBACK(graph_draw), NULL);
     g_signal_connect(ui.graph, "button-press-event", G_CALLBACK(graph_click), NULL);
+    g_signal_connect(ui.graph, "scroll-event", G_CALLBACK(graph_scroll), NULL);
 
     signal_resize();
     signal_clear();
@@ -65,7 +94,9 @@ signal_init()
 void
 signal_resize()
 {
+    /* Called after the graph settings are changed */
     gtk_widget_set_size_request(ui.graph, -1, conf.signal_height+2*GRAPH_OFFSET_TOP);
+    graph_invalidate();
 }
 
 static gboolean
@@ -74,47 +105,225 @@ graph_draw(GtkWidget      *widget,
            gpointer        nothing)
 {
     cairo_t *cr;
-    gdouble step;
-    gint current_value;
-    gdouble position;
-    gdouble last_position;
-    gint max = G_MININT;
-    gint min = G_MAXINT;
-    gint i, curr, prev, next;
-    gdouble value;
+    cairo_text_extents_t extents;
     gchar text[10];
+    guint zoom = graph_zoom[graph_zoom_level];
+    gint x;
+
+    graph_update(widget);
+
+    cr = gdk_cairo_create(widget->window);
+    gdk_cairo_set_source_color(cr, &ui.colors.background);
+    cairo_paint(cr);
+
+    if(graph.high == G_MININT)
+    {
+        cairo_destroy(cr);
+        return FALSE;
+    }
+
+    cairo_set_source_surface(cr, graph.scale, 0, 0);
+    cairo_paint(cr);
+
+    /* The newest pixel goes to the right edge */
+    if(graph.width)
+    {
+        x = graph.offset_left + graph.width - 1 - (gint)((graph.pixels - 1) % graph.width);
+        cairo_save(cr);
+        cairo_rectangle(cr, graph.offset_left, GRAPH_OFFSET_TOP, graph.width, conf.signal_height);
+        cairo_clip(cr);
+        cairo_set_source_surface(cr, graph.columns, x, GRAPH_OFFSET_TOP);
+        cairo_paint(cr);
+        cairo_set_source_surface(cr, graph.columns, x - graph.width, GRAPH_OFFSET_TOP);
+        cairo_paint(cr);
+        cairo_restore(cr);
+    }
+
+    if(zoom > 1)
+    {
+        cairo_select_font_face(cr, "DejaVu Sans Mono", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+        cairo_set_font_size(cr, GRAPH_FONT_SIZE);
+        g_snprintf(text, sizeof(text), "1:%u", zoom);
+        cairo_text_extents(cr, text, &extents);
+        gdk_cairo_set_source_color(cr, &graph_color_font);
+        cairo_move_to(cr, graph.offset_left+graph.width-extents.x_advance-2.0, GRAPH_OFFSET_TOP+GRAPH_FONT_SIZE);
+        cairo_show_text(cr, text);
+    }
+
+    cairo_destroy(cr);
+    return FALSE;
+}
+
+static void
+graph_update(GtkWidget *widget)
+{
+    /* Brings the rendered graph up to date with the history,
+     * only the pixels that changed since the last time are read */
     gint offset_left = GRAPH_OFFSET_LEFT + (conf.signal_unit == UNIT_DBM ? GRAPH_OFFSET_DBM : 0);
-    gint draw_count = widget->allocation.width - offset_left;
+    gint width = MAX(widget->allocation.width - offset_left, 0);
+    guint64 pixels = signal_history_pixels(history, graph_zoom[graph_zoom_level]);
+    gint count, i;
+
+    if(graph.valid &&
+       (width != graph.width ||
+        widget->allocation.height != graph.height ||
+        offset_left != graph.offset_left ||
+        tuner.mode != graph.mode))
+        graph_invalidate();
+
+    if(!graph.valid ||
+       pixels < graph.pixels ||
+       pixels - graph.pixels >= (guint64)width)
+    {
+        if(!graph.valid)
+        {
+            if(graph.scale)
+                cairo_surface_destroy(graph.scale);
+            if(graph.columns)
+                cairo_surface_destroy(graph.columns);
+            graph.width = width;
+            graph.height = widget->allocation.height;
+            graph.offset_left = offset_left;
+            graph.mode = tuner.mode;
+            graph.scale = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, widget->allocation.width, graph.height);
+            graph.columns = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, MAX(width, 1), conf.signal_height);
+            graph.values = g_renew(gfloat, graph.values, MAX(width, 1));
+            graph.colors = g_renew(guint8, graph.colors, MAX(width, 1));
+            graph.valid = TRUE;
+        }
+
+        for(i=0; i<width; i++)
+            graph.values[i] = NAN;
+        graph.pixels = pixels;
+        graph_read(pixels, width);
+        graph_range();
+        graph_paint_scale();
+        graph_paint_columns();
+        return;
+    }
+
+    /* The newest pixel drawn before may have been incomplete */
+    count = (gint)(pixels - graph.pixels) + (graph.pixels ? 1 : 0);
+    graph.pixels = pixels;
+    if(!count)
+        return;
+
+    if(graph_read(pixels, count) && graph_range())
+    {
+        graph_paint_scale();
+        graph_paint_columns();
+        return;
+    }
+
+    for(i=0; i<count; i++)
+        graph_paint_column(pixels - 1 - i);
+}
+
+static gboolean
+graph_read(guint64 pixels,
+           gint    count)
+{
+    /* Stores the count newest pixels, returns TRUE if the range has to be
+     * checked: a value is outside of it or one at its edge was replaced */
+    guint zoom = graph_zoom[graph_zoom_level];
+    gboolean check = FALSE;
+    gfloat value, old;
+    gint read, slot, i;
+
+    if(count > graph_buckets_len)
+    {
+        graph_buckets = g_renew(signal_bucket_t, graph_buckets, count);
+        graph_buckets_len = count;
+    }
 
-    if(draw_count > s.len)
-        draw_count = s.len;
+    /* Zooming out shows the history from before the last clear */
+    read = signal_history_read(history, zoom, (zoom > 1 ? 0 : history_start),
+                               graph_buckets, count);
 
-    curr = s.pos;
-    for(i=0; i<draw_count; i++)
+    for(i=0; i<count && (guint64)i<pixels; i++)
     {
-        if(isnan(s.data[curr].value))
+        slot = (pixels - 1 - i) % graph.width;
+        old = graph.values[slot];
+        value = NAN;
+        if(i < read && graph_buckets[i].samples)
+        {
+            value = signal_level(conf.signal_avg ? graph_buckets[i].mean : graph_buckets[i].max);
+            if(graph_buckets[i].rds * 2 > graph_buckets[i].samples)
+                graph.colors[slot] = GRAPH_COLOR_RDS;
+            else if(graph_buckets[i].stereo * 2 > graph_buckets[i].samples)
+                graph.colors[slot] = GRAPH_COLOR_STEREO;
+            else
+                graph.colors[slot] = GRAPH_COLOR_MONO;
+        }
+        graph.values[slot] = value;
+
+        if(!isnan(old) && (floor(old) <= graph.low || ceil(old) >= graph.high))
+            check = TRUE;
+        if(!isnan(value) && (floor(value) < graph.low || ceil(value) > graph.high))
+            check = TRUE;
+    }
+    return check;
+}
+
+static gboolean
+graph_range()
+{
+    /* Returns TRUE if the autoscale range has changed */
+    gint low = G_MAXINT;
+    gint high = G_MININT;
+    gint i;
+
+    for(i=0; i<graph.width; i++)
+    {
+        if(isnan(graph.values[i]))
             continue;
-        if(signal_level(s.data[curr].value) > max)
-            max = ceil(signal_level(s.data[curr].value));
-        if(signal_level(s.data[curr].value) < min)
-            min = floor(signal_level(s.data[curr].value));
-        curr = ((curr==0) ? (s.len-1) : curr-1);
+        if(ceil(graph.values[i]) > high)
+            high = ceil(graph.values[i]);
+        if(floor(graph.values[i]) < low)
+            low = floor(graph.values[i]);
     }
 
-    cr = gdk_cairo_create(widget->window);
-    gdk_cairo_set_source_color(cr, &ui.colors.background);
+    if(low == graph.low && high == graph.high)
+        return FALSE;
+
+    graph.low = low;
+    graph.high = high;
+    return TRUE;
+}
+
+static void
+graph_range_limits(gint *min,
+                   gint *max)
+{
+    *min = graph.low;
+    *max = graph.high;
+    if((*max - *min) == 0)
+        (*max)++;
+    if((*max - *min) == 1)
+        (*min)--;
+}
+
+static void
+graph_paint_scale()
+{
+    cairo_t *cr = cairo_create(graph.scale);
+    gdouble step;
+    gint current_value;
+    gdouble position;
+    gdouble last_position;
+    gint min, max;
+    gchar text[10];
+
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
     cairo_paint(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
 
-    if(max == G_MININT)
+    if(graph.high == G_MININT)
     {
         cairo_destroy(cr);
-        return FALSE;
+        return;
     }
-
-    if((max - min) == 0)
-        max++;
-    if((max - min) == 1)
-        min--;
+    graph_range_limits(&min, &max);
 
     cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
     cairo_set_line_width(cr, 1.0);
@@ -131,8 +340,8 @@ graph_draw(GtkWidget      *widget,
         {
             /* Draw a tick */
             gdk_cairo_set_source_color(cr, &graph_color_scale);
-            cairo_move_to(cr, offset_left-0.5-GRAPH_SCALE_LINE_LENGTH/2.0, position);
-            cairo_line_to(cr, offset_left-0.5+GRAPH_SCALE_LINE_LENGTH/2.0, position);
+            cairo_move_to(cr, graph.offset_left-0.5-GRAPH_SCALE_LINE_LENGTH/2.0, position);
+            cairo_line_to(cr, graph.offset_left-0.5+GRAPH_SCALE_LINE_LENGTH/2.0, position);
             cairo_stroke(cr);
 
             /* Draw a grid */
@@ -141,8 +350,8 @@ graph_draw(GtkWidget      *widget,
                 cairo_save(cr);
                 gdk_cairo_set_source_color(cr, &graph_color_grid);
                 cairo_set_dash(cr, grid_pattern, grid_pattern_len, 0);
-                cairo_move_to(cr, offset_left-0.5+GRAPH_SCALE_LINE_LENGTH/2.0, position);
-                cairo_line_to(cr, offset_left-0.5+s.len+0.5, position);
+                cairo_move_to(cr, graph.offset_left-0.5+GRAPH_SCALE_LINE_LENGTH/2.0, position);
+                cairo_line_to(cr, graph.offset_left-0.5+graph.width+0.5, position);
                 cairo_stroke(cr);
                 cairo_restore(cr);
             }
@@ -162,61 +371,67 @@ graph_draw(GtkWidget      *widget,
         position += step;
     }
 
-    curr = s.pos;
-    for(i=draw_count; i >= 1; i--)
-    {
-        prev = ((curr==0) ? (s.len-1) : curr-1);
-        next = ((curr==(s.len-1)) ? 0 : curr+1);
-        if(!isnan(s.data[curr].value))
-        {
-            if(s.data[curr].rds)
-                gdk_cairo_set_source_color(cr, &conf.color_rds);
-            else if(s.data[curr].stereo)
-                gdk_cairo_set_source_color(cr, &conf.color_stereo);
-            else
-                gdk_cairo_set_source_color(cr, &conf.color_mono);
-
-            if(conf.signal_avg)
-            {
-                if(i == 1 || isnan(s.data[prev].value) || s.data[curr].freq != s.data[prev].freq)
-                {
-                    if(isnan(s.data[next].value) || s.data[curr].freq != s.data[next].freq)
-                        value = s.data[curr].value;
-                    else
-                        value = (s.data[curr].value + s.data[next].value) / 2.0;
-                }
-                else if(i == draw_count || isnan(s.data[next].value) || s.data[curr].freq != s.data[next].freq)
-                {
-                    if(isnan(s.data[prev].value) || s.data[curr].freq != s.data[prev].freq)
-                        value = s.data[curr].value;
-                    else
-                        value = (s.data[curr].value + s.data[prev].value) / 2.0;
-                }
-                else
-                {
-                    value = (s.data[prev].value + s.data[curr].value + s.data[next].value) / 3.0;
-                }
-            }
-            else
-            {
-                value = s.data[curr].value;
-            }
-            cairo_move_to(cr, offset_left+i, GRAPH_OFFSET_TOP+conf.signal_height);
-            cairo_line_to(cr, offset_left+i, GRAPH_OFFSET_TOP+conf.signal_height-(signal_level(value) - min)*step);
-            cairo_stroke(cr);
-        }
-        curr = prev;
-    }
-
     /* Draw left vertical and bottom horizontal line */
     gdk_cairo_set_source_color(cr, &graph_color_border);
-    cairo_move_to(cr, offset_left-0.5, GRAPH_OFFSET_TOP+0.5);
-    cairo_line_to(cr, offset_left-0.5, GRAPH_OFFSET_TOP+conf.signal_height+0.5);
-    cairo_line_to(cr, offset_left-0.5+s.len+0.5, GRAPH_OFFSET_TOP+conf.signal_height+0.5);
+    cairo_move_to(cr, graph.offset_left-0.5, GRAPH_OFFSET_TOP+0.5);
+    cairo_line_to(cr, graph.offset_left-0.5, GRAPH_OFFSET_TOP+conf.signal_height+0.5);
+    cairo_line_to(cr, graph.offset_left-0.5+graph.width+0.5, GRAPH_OFFSET_TOP+conf.signal_height+0.5);
     cairo_stroke(cr);
 
     cairo_destroy(cr);
-    return FALSE;
+}
+
+static void
+graph_paint_columns()
+{
+    cairo_t *cr = cairo_create(graph.columns);
+    guint64 i;
+
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+
+    for(i=0; i<(guint64)graph.width && i<graph.pixels; i++)
+        graph_paint_column(graph.pixels - 1 - i);
+}
+
+static void
+graph_paint_column(guint64 pixel)
+{
+    cairo_t *cr;
+    gint slot = pixel % graph.width;
+    gfloat value = graph.values[slot];
+    gint min, max;
+    gdouble height;
+
+    cr = cairo_create(graph.columns);
+    cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_rectangle(cr, slot, 0, 1, conf.signal_height);
+    cairo_set_source_rgba(cr, 0, 0, 0, 0);
+    cairo_fill(cr);
+
+    if(!isnan(value))
+    {
+        graph_range_limits(&min, &max);
+        height = (value - min) * conf.signal_height / (gdouble)(max - min);
+        if(graph.colors[slot] == GRAPH_COLOR_RDS)
+            gdk_cairo_set_source_color(cr, &conf.color_rds);
+        else if(graph.colors[slot] == GRAPH_COLOR_STEREO)
+            gdk_cairo_set_source_color(cr, &conf.color_stereo);
+        else
+            gdk_cairo_set_source_color(cr, &conf.color_mono);
+        cairo_rectangle(cr, slot, conf.signal_height - height, 1, height);
+        cairo_fill(cr);
+    }
+    cairo_destroy(cr);
+}
+
+static void
+graph_invalidate()
+{
+    /* Everything is read from the history again on the next draw */
+    graph.valid = FALSE;
 }
 
 static gboolean
@@ -226,30 +441,51 @@ graph_click(GtkWidget      *widget,
 {
     if(event->type == GDK_BUTTON_PRESS && event->button == 3) /* right click */
         signal_clear();
+    else if(event->type == GDK_BUTTON_PRESS && event->button == 2) /* middle click */
+    {
+        graph_zoom_level = 0;
+        graph_invalidate();
+        gtk_widget_queue_draw(ui.graph);
+    }
 
     return FALSE;
 }
 
+static gboolean
+graph_scroll(GtkWidget      *widget,
+             GdkEventScroll *event,
+             gpointer        nothing)
+{
+    if(event->direction == GDK_SCROLL_DOWN &&
+       graph_zoom_level < (gint)G_N_ELEMENTS(graph_zoom) - 1)
+        graph_zoom_level++;
+    else if(event->direction == GDK_SCROLL_UP && graph_zoom_level > 0)
+        graph_zoom_level--;
+    else
+        return FALSE;
+
+    graph_invalidate();
+    gtk_widget_queue_draw(ui.graph);
+    return TRUE;
+}
+
 void
 signal_push(gfloat   value,
+            gfloat   avg,
             gboolean stereo,
             gboolean rds,
-            gboolean freq)
+            gint     freq)
 {
-    s.pos = (s.pos + 1)%s.len;
-    s.data[s.pos].value = value;
-    s.data[s.pos].stereo = stereo;
-    s.data[s.pos].rds = rds;
-    s.data[s.pos].freq = freq;
+    signal_history_push(history, value, avg, stereo, rds, freq);
 }
 
 void
 signal_clear()
 {
-    gint i;
-    s.pos = 0;
-    for(i=0; i<s.len; i++)
-        s.data[i].value = NAN;
+    /* The graph starts over, the history is kept for zooming out */
+    history_start = history->samples;
+    graph_invalidate();
+    gtk_widget_queue_draw(ui.graph);
 }
 
 gfloat
@@ -4,7 +4,7 @@
 void signal_init();
 void signal_resize();
 
-void signal_push(gfloat, gboolean, gboolean, gboolean);
+void signal_push(gfloat, gfloat, gboolean, gboolean, gint);
 void signal_separator();
 void signal_clear();
 
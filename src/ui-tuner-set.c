@@ -57,6 +57,7 @@ tuner_set_bandwidth()
                tuner_filter_from_index(gtk_combo_box_get_active(GTK_COMBO_BOX(ui.c_bw))));
     tuner_write(tuner.thread, buffer);
     tuner.last_set_filter = g_get_real_time() / 1000;
+    ui_update_controls();
 }
 
 void
@@ -67,6 +68,7 @@ tuner_set_deemphasis()
     g_snprintf(buffer, sizeof(buffer), "D%d", conf.deemphasis);
     tuner_write(tuner.thread, buffer);
     tuner.last_set_deemph = g_get_real_time() / 1000;
+    ui_update_controls();
 }
 
 void
@@ -77,6 +79,7 @@ tuner_set_volume()
     g_snprintf(buffer, sizeof(buffer), "Y%d", conf.volume);
     tuner_write(tuner.thread, buffer);
     tuner.last_set_volume = g_get_real_time() / 1000;
+    ui_update_controls();
 }
 
 void
@@ -86,6 +89,7 @@ tuner_set_squelch()
     g_snprintf(buffer, sizeof(buffer), "Q%ld", lround(gtk_scale_button_get_value(GTK_SCALE_BUTTON(ui.squelch))));
     tuner_write(tuner.thread, buffer);
     tuner.last_set_squelch = g_get_real_time() / 1000;
+    ui_update_controls();
 }
 
 void
@@ -96,6 +100,7 @@ tuner_set_antenna()
     g_snprintf(buffer, sizeof(buffer), "Z%d", (antenna >=0 ? antenna : 0));
     tuner_write(tuner.thread, buffer);
     tuner.last_set_ant = g_get_real_time() / 1000;
+    ui_update_controls();
 }
 
 void
@@ -106,6 +111,7 @@ tuner_set_agc()
     g_snprintf(buffer, sizeof(buffer), "A%d", conf.agc);
     tuner_write(tuner.thread, buffer);
     tuner.last_set_agc = g_get_real_time() / 1000;
+    ui_update_controls();
 }
 
 void
@@ -117,6 +123,7 @@ tuner_set_gain()
     g_snprintf(buffer, sizeof(buffer), "G%02d", conf.rfgain * 10 + conf.ifgain);
     tuner_write(tuner.thread, buffer);
     tuner.last_set_gain = g_get_real_time() / 1000;
+    ui_update_controls();
 }
 
 void
@@ -126,6 +133,7 @@ tuner_set_alignment()
     g_snprintf(buffer, sizeof(buffer), "V%ld", lround(gtk_adjustment_get_value(GTK_ADJUSTMENT(ui.adj_align))));
     tuner_write(tuner.thread, buffer);
     tuner.last_set_daa = g_get_real_time() / 1000;
+    ui_update_controls();
 }
 
 void
@@ -162,6 +170,7 @@ tuner_set_rotator(gpointer user_data)
     g_snprintf(buffer, sizeof(buffer), "C%d", state);
     tuner_write(tuner.thread, buffer);
     tuner.last_set_rotator = g_get_real_time() / 1000;
+    ui_update_controls();
 }
 
 void
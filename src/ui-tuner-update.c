@@ -1,4 +1,5 @@
 #include <math.h>
+#include <string.h>
 #include "ui.h"
 #include "tuner.h"
 #include "ui-tuner-set.h"
@@ -15,27 +16,122 @@
 #define PEAK_HOLD_SAMPLES 4
 #define UPDATE_TIMEOUT 2000
 
-static gboolean ui_update_af_check(GtkTreeModel*, GtkTreePath*, GtkTreeIter*, gpointer);
-static gboolean update_service(gpointer);
+/* Labels are rendered at most every UPDATE_FRAME ms */
+#define UPDATE_FRAME 50
+
+enum
+{
+    UPDATE_FREQ   = 1 << 0,
+    UPDATE_STEREO = 1 << 1,
+    UPDATE_RDS    = 1 << 2,
+    UPDATE_SIGNAL = 1 << 3,
+    UPDATE_LEVEL  = 1 << 4,
+    UPDATE_CCI    = 1 << 5,
+    UPDATE_ACI    = 1 << 6,
+    UPDATE_PI     = 1 << 7,
+    UPDATE_TP     = 1 << 8,
+    UPDATE_TA     = 1 << 9,
+    UPDATE_MS     = 1 << 10,
+    UPDATE_PTY    = 1 << 11,
+    UPDATE_PS     = 1 << 12,
+    UPDATE_RT0    = 1 << 13,
+    UPDATE_RT1    = 1 << 14
+};
+
+/* State changes only mark the widgets, one frame callback renders them */
+static guint update_dirty = 0;
+static guint update_frame_source = 0;
+
+/* One-shot timers of the control reconciliation and of the RDS reset */
+static guint service_source = 0;
+static guint rds_reset_source = 0;
+static gint rds_reset_timeout = 0;
+
+/* Peak values latched from the samples */
+static gfloat signal_peak = NAN;
+static gint cci_value = -1;
+static gint cci_peak = -1;
+static gint aci_value = -1;
+static gint aci_peak = -1;
+
+static void update_mark(guint);
+static gboolean update_frame(gpointer);
+static void render_freq();
+static void render_stereo_flag();
+static void render_rds_flag();
+static void render_signal();
+static void render_cci();
+static void render_aci();
+static void render_pi();
+static void render_tp();
+static void render_ta();
+static void render_ms();
+static void render_pty();
+static void render_ps();
+static void render_rt(gboolean);
+static gboolean service_pending(gint64, gint64, gint64*);
+static gboolean service_timeout(gpointer);
+static gboolean rds_reset_check(gpointer);
 static void service_update_rotator();
 
+static void
+update_mark(guint flags)
+{
+    update_dirty |= flags;
+    if(!update_frame_source)
+        update_frame_source = g_timeout_add(UPDATE_FRAME, update_frame, NULL);
+}
+
+static gboolean
+update_frame(gpointer user_data)
+{
+    guint dirty = update_dirty;
+
+    update_dirty = 0;
+    update_frame_source = 0;
+
+    if(dirty & UPDATE_FREQ)
+        render_freq();
+    if(dirty & UPDATE_STEREO)
+        render_stereo_flag();
+    if(dirty & UPDATE_RDS)
+        render_rds_flag();
+    if(dirty & UPDATE_SIGNAL)
+        render_signal();
+    if((dirty & UPDATE_LEVEL) && !isnan(tuner.signal))
+        stationlist_rcvlevel(lround(tuner.signal));
+    if(dirty & UPDATE_CCI)
+        render_cci();
+    if(dirty & UPDATE_ACI)
+        render_aci();
+    if(dirty & UPDATE_PI)
+        render_pi();
+    if(dirty & UPDATE_TP)
+        render_tp();
+    if(dirty & UPDATE_TA)
+        render_ta();
+    if(dirty & UPDATE_MS)
+        render_ms();
+    if(dirty & UPDATE_PTY)
+        render_pty();
+    if(dirty & UPDATE_PS)
+        render_ps();
+    if(dirty & UPDATE_RT0)
+        render_rt(FALSE);
+    if(dirty & UPDATE_RT1)
+        render_rt(TRUE);
+    return FALSE;
+}
+
 void
 ui_update_freq()
 {
-    static gint last_freq = G_MININT;
-    gchar buffer[8];
-
     if(conf.scan_mark_tuned)
         scan_force_redraw();
 
+    update_mark(UPDATE_FREQ);
     if(tuner_get_freq() > 0)
     {
-        if(last_freq != tuner_get_freq())
-        {
-            g_snprintf(buffer, sizeof(buffer), "%.3f", tuner_get_freq()/1000.0);
-            gtk_label_set_text(GTK_LABEL(ui.l_freq), buffer);
-        }
-
         if(conf.signal_mode == GRAPH_RESET)
             signal_clear();
 
@@ -48,11 +144,29 @@ ui_update_freq()
     }
     else
     {
-        gtk_label_set_text(GTK_LABEL(ui.l_freq), " ");
         signal_clear();
     }
+}
 
+static void
+render_freq()
+{
+    static gint last_freq = G_MININT;
+    gchar buffer[8];
+
+    if(last_freq == tuner_get_freq())
+        return;
     last_freq = tuner_get_freq();
+
+    if(last_freq > 0)
+    {
+        g_snprintf(buffer, sizeof(buffer), "%.3f", last_freq/1000.0);
+        gtk_label_set_text(GTK_LABEL(ui.l_freq), buffer);
+    }
+    else
+    {
+        gtk_label_set_text(GTK_LABEL(ui.l_freq), " ");
+    }
 }
 
 void
@@ -74,6 +188,12 @@ ui_update_mode()
 
 void
 ui_update_stereo_flag()
+{
+    update_mark(UPDATE_STEREO);
+}
+
+static void
+render_stereo_flag()
 {
     static gint flag = -1;
     static gint forced_mono = -1;
@@ -106,6 +226,12 @@ ui_update_stereo_flag()
 
 void
 ui_update_rds_flag()
+{
+    update_mark(UPDATE_RDS);
+}
+
+static void
+render_rds_flag()
 {
     static gint last_flag = -1;
 
@@ -136,58 +262,54 @@ ui_update_rds_flag()
 void
 ui_update_signal()
 {
-    static gfloat samples[PEAK_HOLD_SAMPLES] = {-1};
-    static gint pos = 0;
+    if(isnan(tuner.signal))
+    {
+        signal_clear();
+        signal_peak = NAN;
+        update_mark(UPDATE_SIGNAL);
+        return;
+    }
+
+    signal_push(tuner.signal,
+                signal_window_mean(&tuner.signal_stats.avg),
+                tuner.stereo,
+                tuner.rds,
+                tuner_get_freq());
+    scan_update_value(tuner_get_freq(), tuner.signal);
+    pattern_push(tuner.signal);
+
+    /* The peak hold window is reset on retune together with the maximum,
+     * the label shows its peak once per window */
+    if((tuner.signal_stats.samples - 1) % SIGNAL_STATS_PEAK_WINDOW == 0)
+        signal_peak = signal_window_max(&tuner.signal_stats.peak);
+
+    update_mark(UPDATE_SIGNAL | UPDATE_LEVEL);
+}
+
+static void
+render_signal()
+{
     static gint last_signal_max = G_MININT;
     static gint last_signal_curr = G_MININT;
-    gfloat peak = -1;
     gint signal_max;
     gint signal_curr;
     gchar *str;
-    gint i;
 
     if(isnan(tuner.signal))
     {
         gtk_label_set_text(GTK_LABEL(ui.l_sig), " ");
-        signal_clear();
-
-        if(conf.signal_display == SIGNAL_GRAPH)
-            gtk_widget_queue_draw(ui.graph);
-        else if(conf.signal_display == SIGNAL_BAR)
+        if(conf.signal_display == SIGNAL_BAR)
             gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(ui.p_signal), 0.0);
 
         last_signal_curr = G_MININT;
         return;
     }
 
-    signal_push(tuner.signal, tuner.stereo, tuner.rds, tuner_get_freq());
-    scan_update_value(tuner_get_freq(), tuner.signal);
-    pattern_push(tuner.signal);
-    stationlist_rcvlevel(lround(tuner.signal));
-
-    /* Add new sample to the buffer */
-    samples[pos] = tuner.signal;
+    signal_max = lround(signal_level(tuner.signal_stats.max));
+    signal_curr = lround(signal_level(signal_peak));
 
-    for(i=0; i<PEAK_HOLD_SAMPLES; i++)
-       if(samples[i] > peak)
-           peak = samples[i];
-
-    signal_max = lround(signal_level(tuner.signal_max));
-    signal_curr = lround(signal_level(peak));
-
-    if(signal_max < signal_curr)
+    if(last_signal_max != signal_max || last_signal_curr != signal_curr)
     {
-        /* Clear all buffered samples */
-        for(i=0; i<PEAK_HOLD_SAMPLES; i++)
-            samples[i] = -1;
-        pos = 0;
-        samples[pos] = tuner.signal;
-        signal_curr = lround(signal_level(tuner.signal));
-    }
-
-    if(pos == 0 &&
-       (last_signal_max != signal_max || last_signal_curr != signal_curr))
-     {
         last_signal_max = signal_max;
         last_signal_curr = signal_curr;
         if(tuner.mode == MODE_FM)
@@ -227,8 +349,6 @@ ui_update_signal()
         gtk_label_set_markup(GTK_LABEL(ui.l_sig), str);
         g_free(str);
     }
-    pos = (pos+1)%PEAK_HOLD_SAMPLES;
-
 
     if(conf.signal_display == SIGNAL_GRAPH)
         gtk_widget_queue_draw(ui.graph);
@@ -241,25 +361,15 @@ void
 ui_update_cci()
 {
     static gint samples[PEAK_HOLD_SAMPLES] = {-1};
-    static gint last_peak = G_MININT;
     static gint pos = 0;
     gint peak = -1;
     gint last_pos = pos;
-    gchar buff[10];
     gint i;
 
     /* Add new sample to the buffer */
     pos = (pos+1)%PEAK_HOLD_SAMPLES;
     samples[pos] = tuner.cci;
-
-    /* Change indicator value */
-    if(samples[last_pos] != samples[pos])
-    {
-        if(samples[pos] == -1)
-            gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(ui.p_cci), 0.0);
-        else
-            gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(ui.p_cci), samples[pos]/100.0);
-    }
+    cci_value = tuner.cci;
 
     /* No data? Clear all buffered samples */
     if(samples[pos] == -1)
@@ -272,16 +382,37 @@ ui_update_cci()
         for(i=0; i<PEAK_HOLD_SAMPLES; i++)
            if(samples[i] > peak)
                peak = samples[i];
+        cci_peak = peak;
+    }
 
-        if(last_peak != peak)
-        {
-            last_peak = peak;
-            if(samples[pos] < 0)
-                g_snprintf(buff, sizeof(buff), "CCI: ?");
-            else
-                g_snprintf(buff, sizeof(buff), "CCI: %d%%", peak);
-            gtk_progress_bar_set_text(GTK_PROGRESS_BAR(ui.p_cci), buff);
-        }
+    update_mark(UPDATE_CCI);
+}
+
+static void
+render_cci()
+{
+    static gint last_value = G_MININT;
+    static gint last_peak = G_MININT;
+    gchar buff[10];
+
+    /* Change indicator value */
+    if(last_value != cci_value)
+    {
+        last_value = cci_value;
+        if(last_value == -1)
+            gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(ui.p_cci), 0.0);
+        else
+            gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(ui.p_cci), last_value/100.0);
+    }
+
+    if(last_peak != cci_peak)
+    {
+        last_peak = cci_peak;
+        if(last_peak < 0)
+            g_snprintf(buff, sizeof(buff), "CCI: ?");
+        else
+            g_snprintf(buff, sizeof(buff), "CCI: %d%%", last_peak);
+        gtk_progress_bar_set_text(GTK_PROGRESS_BAR(ui.p_cci), buff);
     }
 }
 
@@ -289,25 +420,15 @@ void
 ui_update_aci()
 {
     static gint samples[PEAK_HOLD_SAMPLES] = {-1};
-    static gint last_peak = G_MININT;
     static gint pos = 0;
     gint peak = -1;
     gint last_pos = pos;
-    gchar buff[10];
     gint i;
 
     /* Add new sample to the buffer */
     pos = (pos+1)%PEAK_HOLD_SAMPLES;
     samples[pos] = tuner.aci;
-
-    /* Change indicator value */
-    if(samples[last_pos] != samples[pos])
-    {
-        if(samples[pos] == -1)
-            gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(ui.p_aci), 0.0);
-        else
-            gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(ui.p_aci), samples[pos]/100.0);
-    }
+    aci_value = tuner.aci;
 
     /* No data? Clear all buffered samples */
     if(samples[pos] == -1)
@@ -320,21 +441,48 @@ ui_update_aci()
         for(i=0; i<PEAK_HOLD_SAMPLES; i++)
            if(samples[i] > peak)
                peak = samples[i];
+        aci_peak = peak;
+    }
 
-        if(last_peak != peak)
-        {
-            last_peak = peak;
-            if(samples[pos] < 0)
-                g_snprintf(buff, sizeof(buff), "ACI: ?");
-            else
-                g_snprintf(buff, sizeof(buff), "ACI: %d%%", peak);
-            gtk_progress_bar_set_text(GTK_PROGRESS_BAR(ui.p_aci), buff);
-        }
+    update_mark(UPDATE_ACI);
+}
+
+static void
+render_aci()
+{
+    static gint last_value = G_MININT;
+    static gint last_peak = G_MININT;
+    gchar buff[10];
+
+    /* Change indicator value */
+    if(last_value != aci_value)
+    {
+        last_value = aci_value;
+        if(last_value == -1)
+            gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(ui.p_aci), 0.0);
+        else
+            gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(ui.p_aci), last_value/100.0);
+    }
+
+    if(last_peak != aci_peak)
+    {
+        last_peak = aci_peak;
+        if(last_peak < 0)
+            g_snprintf(buff, sizeof(buff), "ACI: ?");
+        else
+            g_snprintf(buff, sizeof(buff), "ACI: %d%%", last_peak);
+        gtk_progress_bar_set_text(GTK_PROGRESS_BAR(ui.p_aci), buff);
     }
 }
 
 void
 ui_update_pi()
+{
+    update_mark(UPDATE_PI);
+}
+
+static void
+render_pi()
 {
     static gint last_pi = G_MININT;
     static gint last_err_level = G_MININT;
@@ -366,8 +514,6 @@ ui_update_pi()
                        tuner.rds_pi);
 
         gtk_label_set_markup(GTK_LABEL(ui.l_pi), buffer);
-        stationlist_pi(tuner.rds_pi);
-        log_pi(tuner.rds_pi, tuner.rds_pi_err_level);
     }
     else
     {
@@ -377,6 +523,12 @@ ui_update_pi()
 
 void
 ui_update_tp()
+{
+    update_mark(UPDATE_TP);
+}
+
+static void
+render_tp()
 {
     static gint last_tp = G_MININT;
 
@@ -409,6 +561,12 @@ ui_update_tp()
 
 void
 ui_update_ta()
+{
+    update_mark(UPDATE_TA);
+}
+
+static void
+render_ta()
 {
     static gint last_ta = G_MININT;
 
@@ -441,6 +599,12 @@ ui_update_ta()
 
 void
 ui_update_ms()
+{
+    update_mark(UPDATE_MS);
+}
+
+static void
+render_ms()
 {
     static gint last_ms = G_MININT;
 
@@ -473,6 +637,12 @@ ui_update_ms()
 
 void
 ui_update_pty()
+{
+    update_mark(UPDATE_PTY);
+}
+
+static void
+render_pty()
 {
     static gint last_pty = G_MININT;
     const gchar *pty_text;
@@ -486,8 +656,6 @@ ui_update_pty()
     {
         pty_text = rds_utils_pty_to_string(conf.rds_pty_set, last_pty);
         gtk_label_set_text(GTK_LABEL(ui.l_pty), pty_text);
-        stationlist_pty(last_pty);
-        log_pty(pty_text);
     }
     else
     {
@@ -496,37 +664,36 @@ ui_update_pty()
 }
 
 void
-ui_update_ecc()
+ui_update_ps()
 {
-    static const gchar* const ecc_list[][16] = {
-        {"??", "DE", "DZ", "AD", "IL", "IT", "BE", "RU", "PS", "AL", "AT", "HU", "MT", "DE", "??", "EG" },
-        {"??", "GR", "CY", "SM", "CH", "JO", "FI", "LU", "BG", "DK", "GI", "IQ", "GB", "LY", "RO", "FR" },
-        {"??", "MA", "CZ", "PL", "VA", "SK", "SY", "TN", "??", "LI", "IS", "MC", "LT", "YU", "ES", "NO" },
-        {"??", "??", "IE", "TR", "MK", "??", "??", "??", "NL", "LV", "LB", "??", "HR", "??", "SE", "BY" },
-        {"??", "MD", "EE", "??", "??", "??", "UA", "??", "PT", "SI", "??", "??", "??", "??", "??", "BA" },
-    };
-
-    /* ECC is currently displayed only in StationList and logs */
-    if(tuner.rds_pi >= 0 &&
-       (tuner.rds_ecc >= 0xE0 && tuner.rds_ecc <= 0xE4))
-    {
-        stationlist_ecc(tuner.rds_ecc);
-        log_ecc(ecc_list[tuner.rds_ecc & 7][(guint16)tuner.rds_pi >> 12], tuner.rds_ecc);
-    }
+    update_mark(UPDATE_PS);
 }
 
-void
-ui_update_ps(gboolean new_data)
+static void
+render_ps()
 {
     static gint last_ps_avail = G_MININT;
+    static gchar last_ps[9];
+    static guchar last_ps_err[8];
+    static gboolean last_ps_cached;
+    static gboolean last_ps_progressive;
     guchar c[8];
     gint i;
     gchar *m;
 
+    /* The markup is built only when a character or its error level changes */
     if(last_ps_avail == (gint)tuner.rds_ps_avail &&
-       tuner.rds_ps_avail != TRUE)
+       (!tuner.rds_ps_avail ||
+        (!memcmp(last_ps, tuner.rds_ps, sizeof(last_ps)) &&
+         !memcmp(last_ps_err, tuner.rds_ps_err, sizeof(last_ps_err)) &&
+         last_ps_cached == tuner.rds_ps_cached &&
+         last_ps_progressive == conf.rds_ps_progressive)))
         return;
     last_ps_avail = tuner.rds_ps_avail;
+    memcpy(last_ps, tuner.rds_ps, sizeof(last_ps));
+    memcpy(last_ps_err, tuner.rds_ps_err, sizeof(last_ps_err));
+    last_ps_cached = tuner.rds_ps_cached;
+    last_ps_progressive = conf.rds_ps_progressive;
 
     if(!tuner.rds_ps_avail)
     {
@@ -557,26 +724,40 @@ ui_update_ps(gboolean new_data)
                                 c[6], c[6], c[6], tuner.rds_ps[6],
                                 c[7], c[7], c[7], tuner.rds_ps[7],
                                 conf.rds_ps_progressive?')':']');
-    gtk_label_set_markup(GTK_LABEL(ui.l_ps), m);
-    g_free(m);
 
-    if(new_data)
+    /* Name restored from the station database */
+    if(tuner.rds_ps_cached)
     {
-        stationlist_ps(tuner.rds_ps);
-        log_ps(tuner.rds_ps, tuner.rds_ps_err);
+        gchar *cached = g_strdup_printf("<i>%s</i>", m);
+        g_free(m);
+        m = cached;
     }
+
+    gtk_label_set_markup(GTK_LABEL(ui.l_ps), m);
+    g_free(m);
 }
 
 void
 ui_update_rt(gboolean flag)
+{
+    update_mark(flag ? UPDATE_RT1 : UPDATE_RT0);
+}
+
+static void
+render_rt(gboolean flag)
 {
     static gint last_rt_avail[2] = {G_MININT, G_MININT};
+    static gchar last_rt[2][65];
     gchar *m;
 
     if(!tuner.rds_rt_avail[flag] && !last_rt_avail[flag])
         return;
+    if(tuner.rds_rt_avail[flag] && last_rt_avail[flag] == TRUE &&
+       !strcmp(last_rt[flag], tuner.rds_rt[flag]))
+        return;
 
     last_rt_avail[flag] = tuner.rds_rt_avail[flag];
+    g_strlcpy(last_rt[flag], tuner.rds_rt[flag], sizeof(last_rt[flag]));
 
     if(!tuner.rds_rt_avail[flag])
     {
@@ -591,51 +772,25 @@ ui_update_rt(gboolean flag)
 
     gtk_label_set_markup(GTK_LABEL(ui.l_rt[flag]), m);
     g_free(m);
-    stationlist_rt(flag, tuner.rds_rt[flag]);
-    log_rt(flag, tuner.rds_rt[flag]);
 }
 
 void
 ui_update_af(gint af)
 {
+    /* The decoder reports each frequency once, so this is always a new row */
     GtkListStore *model = ui.af_model;
     GtkTreeIter iter;
+    gchar *af_new_freq;
 
-    // if new frequency is found on the AF list, ui_update_af_check() will set it to 0
-    gtk_tree_model_foreach(GTK_TREE_MODEL(model), (GtkTreeModelForeachFunc)ui_update_af_check, &af);
-    if(af)
+    if(!conf.horizontal_af)
     {
-        if(!conf.horizontal_af)
-        {
-            GtkAdjustment *adj = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(ui.af_treeview_scroll));
-            ui.autoscroll = (gtk_adjustment_get_value(adj) == gtk_adjustment_get_lower(adj));
-        }
-
-        gtk_list_store_append(model, &iter);
-        gchar *af_new_freq = g_strdup_printf("%.1f", ((87500+af*100)/1000.0));
-        gtk_list_store_set(model, &iter, 0, af, 1, af_new_freq, -1);
-        stationlist_af(af);
-        log_af(af_new_freq);
-        g_free(af_new_freq);
+        GtkAdjustment *adj = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(ui.af_treeview_scroll));
+        ui.autoscroll = (gtk_adjustment_get_value(adj) == gtk_adjustment_get_lower(adj));
     }
-}
 
-static gboolean
-ui_update_af_check(GtkTreeModel *model,
-                   GtkTreePath  *path,
-                   GtkTreeIter  *iter,
-                   gpointer      user_data)
-{
-    gint *new_freq = (gint*)user_data;
-    gint freq;
-    
-    gtk_tree_model_get(model, iter, 0, &freq, -1);
-    if(freq == *new_freq)
-    {
-        *new_freq = 0;
-        return TRUE; // frequency is already on the list, stop searching.
-    }
-    return FALSE;
+    af_new_freq = g_strdup_printf("%.1f", ((87500+af*100)/1000.0));
+    gtk_list_store_insert_with_values(model, &iter, -1, 0, af, 1, af_new_freq, -1);
+    g_free(af_new_freq);
 }
 
 void
@@ -733,28 +888,24 @@ ui_update_service()
     tuner.last_set_daa = 0;
     tuner.last_set_rotator = 0;
     tuner.last_set_pilot = 0;
-    g_timeout_add(100, (GSourceFunc)update_service, NULL);
 }
 
-static gboolean
-update_service(gpointer user_data)
+void
+ui_update_controls()
 {
+    /* Called on every control echo from the tuner and after the user
+     * changes a control; a mismatch within the grace period is looked
+     * at again once it expires, so nothing runs while idle */
     gint64 current_time = g_get_real_time() / 1000;
+    gint64 wait = G_MAXINT64;
     gint value;
 
     if(!tuner.thread)
-        return TRUE;
-
-    /* Reset RDS data after timeout */
-    if(conf.rds_reset && tuner.rds_reset_timer &&
-       (g_get_real_time() - tuner.rds_reset_timer) > (conf.rds_reset_timeout*1000000L))
-    {
-        tuner_clear_rds();
-    }
+        return;
 
     /* AGC */
     if(gtk_combo_box_get_active(GTK_COMBO_BOX(ui.c_agc)) != tuner.agc &&
-       (current_time - tuner.last_set_agc > UPDATE_TIMEOUT))
+       !service_pending(tuner.last_set_agc, current_time, &wait))
     {
         g_signal_handlers_block_by_func(G_OBJECT(ui.c_agc), GINT_TO_POINTER(tuner_set_agc), NULL);
         gtk_combo_box_set_active(GTK_COMBO_BOX(ui.c_agc), tuner.agc);
@@ -763,7 +914,7 @@ update_service(gpointer user_data)
 
     /* Deemphasis */
     if(gtk_combo_box_get_active(GTK_COMBO_BOX(ui.c_deemph)) != tuner.deemphasis &&
-       (current_time - tuner.last_set_deemph > UPDATE_TIMEOUT))
+       !service_pending(tuner.last_set_deemph, current_time, &wait))
     {
         g_signal_handlers_block_by_func(G_OBJECT(ui.c_deemph), GINT_TO_POINTER(tuner_set_deemphasis), NULL);
         gtk_combo_box_set_active(GTK_COMBO_BOX(ui.c_deemph), tuner.deemphasis);
@@ -772,7 +923,7 @@ update_service(gpointer user_data)
 
     /* Antenna */
     if(gtk_combo_box_get_active(GTK_COMBO_BOX(ui.c_ant)) != tuner.antenna &&
-       (current_time - tuner.last_set_ant > UPDATE_TIMEOUT))
+       !service_pending(tuner.last_set_ant, current_time, &wait))
     {
         g_signal_handlers_block_by_func(G_OBJECT(ui.c_ant), GINT_TO_POINTER(tuner_set_antenna), NULL);
         gtk_combo_box_set_active(GTK_COMBO_BOX(ui.c_ant), tuner.antenna);
@@ -782,7 +933,7 @@ update_service(gpointer user_data)
     /* Filters */
     value = tuner_filter_index(tuner.filter);
     if(gtk_combo_box_get_active(GTK_COMBO_BOX(ui.c_bw)) != value &&
-       (current_time - tuner.last_set_filter > UPDATE_TIMEOUT))
+       !service_pending(tuner.last_set_filter, current_time, &wait))
     {
         g_signal_handlers_block_by_func(G_OBJECT(ui.c_bw), GINT_TO_POINTER(tuner_set_bandwidth), NULL);
         gtk_combo_box_set_active(GTK_COMBO_BOX(ui.c_bw), value);
@@ -791,7 +942,7 @@ update_service(gpointer user_data)
 
     /* Volume */
     if(lround(gtk_scale_button_get_value(GTK_SCALE_BUTTON(ui.volume))) != tuner.volume &&
-       (current_time - tuner.last_set_volume > UPDATE_TIMEOUT))
+       !service_pending(tuner.last_set_volume, current_time, &wait))
     {
         g_signal_handlers_block_by_func(G_OBJECT(ui.volume), GINT_TO_POINTER(tuner_set_volume), NULL);
         gtk_scale_button_set_value(GTK_SCALE_BUTTON(ui.volume), tuner.volume);
@@ -800,7 +951,7 @@ update_service(gpointer user_data)
 
     /* Squelch */
     if(lround(gtk_scale_button_get_value(GTK_SCALE_BUTTON(ui.squelch))) != tuner.squelch &&
-       (current_time - tuner.last_set_squelch > UPDATE_TIMEOUT))
+       !service_pending(tuner.last_set_squelch, current_time, &wait))
     {
         g_signal_handlers_block_by_func(G_OBJECT(ui.squelch), GINT_TO_POINTER(tuner_set_squelch), NULL);
         gtk_scale_button_set_value(GTK_SCALE_BUTTON(ui.squelch), tuner.squelch);
@@ -810,7 +961,7 @@ update_service(gpointer user_data)
     /* Gain */
     if(((gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(ui.x_rf)) != tuner.rfgain) ||
        gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(ui.x_if)) != tuner.ifgain) &&
-       (current_time - tuner.last_set_gain > UPDATE_TIMEOUT))
+       !service_pending(tuner.last_set_gain, current_time, &wait))
     {
         gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(ui.x_rf), tuner.rfgain);
         gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(ui.x_if), tuner.ifgain);
@@ -818,7 +969,7 @@ update_service(gpointer user_data)
 
     /* DAA */
     if(lround(gtk_adjustment_get_value(GTK_ADJUSTMENT(ui.adj_align))) != tuner.daa &&
-       (current_time - tuner.last_set_daa > UPDATE_TIMEOUT))
+       !service_pending(tuner.last_set_daa, current_time, &wait))
     {
         g_signal_handlers_block_by_func(G_OBJECT(ui.adj_align), GINT_TO_POINTER(tuner_set_alignment), NULL);
         gtk_adjustment_set_value(GTK_ADJUSTMENT(ui.adj_align), tuner.daa);
@@ -826,12 +977,79 @@ update_service(gpointer user_data)
     }
 
     /* Rotator */
-    if(current_time - tuner.last_set_rotator > UPDATE_TIMEOUT)
+    if(!service_pending(tuner.last_set_rotator, current_time, &wait))
         service_update_rotator();
 
+    if(wait != G_MAXINT64)
+    {
+        if(service_source)
+            g_source_remove(service_source);
+        service_source = g_timeout_add(wait, service_timeout, NULL);
+    }
+}
+
+void
+ui_update_rds_reset()
+{
+    /* RDS data is cleared when no PI has been received for the timeout,
+     * the timer is armed once and checks the last PI when it fires */
+    if(rds_reset_source && rds_reset_timeout == conf.rds_reset_timeout)
+        return;
+
+    if(rds_reset_source)
+    {
+        g_source_remove(rds_reset_source);
+        rds_reset_source = 0;
+    }
+
+    if(!conf.rds_reset || !tuner.rds_reset_timer)
+        return;
+
+    rds_reset_timeout = conf.rds_reset_timeout;
+    rds_reset_source = g_timeout_add_seconds(rds_reset_timeout, rds_reset_check, NULL);
+}
+
+static gboolean
+service_pending(gint64  last_set,
+                gint64  current_time,
+                gint64 *wait)
+{
+    /* The widget is left alone for a while after the user has changed it */
+    gint64 remaining = last_set + UPDATE_TIMEOUT - current_time;
+
+    if(remaining < 0)
+        return FALSE;
+
+    *wait = MIN(*wait, remaining + 1);
     return TRUE;
 }
 
+static gboolean
+service_timeout(gpointer user_data)
+{
+    service_source = 0;
+    ui_update_controls();
+    return FALSE;
+}
+
+static gboolean
+rds_reset_check(gpointer user_data)
+{
+    gint64 elapsed;
+
+    rds_reset_source = 0;
+    if(!conf.rds_reset || !tuner.rds_reset_timer)
+        return FALSE;
+
+    elapsed = g_get_real_time() - tuner.rds_reset_timer;
+    if(elapsed > conf.rds_reset_timeout*1000000L)
+        tuner_clear_rds();
+    else
+        rds_reset_source = g_timeout_add((conf.rds_reset_timeout*1000000L - elapsed) / 1000 + 1,
+                                         rds_reset_check, NULL);
+    return FALSE;
+}
+
 static void
 service_update_rotator()
 {
@@ -18,8 +18,7 @@ void ui_update_tp();
 void ui_update_ta();
 void ui_update_ms();
 void ui_update_pty();
-void ui_update_ecc();
-void ui_update_ps(gboolean);
+void ui_update_ps();
 void ui_update_rt(gboolean);
 void ui_update_af(gint);
 
@@ -35,5 +34,7 @@ void ui_unauthorized();
 void ui_clear_af();
 
 void ui_update_service();
+void ui_update_controls();
+void ui_update_rds_reset();
 
 #endif
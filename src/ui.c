@@ -66,6 +66,8 @@ static void ui_sig_click(GtkWidget*, GdkEventButton*, gpointer);
 static gboolean ui_sig_click_key(GtkWidget*, GdkEventKey*, gpointer);
 static gboolean ui_cursor(GtkWidget *widget, GdkEvent  *event, gpointer cursor);
 static gboolean signal_tooltip(GtkWidget*, gint, gint, gboolean, GtkTooltip*, gpointer);
+static gboolean ps_tooltip(GtkWidget*, gint, gint, gboolean, GtkTooltip*, gpointer);
+static gboolean rds_tooltip(GtkWidget*, gint, gint, gboolean, GtkTooltip*, gpointer);
 static void ui_af_autoscroll(GtkWidget*, GtkAllocation*, gpointer);
 
 void
@@ -163,6 +165,8 @@ ui_init()
     gtk_misc_set_alignment(GTK_MISC(ui.l_ps), 0.0, 0.5);
     gtk_label_set_width_chars(GTK_LABEL(ui.l_ps), 10);
     gtk_container_add(GTK_CONTAINER(ui.event_ps), ui.l_ps);
+    gtk_widget_set_has_tooltip(ui.l_ps, TRUE);
+    g_signal_connect(ui.l_ps, "query-tooltip", G_CALLBACK(ps_tooltip), NULL);
     gtk_box_pack_start(GTK_BOX(ui.box_header), ui.event_ps, TRUE, FALSE, 0);
     gtk_event_box_set_visible_window(GTK_EVENT_BOX(ui.event_ps), FALSE);
     g_signal_connect(ui.event_ps, "button-press-event", G_CALLBACK(mouse_ps), NULL);
@@ -273,7 +277,8 @@ ui_init()
     gtk_widget_modify_font(ui.l_rds, font_status);
     gtk_widget_modify_fg(GTK_WIDGET(ui.l_rds), GTK_STATE_NORMAL, &ui.colors.insensitive);
     gtk_misc_set_alignment(GTK_MISC(ui.l_rds), 0, 0.5);
-    gtk_widget_set_tooltip_text(ui.l_rds, "RDS indicator");
+    gtk_widget_set_has_tooltip(ui.l_rds, TRUE);
+    g_signal_connect(ui.l_rds, "query-tooltip", G_CALLBACK(rds_tooltip), NULL);
     gtk_box_pack_start(GTK_BOX(ui.box_left_indicators), ui.l_rds, TRUE, TRUE,  3);
 
     ui.l_tp = gtk_label_new(NULL);
@@ -588,9 +593,6 @@ ui_init()
     ui.title_timeout = g_timeout_add(1000, (GSourceFunc)ui_update_title, NULL);
 
     signal_init();
-
-    if(conf.auto_connect)
-        connection_dialog(TRUE);
 }
 
 static void
@@ -603,6 +605,8 @@ ui_destroy()
         tuner_thread_cancel(tuner.thread);
         g_usleep(25000);
     }
+    if(tuner.diversity)
+        tuner_thread_cancel(tuner.diversity);
     gtk_main_quit();
 }
 
@@ -1133,26 +1137,126 @@ signal_tooltip(GtkWidget  *label,
     const gchar *unit = signal_unit();
     gchar *str;
 
-    if(!tuner.signal_samples)
+    if(!tuner.signal_stats.samples)
         return FALSE;
 
-    str = g_markup_printf_escaped("average signal: <b>%.1f%s%s</b> (%d samples)",
-                                  signal_level(tuner.signal_sum/(gdouble)tuner.signal_samples),
+    str = g_markup_printf_escaped("average signal: <b>%.1f%s%s</b> (%d samples)\n"
+                                  "deviation: <b>%.1f</b>, smoothed: <b>%.1f</b>",
+                                  signal_level(signal_stats_avg(&tuner.signal_stats)),
                                   (strlen(unit) ? " " : ""),
                                   unit,
-                                  tuner.signal_samples);
+                                  tuner.signal_stats.samples,
+                                  sqrt(signal_stats_var(&tuner.signal_stats)),
+                                  signal_level(signal_stats_smoothed(&tuner.signal_stats)));
 
     gtk_tooltip_set_markup(tooltip, str);
     g_free(str);
     return TRUE;
 }
 
+static gboolean
+ps_tooltip(GtkWidget  *label,
+           gint        x,
+           gint        y,
+           gboolean    keyboard_mode,
+           GtkTooltip *tooltip,
+           gpointer    user_data)
+{
+    static const gchar* const modes[RDS_PS_MODE_COUNT] = { "standard", "progressive", "voting" };
+    GString *str;
+    gint i, median;
+
+    str = g_string_new("median time to stable PS:");
+    for(i=0; i<RDS_PS_MODE_COUNT; i++)
+    {
+        median = rds_timing_median(&tuner.rds_timing, i);
+        if(median >= 0)
+            g_string_append_printf(str, "\n%s: <b>%.1f s</b> (%d tunes)",
+                                   modes[i], median / 1000.0,
+                                   rds_timing_count(&tuner.rds_timing, i));
+        else
+            g_string_append_printf(str, "\n%s: -", modes[i]);
+    }
+
+    gtk_tooltip_set_markup(tooltip, str->str);
+    g_string_free(str, TRUE);
+    return TRUE;
+}
+
+static gboolean
+rds_tooltip(GtkWidget  *label,
+            gint        x,
+            gint        y,
+            gboolean    keyboard_mode,
+            GtkTooltip *tooltip,
+            gpointer    user_data)
+{
+    static const gchar* const latencies[RDS_STATS_LATENCIES] = { "PI", "complete PS", "complete RT" };
+    const rds_stats_t *stats = &tuner.rds_stats;
+    rds_merge_stats_t merge;
+    gint64 now = g_get_monotonic_time();
+    GString *str;
+    gint i, n;
+
+    if(!stats->tuned)
+    {
+        gtk_tooltip_set_text(tooltip, "RDS indicator");
+        return TRUE;
+    }
+
+    str = g_string_new("RDS indicator");
+    g_string_append_printf(str, "\ngroups since tuning: <b>%u</b> (%.1f/s)",
+                           stats->groups, (stats->groups ? rds_stats_rate(stats, now) : 0.0));
+    g_string_append(str, "\nBLER:");
+    for(i=0; i<RDS_STATS_BLOCKS; i++)
+    {
+        if(stats->blocks[i])
+            g_string_append_printf(str, " %c <b>%.1f%%</b>", 'A'+i, rds_stats_bler(stats, i) * 100.0);
+        else
+            g_string_append_printf(str, " %c -", 'A'+i);
+    }
+
+    for(i=0; i<RDS_STATS_LATENCIES; i++)
+    {
+        if(stats->latency[i] >= 0)
+            g_string_append_printf(str, "\ntime to %s: <b>%.2f s</b>", latencies[i], stats->latency[i] / (gdouble)G_USEC_PER_SEC);
+        else
+            g_string_append_printf(str, "\ntime to %s: -", latencies[i]);
+    }
+
+    g_string_append(str, "\ngroup types:");
+    for(i=0, n=0; i<RDS_GROUP_COUNT; i++)
+    {
+        if(!stats->types[i])
+            continue;
+        g_string_append_printf(str, "%s%d%c: %u", (n++ % 6) ? ", " : "\n", i >> 1, (i & 1) ? 'B' : 'A', stats->types[i]);
+    }
+    if(!n)
+        g_string_append(str, " -");
+
+    if(tuner.rds_merge && rds_merge_active(tuner.rds_merge))
+    {
+        rds_merge_get_stats(tuner.rds_merge, &merge);
+        g_string_append_printf(str, "\ndiversity: <b>%.1f%%</b> merged, <b>%" G_GUINT64_FORMAT "</b> blocks improved",
+                               (merge.output ? merge.merged * 100.0 / merge.output : 0.0), merge.improved);
+        g_string_append_printf(str, "\nBLER B-D: primary <b>%.1f%%</b>, secondary <b>%.1f%%</b>, merged <b>%.1f%%</b>",
+                               (merge.groups[RDS_MERGE_PRIMARY] ? merge.bad[RDS_MERGE_PRIMARY] * 100.0 / (3 * merge.groups[RDS_MERGE_PRIMARY]) : 0.0),
+                               (merge.groups[RDS_MERGE_SECONDARY] ? merge.bad[RDS_MERGE_SECONDARY] * 100.0 / (3 * merge.groups[RDS_MERGE_SECONDARY]) : 0.0),
+                               (merge.output ? merge.output_bad * 100.0 / (3 * merge.output) : 0.0));
+    }
+
+    gtk_tooltip_set_markup(tooltip, str->str);
+    g_string_free(str, TRUE);
+    return TRUE;
+}
+
 void
 ui_toggle_ps_mode()
 {
     conf.rds_ps_progressive = !conf.rds_ps_progressive;
+    tuner_rds_configure();
     if(tuner.rds_ps_avail)
-        ui_update_ps(FALSE);
+        ui_update_ps();
 }
 
 void
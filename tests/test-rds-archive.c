@@ -0,0 +1,260 @@
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "rds-archive.h"
+
+#define TEST_GROUPS 2500
+#define TEST_START  G_GINT64_CONSTANT(1700000000000000)
+
+static rds_archive_group_t expected[TEST_GROUPS];
+
+static gchar*
+test_archive_path()
+{
+    gchar *path;
+    gint fd = g_file_open_tmp("xdr-rds-archive-XXXXXX", &path, NULL);
+
+    g_assert_cmpint(fd, >=, 0);
+    close(fd);
+    return path;
+}
+
+static void
+test_write(rds_archive_t *archive,
+           gint           count)
+{
+    /* A retune every 700 groups, a new PI 50 groups into every 100 */
+    rds_archive_group_t *group;
+    gint freq = 0, pi = -1, pi_err_level = 0;
+    gint i;
+
+    for(i=0; i<count; i++)
+    {
+        if(i % 700 == 0)
+        {
+            freq = 87500 + i / 700 * 100;
+            pi = -1;
+            pi_err_level = 0;
+            rds_archive_freq(archive, freq);
+        }
+        if(i % 100 == 50)
+        {
+            pi = 0x2000 + i / 100 % 7;
+            pi_err_level = i / 100 % 4;
+            rds_archive_pi(archive, pi, pi_err_level);
+        }
+
+        group = &expected[i];
+        group->time = TEST_START + i * G_GINT64_CONSTANT(87600) + i % 1000;
+        group->freq = freq;
+        group->pi = pi;
+        group->pi_err_level = pi_err_level;
+        group->data[0] = 0x0400 | i % 0x20;
+        group->data[1] = i * 0x9E37;
+        group->data[2] = ~i;
+        group->errors = i % 0x40;
+        rds_archive_group(archive, group->time, group->data, group->errors);
+
+        /* Read back with millisecond resolution */
+        group->time = group->time / 1000 * 1000;
+    }
+}
+
+static void
+test_check(const rds_archive_group_t *group,
+           gint                       i)
+{
+    g_assert_cmpint(group->time, ==, expected[i].time);
+    g_assert_cmpint(group->freq, ==, expected[i].freq);
+    g_assert_cmpint(group->pi, ==, expected[i].pi);
+    g_assert_cmpint(group->pi_err_level, ==, expected[i].pi_err_level);
+    g_assert_cmphex(group->data[0], ==, expected[i].data[0]);
+    g_assert_cmphex(group->data[1], ==, expected[i].data[1]);
+    g_assert_cmphex(group->data[2], ==, expected[i].data[2]);
+    g_assert_cmpuint(group->errors, ==, expected[i].errors);
+}
+
+static void
+test_read_all(rds_archive_reader_t *reader,
+              gint                  count)
+{
+    rds_archive_group_t group;
+    gint i;
+
+    g_assert_cmpuint(rds_archive_reader_count(reader), ==, count);
+    rds_archive_rewind(reader);
+    for(i=0; i<count; i++)
+    {
+        g_assert_true(rds_archive_next(reader, &group));
+        test_check(&group, i);
+    }
+    g_assert_false(rds_archive_next(reader, &group));
+}
+
+static void
+test_seek(rds_archive_reader_t *reader,
+          gint                  count)
+{
+    rds_archive_group_t group;
+    gint64 first, last;
+    gint i, j;
+
+    g_assert_true(rds_archive_reader_range(reader, &first, &last));
+    g_assert_cmpint(first, ==, expected[0].time);
+    g_assert_cmpint(last, ==, expected[count-1].time);
+
+    /* Exact times, times between groups and chunk boundaries */
+    for(i=0; i<count; i+=97)
+    {
+        g_assert_true(rds_archive_seek_time(reader, expected[i].time));
+        g_assert_true(rds_archive_next(reader, &group));
+        test_check(&group, i);
+
+        if(i + 1 < count)
+        {
+            g_assert_true(rds_archive_seek_time(reader, expected[i].time + 1000));
+            g_assert_true(rds_archive_next(reader, &group));
+            test_check(&group, i + 1);
+        }
+    }
+
+    g_assert_true(rds_archive_seek_time(reader, expected[RDS_ARCHIVE_CHUNK].time));
+    g_assert_true(rds_archive_next(reader, &group));
+    test_check(&group, RDS_ARCHIVE_CHUNK);
+    g_assert_true(rds_archive_next(reader, &group));
+    test_check(&group, RDS_ARCHIVE_CHUNK + 1);
+
+    g_assert_true(rds_archive_seek_time(reader, 0));
+    g_assert_true(rds_archive_next(reader, &group));
+    test_check(&group, 0);
+    g_assert_false(rds_archive_seek_time(reader, expected[count-1].time + 1000));
+
+    /* First group of every PI, across chunks */
+    for(i=50; i<count; i+=100)
+    {
+        for(j=0; j<i; j++)
+            if(expected[j].pi == expected[i].pi)
+                break;
+
+        g_assert_true(rds_archive_seek_pi(reader, expected[i].pi));
+        g_assert_true(rds_archive_next(reader, &group));
+        test_check(&group, j);
+    }
+    g_assert_false(rds_archive_seek_pi(reader, 0x3000));
+}
+
+static void
+test_round_trip()
+{
+    gchar *path = test_archive_path();
+    rds_archive_t *archive = rds_archive_new(path);
+    rds_archive_reader_t *reader;
+
+    g_assert_nonnull(archive);
+    test_write(archive, TEST_GROUPS);
+    rds_archive_close(archive);
+
+    reader = rds_archive_reader_open(path);
+    g_assert_nonnull(reader);
+    test_read_all(reader, TEST_GROUPS);
+    test_seek(reader, TEST_GROUPS);
+    rds_archive_reader_free(reader);
+
+    g_unlink(path);
+    g_free(path);
+}
+
+static void
+test_empty()
+{
+    gchar *path = test_archive_path();
+    rds_archive_t *archive = rds_archive_new(path);
+    rds_archive_reader_t *reader;
+    rds_archive_group_t group;
+    gint64 first, last;
+
+    g_assert_nonnull(archive);
+    rds_archive_freq(archive, 87500);
+    rds_archive_close(archive);
+
+    reader = rds_archive_reader_open(path);
+    g_assert_nonnull(reader);
+    g_assert_cmpuint(rds_archive_reader_count(reader), ==, 0);
+    g_assert_false(rds_archive_reader_range(reader, &first, &last));
+    g_assert_false(rds_archive_next(reader, &group));
+    g_assert_false(rds_archive_seek_time(reader, 0));
+    g_assert_false(rds_archive_seek_pi(reader, 0x2000));
+    rds_archive_reader_free(reader);
+
+    g_assert_true(g_file_set_contents(path, "XDRRDSX", -1, NULL));
+    g_assert_null(rds_archive_reader_open(path));
+
+    g_unlink(path);
+    g_free(path);
+}
+
+static rds_archive_reader_t*
+test_open_truncated(const gchar *path,
+                    const gchar *copy,
+                    gsize        cut)
+{
+    gchar *data;
+    gsize length;
+
+    g_assert_true(g_file_get_contents(path, &data, &length, NULL));
+    g_assert_cmpuint(length, >, cut);
+    g_assert_true(g_file_set_contents(copy, data, length - cut, NULL));
+    g_free(data);
+    return rds_archive_reader_open(copy);
+}
+
+static void
+test_truncated()
+{
+    gchar *path = test_archive_path();
+    gchar *copy = test_archive_path();
+    rds_archive_t *archive = rds_archive_new(path);
+    rds_archive_reader_t *reader;
+
+    /* Still recording: the complete chunks are on disk, without an index */
+    g_assert_nonnull(archive);
+    test_write(archive, TEST_GROUPS);
+
+    reader = test_open_truncated(path, copy, 0);
+    g_assert_nonnull(reader);
+    test_read_all(reader, 2 * RDS_ARCHIVE_CHUNK);
+    test_seek(reader, 2 * RDS_ARCHIVE_CHUNK);
+    rds_archive_reader_free(reader);
+
+    /* A partly written chunk is dropped */
+    reader = test_open_truncated(path, copy, 1);
+    g_assert_nonnull(reader);
+    test_read_all(reader, RDS_ARCHIVE_CHUNK);
+    rds_archive_reader_free(reader);
+
+    rds_archive_close(archive);
+
+    /* A damaged index falls back to the scan of all chunks */
+    reader = test_open_truncated(path, copy, 1);
+    g_assert_nonnull(reader);
+    test_read_all(reader, TEST_GROUPS);
+    test_seek(reader, TEST_GROUPS);
+    rds_archive_reader_free(reader);
+
+    g_unlink(copy);
+    g_free(copy);
+    g_unlink(path);
+    g_free(path);
+}
+
+gint
+main(gint   argc,
+     gchar *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func("/rds-archive/round-trip", test_round_trip);
+    g_test_add_func("/rds-archive/empty", test_empty);
+    g_test_add_func("/rds-archive/truncated", test_truncated);
+    return g_test_run();
+}
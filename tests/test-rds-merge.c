@@ -0,0 +1,282 @@
+#include <glib.h>
+#include <string.h>
+#include "rds-merge.h"
+
+#define TEST_TIME G_GINT64_CONSTANT(1000000000)
+
+/* Error levels of blocks B, C, D packed by two bits */
+#define TEST_ERRORS(b, c, d) ((b) | (c) << 2 | (d) << 4)
+
+static const guint16 data_a[3] = { 0x0408, 0x1234, 0x5678 };
+static const guint16 data_b[3] = { 0x2410, 0x4142, 0x4344 };
+
+static rds_merge_t*
+test_merge(gint freq)
+{
+    rds_merge_t *merge = rds_merge_new();
+
+    rds_merge_freq(merge, RDS_MERGE_PRIMARY, freq);
+    rds_merge_freq(merge, RDS_MERGE_SECONDARY, freq);
+    g_assert_true(rds_merge_active(merge) == (freq > 0));
+    return merge;
+}
+
+static void
+test_pop(rds_merge_t   *merge,
+         gint64         now,
+         gint64         time,
+         const guint16 *data,
+         guint          errors)
+{
+    rds_merge_group_t group;
+
+    g_assert_true(rds_merge_pop(merge, now, &group));
+    g_assert_cmpint(group.time, ==, time);
+    g_assert_cmphex(group.data[0], ==, data[0]);
+    g_assert_cmphex(group.data[1], ==, data[1]);
+    g_assert_cmphex(group.data[2], ==, data[2]);
+    g_assert_cmphex(group.errors, ==, errors);
+}
+
+static void
+test_empty(rds_merge_t *merge,
+           gint64       now)
+{
+    rds_merge_group_t group;
+
+    g_assert_false(rds_merge_pop(merge, now, &group));
+}
+
+static void
+test_single_tuner()
+{
+    rds_merge_t *merge = test_merge(0);
+    rds_merge_stats_t stats;
+
+    /* Detached or on other frequencies, the primary passes through */
+    rds_merge_freq(merge, RDS_MERGE_PRIMARY, 87500);
+    g_assert_false(rds_merge_active(merge));
+    rds_merge_group(merge, RDS_MERGE_PRIMARY, TEST_TIME, data_a, 0);
+    rds_merge_group(merge, RDS_MERGE_SECONDARY, TEST_TIME, data_b, 0);
+    test_pop(merge, TEST_TIME, TEST_TIME, data_a, 0);
+    test_empty(merge, TEST_TIME + RDS_MERGE_WINDOW * 10);
+
+    rds_merge_freq(merge, RDS_MERGE_SECONDARY, 98000);
+    g_assert_false(rds_merge_active(merge));
+    rds_merge_group(merge, RDS_MERGE_SECONDARY, TEST_TIME, data_b, 0);
+    rds_merge_group(merge, RDS_MERGE_PRIMARY, TEST_TIME + 1, data_a, 0);
+    test_pop(merge, TEST_TIME, TEST_TIME + 1, data_a, 0);
+    test_empty(merge, TEST_TIME + RDS_MERGE_WINDOW * 10);
+
+    rds_merge_get_stats(merge, &stats);
+    g_assert_cmpuint(stats.groups[RDS_MERGE_PRIMARY], ==, 0);
+    g_assert_cmpuint(stats.output, ==, 0);
+    rds_merge_free(merge);
+}
+
+static void
+test_window_edge(gint   first,
+                 gint64 delay)
+{
+    /* The copies are delay apart, the primary copy is always the base */
+    rds_merge_t *merge = test_merge(87500);
+    gint second = !first;
+    gint64 time[RDS_MERGE_SOURCES];
+    guint errors[RDS_MERGE_SOURCES];
+    guint16 data[RDS_MERGE_SOURCES][3];
+    rds_merge_stats_t stats;
+
+    time[first] = TEST_TIME;
+    time[second] = TEST_TIME + delay;
+    errors[RDS_MERGE_PRIMARY] = TEST_ERRORS(0, 3, 1);
+    errors[RDS_MERGE_SECONDARY] = TEST_ERRORS(1, 0, 3);
+    memcpy(data[RDS_MERGE_PRIMARY], data_a, sizeof(data_a));
+    memcpy(data[RDS_MERGE_SECONDARY], data_a, sizeof(data_a));
+    data[RDS_MERGE_PRIMARY][1] ^= 0x0100;
+    data[RDS_MERGE_SECONDARY][2] ^= 0x0001;
+
+    rds_merge_group(merge, first, time[first], data[first], errors[first]);
+    test_empty(merge, time[first]);
+    test_empty(merge, time[first] + RDS_MERGE_WINDOW);
+    rds_merge_group(merge, second, time[second], data[second], errors[second]);
+
+    rds_merge_get_stats(merge, &stats);
+    g_assert_cmpuint(stats.groups[RDS_MERGE_PRIMARY], ==, 1);
+    g_assert_cmpuint(stats.groups[RDS_MERGE_SECONDARY], ==, 1);
+    g_assert_cmpuint(stats.bad[RDS_MERGE_PRIMARY], ==, 1);
+    g_assert_cmpuint(stats.bad[RDS_MERGE_SECONDARY], ==, 1);
+
+    if(delay <= RDS_MERGE_WINDOW)
+    {
+        test_pop(merge, time[second], time[RDS_MERGE_PRIMARY], data_a, TEST_ERRORS(0, 0, 1));
+        test_empty(merge, time[second] + RDS_MERGE_WINDOW * 10);
+        rds_merge_get_stats(merge, &stats);
+        g_assert_cmpuint(stats.merged, ==, 1);
+        g_assert_cmpuint(stats.improved, ==, 1);
+        g_assert_cmpuint(stats.single[RDS_MERGE_PRIMARY], ==, 0);
+        g_assert_cmpuint(stats.single[RDS_MERGE_SECONDARY], ==, 0);
+        g_assert_cmpuint(stats.output, ==, 1);
+        g_assert_cmpuint(stats.output_bad, ==, 0);
+    }
+    else
+    {
+        /* Each copy waits for the whole window, then goes out alone */
+        test_empty(merge, time[first] + RDS_MERGE_WINDOW);
+        test_pop(merge, time[first] + RDS_MERGE_WINDOW + 1, time[first], data[first], errors[first]);
+        test_empty(merge, time[second] + RDS_MERGE_WINDOW);
+        test_pop(merge, time[second] + RDS_MERGE_WINDOW + 1, time[second], data[second], errors[second]);
+        test_empty(merge, time[second] + RDS_MERGE_WINDOW * 10);
+        rds_merge_get_stats(merge, &stats);
+        g_assert_cmpuint(stats.merged, ==, 0);
+        g_assert_cmpuint(stats.single[RDS_MERGE_PRIMARY], ==, 1);
+        g_assert_cmpuint(stats.single[RDS_MERGE_SECONDARY], ==, 1);
+        g_assert_cmpuint(stats.output, ==, 2);
+        g_assert_cmpuint(stats.output_bad, ==, 2);
+    }
+    rds_merge_free(merge);
+}
+
+static void
+test_window()
+{
+    gint first;
+
+    for(first=0; first<RDS_MERGE_SOURCES; first++)
+    {
+        test_window_edge(first, 0);
+        test_window_edge(first, RDS_MERGE_WINDOW);
+        test_window_edge(first, RDS_MERGE_WINDOW + 1);
+    }
+}
+
+static void
+test_match()
+{
+    rds_merge_t *merge = test_merge(87500);
+    rds_merge_group_t group;
+    guint16 data[3];
+
+    /* Reliable blocks that disagree are different groups */
+    memcpy(data, data_a, sizeof(data));
+    data[2] ^= 0x8000;
+    rds_merge_group(merge, RDS_MERGE_PRIMARY, TEST_TIME, data_a, 0);
+    rds_merge_group(merge, RDS_MERGE_SECONDARY, TEST_TIME, data, TEST_ERRORS(0, 0, 1));
+    test_empty(merge, TEST_TIME);
+
+    /* An older copy the secondary tuner missed goes out before the pair */
+    rds_merge_group(merge, RDS_MERGE_PRIMARY, TEST_TIME + 1000, data_b, TEST_ERRORS(3, 0, 0));
+    rds_merge_group(merge, RDS_MERGE_SECONDARY, TEST_TIME + 2000, data_b, 0);
+    test_pop(merge, TEST_TIME + 2000, TEST_TIME, data_a, 0);
+    test_pop(merge, TEST_TIME + 2000, TEST_TIME + 1000, data_b, 0);
+    test_empty(merge, TEST_TIME + 2000);
+    test_pop(merge, TEST_TIME + RDS_MERGE_WINDOW + 1, TEST_TIME, data, TEST_ERRORS(0, 0, 1));
+
+    /* No reliable block in common */
+    rds_merge_group(merge, RDS_MERGE_PRIMARY, TEST_TIME + 10000, data_a, TEST_ERRORS(2, 3, 3));
+    rds_merge_group(merge, RDS_MERGE_SECONDARY, TEST_TIME + 10000, data_a, TEST_ERRORS(0, 3, 2));
+    test_empty(merge, TEST_TIME + 10000);
+
+    /* A reliable PI that differs is another station */
+    rds_merge_pi(merge, RDS_MERGE_PRIMARY, 0x3201, 0);
+    rds_merge_pi(merge, RDS_MERGE_SECONDARY, 0x3202, 0);
+    rds_merge_group(merge, RDS_MERGE_PRIMARY, TEST_TIME + 20000, data_b, 0);
+    rds_merge_group(merge, RDS_MERGE_SECONDARY, TEST_TIME + 20000, data_b, 0);
+    test_pop(merge, TEST_TIME + RDS_MERGE_WINDOW * 10, TEST_TIME + 10000, data_a, TEST_ERRORS(2, 3, 3));
+    test_pop(merge, TEST_TIME + RDS_MERGE_WINDOW * 10, TEST_TIME + 10000, data_a, TEST_ERRORS(0, 3, 2));
+    test_pop(merge, TEST_TIME + RDS_MERGE_WINDOW * 10, TEST_TIME + 20000, data_b, 0);
+    test_pop(merge, TEST_TIME + RDS_MERGE_WINDOW * 10, TEST_TIME + 20000, data_b, 0);
+
+    /* The more reliable PI is kept */
+    rds_merge_pi(merge, RDS_MERGE_PRIMARY, 0x3201, 2);
+    rds_merge_pi(merge, RDS_MERGE_SECONDARY, 0x3202, 0);
+    rds_merge_group(merge, RDS_MERGE_PRIMARY, TEST_TIME + 30000, data_b, 0);
+    rds_merge_group(merge, RDS_MERGE_SECONDARY, TEST_TIME + 30000, data_b, 0);
+    g_assert_true(rds_merge_pop(merge, TEST_TIME + 30000, &group));
+    g_assert_cmphex(group.pi, ==, 0x3202);
+    g_assert_cmpint(group.pi_err_level, ==, 0);
+    test_empty(merge, TEST_TIME + RDS_MERGE_WINDOW * 10);
+    rds_merge_free(merge);
+}
+
+static void
+test_pending()
+{
+    rds_merge_t *merge = test_merge(87500);
+    rds_merge_stats_t stats;
+    guint16 data[3];
+    gint i;
+
+    /* The oldest copy is passed on when the queue is full */
+    memcpy(data, data_a, sizeof(data));
+    for(i=0; i<=RDS_MERGE_PENDING; i++)
+    {
+        data[2] = i;
+        rds_merge_group(merge, RDS_MERGE_PRIMARY, TEST_TIME + i, data, 0);
+    }
+    data[2] = 0;
+    test_pop(merge, TEST_TIME, TEST_TIME, data, 0);
+    test_empty(merge, TEST_TIME);
+
+    /* Pending primary copies are passed on when the secondary tuner retunes */
+    rds_merge_freq(merge, RDS_MERGE_SECONDARY, 98000);
+    g_assert_false(rds_merge_active(merge));
+    for(i=1; i<=RDS_MERGE_PENDING; i++)
+    {
+        data[2] = i;
+        test_pop(merge, TEST_TIME, TEST_TIME + i, data, 0);
+    }
+    test_empty(merge, TEST_TIME);
+
+    /* Secondary copies are dropped, a primary retune drops everything */
+    rds_merge_freq(merge, RDS_MERGE_SECONDARY, 87500);
+    g_assert_true(rds_merge_active(merge));
+    rds_merge_group(merge, RDS_MERGE_SECONDARY, TEST_TIME, data_a, 0);
+    rds_merge_freq(merge, RDS_MERGE_SECONDARY, 98000);
+    test_empty(merge, TEST_TIME + RDS_MERGE_WINDOW * 10);
+
+    rds_merge_freq(merge, RDS_MERGE_SECONDARY, 87500);
+    rds_merge_group(merge, RDS_MERGE_PRIMARY, TEST_TIME, data_a, 0);
+    rds_merge_freq(merge, RDS_MERGE_PRIMARY, 98000);
+    test_empty(merge, TEST_TIME + RDS_MERGE_WINDOW * 10);
+    rds_merge_get_stats(merge, &stats);
+    g_assert_cmpuint(stats.groups[RDS_MERGE_PRIMARY], ==, 0);
+    g_assert_cmpuint(stats.output, ==, 0);
+    rds_merge_free(merge);
+}
+
+static void
+test_output()
+{
+    rds_merge_t *merge = test_merge(0);
+    guint16 data[3];
+    gint i;
+
+    /* The oldest groups are lost when the reader falls behind */
+    rds_merge_freq(merge, RDS_MERGE_PRIMARY, 87500);
+    memcpy(data, data_a, sizeof(data));
+    for(i=0; i<RDS_MERGE_OUTPUT+5; i++)
+    {
+        data[2] = i;
+        rds_merge_group(merge, RDS_MERGE_PRIMARY, TEST_TIME + i, data, 0);
+    }
+    for(i=5; i<RDS_MERGE_OUTPUT+5; i++)
+    {
+        data[2] = i;
+        test_pop(merge, TEST_TIME, TEST_TIME + i, data, 0);
+    }
+    test_empty(merge, TEST_TIME);
+    rds_merge_free(merge);
+}
+
+gint
+main(gint   argc,
+     gchar *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func("/rds-merge/single-tuner", test_single_tuner);
+    g_test_add_func("/rds-merge/window", test_window);
+    g_test_add_func("/rds-merge/match", test_match);
+    g_test_add_func("/rds-merge/pending", test_pending);
+    g_test_add_func("/rds-merge/output", test_output);
+    return g_test_run();
+}
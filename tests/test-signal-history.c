@@ -0,0 +1,164 @@
+#include <glib.h>
+#include <math.h>
+#include "signal-history.h"
+
+#define TEST_SAMPLES 50000
+#define TEST_PIXELS  8192
+
+static gfloat values[TEST_SAMPLES];
+static gfloat avgs[TEST_SAMPLES];
+static signal_bucket_t out[TEST_PIXELS];
+
+static void
+test_push(signal_history_t *history,
+          guint64           from,
+          guint64           to)
+{
+    /* Gaps every 37 samples, a retune every 1234 */
+    guint64 i;
+
+    for(i=from; i<to; i++)
+    {
+        values[i] = (i % 37 == 5 ? NAN : g_test_rand_int_range(0, 800) / 8.0f);
+        avgs[i] = values[i] + 1.0f;
+        signal_history_push(history, values[i], avgs[i], i % 3 == 0, i % 5 == 0, 87500 + i / 1234 * 100);
+    }
+}
+
+static guint
+test_factor(guint zoom)
+{
+    guint factor = 1, i;
+
+    for(i=1; i<SIGNAL_HISTORY_LEVELS && zoom % (factor * SIGNAL_HISTORY_FACTOR) == 0; i++)
+        factor *= SIGNAL_HISTORY_FACTOR;
+    return factor;
+}
+
+static void
+test_pixel(const signal_bucket_t *bucket,
+           guint64                from,
+           guint64                to,
+           gboolean               raw)
+{
+    /* The pixel against the samples it covers */
+    gfloat min = NAN, max = NAN;
+    gdouble sum = 0.0;
+    guint samples = 0, stereo = 0, rds = 0;
+    gint freq = 87500 + from / 1234 * 100;
+    guint64 i;
+
+    for(i=from; i<to; i++)
+    {
+        if(87500 + i / 1234 * 100 != freq)
+            freq = 0;
+        if(isnan(values[i]))
+            continue;
+        min = (samples ? MIN(min, values[i]) : values[i]);
+        max = (samples ? MAX(max, values[i]) : values[i]);
+        sum += (raw ? avgs[i] : values[i]);
+        samples++;
+        stereo += (i % 3 == 0);
+        rds += (i % 5 == 0);
+    }
+
+    g_assert_cmpuint(bucket->samples, ==, samples);
+    g_assert_cmpuint(bucket->stereo, ==, stereo);
+    g_assert_cmpuint(bucket->rds, ==, rds);
+    g_assert_cmpint(bucket->freq, ==, freq);
+    if(!samples)
+    {
+        g_assert_true(isnan(bucket->min));
+        g_assert_true(isnan(bucket->max));
+        return;
+    }
+    g_assert_cmpfloat(bucket->min, ==, min);
+    g_assert_cmpfloat(bucket->max, ==, max);
+    g_assert_cmpfloat_with_epsilon(bucket->mean, sum / samples, 1e-3);
+}
+
+static void
+test_zoom(const signal_history_t *history,
+          guint64                 total,
+          guint                   zoom,
+          guint64                 since,
+          guint                   count)
+{
+    guint factor = test_factor(zoom);
+    guint64 first, pixels, pixel, start, end;
+    guint n, i;
+
+    pixels = signal_history_pixels(history, zoom);
+    g_assert_cmpuint(pixels, ==, (total ? (total - 1) / zoom + 1 : 0));
+
+    /* Oldest sample still kept at the level, aligned to its buckets */
+    first = (total / factor > SIGNAL_HISTORY_LEN ? total / factor - SIGNAL_HISTORY_LEN : 0) * factor;
+    first = MAX(first, since / factor * factor);
+
+    n = signal_history_read(history, zoom, since, out, count);
+    if(!total || first >= total)
+    {
+        g_assert_cmpuint(n, ==, 0);
+        return;
+    }
+    g_assert_cmpuint(n, ==, MIN(count, pixels - first / zoom));
+
+    for(i=0; i<n; i++)
+    {
+        pixel = pixels - 1 - i;
+        start = MAX(pixel * zoom, first);
+        end = MIN(pixel * zoom + zoom, total);
+        test_pixel(&out[i], start, end, factor == 1);
+    }
+}
+
+static void
+test_check(const signal_history_t *history,
+           guint64                 total)
+{
+    static const guint zooms[] = { 1, 3, 10, 20, 30, 100, 250, 1000, 2000, 5000 };
+    guint i;
+
+    for(i=0; i<G_N_ELEMENTS(zooms); i++)
+    {
+        test_zoom(history, total, zooms[i], 0, TEST_PIXELS);
+        test_zoom(history, total, zooms[i], 0, 5);
+        test_zoom(history, total, zooms[i], total / 2, TEST_PIXELS);
+        test_zoom(history, total, zooms[i], total / 2 + 7, TEST_PIXELS);
+        test_zoom(history, total, zooms[i], total, TEST_PIXELS);
+    }
+}
+
+static void
+test_alignment()
+{
+    static const guint64 steps[] = { 1, 9, 10, 11, 999, 1000, 1001, 4096, 4097, 12345, 40961, TEST_SAMPLES };
+    signal_history_t *history = signal_history_new();
+    guint64 total = 0;
+    guint i;
+
+    test_check(history, 0);
+    for(i=0; i<G_N_ELEMENTS(steps); i++)
+    {
+        test_push(history, total, steps[i]);
+        total = steps[i];
+        g_assert_cmpuint(history->samples, ==, total);
+        test_check(history, total);
+    }
+
+    signal_history_clear(history);
+    g_assert_cmpuint(signal_history_pixels(history, 1), ==, 0);
+    g_assert_cmpuint(signal_history_read(history, 1, 0, out, TEST_PIXELS), ==, 0);
+    test_push(history, 0, 15);
+    test_check(history, 15);
+    signal_history_free(history);
+}
+
+gint
+main(gint   argc,
+     gchar *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func("/signal-history/alignment", test_alignment);
+    return g_test_run();
+}
@@ -0,0 +1,170 @@
+#include <glib.h>
+#include <math.h>
+#include "signal-stats.h"
+
+#define TEST_SAMPLES 5000
+
+static gfloat samples[TEST_SAMPLES];
+
+static void
+test_samples(gint pattern)
+{
+    /* Random levels with plateaus, or long monotonic runs that
+     * keep the queues at their longest */
+    gint i;
+
+    for(i=0; i<TEST_SAMPLES; i++)
+    {
+        if(pattern == 0)
+            samples[i] = g_test_rand_int_range(0, 40) * 2.5f;
+        else if(pattern == 1)
+            samples[i] = (i / 200 % 2 ? i % 200 : 200 - i % 200) * 0.5f;
+        else
+            samples[i] = g_test_rand_double_range(-10.0, 100.0);
+    }
+}
+
+static void
+test_window_size(guint size)
+{
+    signal_window_t window;
+    gdouble sum, mean, var;
+    gfloat max, min;
+    guint i, j, first;
+    gint pattern;
+
+    for(pattern=0; pattern<3; pattern++)
+    {
+        test_samples(pattern);
+        signal_window_init(&window, size);
+        g_assert_cmpuint(signal_window_len(&window), ==, 0);
+        g_assert_true(isnan(signal_window_max(&window)));
+        g_assert_true(isnan(signal_window_min(&window)));
+        g_assert_true(isnan(signal_window_mean(&window)));
+
+        for(i=0; i<TEST_SAMPLES; i++)
+        {
+            signal_window_push(&window, samples[i]);
+
+            first = (i + 1 > size ? i + 1 - size : 0);
+            max = min = samples[first];
+            sum = 0.0;
+            for(j=first; j<=i; j++)
+            {
+                max = MAX(max, samples[j]);
+                min = MIN(min, samples[j]);
+                sum += samples[j];
+            }
+            mean = sum / (i + 1 - first);
+            var = 0.0;
+            for(j=first; j<=i; j++)
+                var += (samples[j] - mean) * (samples[j] - mean);
+            var /= (i + 1 - first);
+
+            g_assert_cmpuint(signal_window_len(&window), ==, i + 1 - first);
+            g_assert_cmpfloat(signal_window_max(&window), ==, max);
+            g_assert_cmpfloat(signal_window_min(&window), ==, min);
+            g_assert_cmpfloat_with_epsilon(signal_window_mean(&window), mean, 1e-6);
+            g_assert_cmpfloat_with_epsilon(signal_window_var(&window), var, 1e-6);
+        }
+    }
+
+    signal_window_reset(&window);
+    g_assert_cmpuint(signal_window_len(&window), ==, 0);
+    signal_window_push(&window, 1.0f);
+    g_assert_cmpfloat(signal_window_max(&window), ==, 1.0f);
+    g_assert_cmpfloat(signal_window_min(&window), ==, 1.0f);
+}
+
+static void
+test_window()
+{
+    static const guint sizes[] = { 1, 2, 3, 4, 7, 16, SIGNAL_WINDOW_MAX };
+    signal_window_t window;
+    guint i;
+
+    for(i=0; i<G_N_ELEMENTS(sizes); i++)
+        test_window_size(sizes[i]);
+
+    signal_window_init(&window, 0);
+    g_assert_cmpuint(window.size, ==, 1);
+    signal_window_init(&window, SIGNAL_WINDOW_MAX + 1);
+    g_assert_cmpuint(window.size, ==, SIGNAL_WINDOW_MAX);
+}
+
+static void
+test_welford()
+{
+    signal_stats_t stats;
+    gdouble sum, mean, var, smoothed;
+    gfloat max, peak;
+    gint i, j;
+
+    signal_stats_reset(&stats);
+    g_assert_true(isnan(signal_stats_avg(&stats)));
+    g_assert_true(isnan(signal_stats_var(&stats)));
+    g_assert_true(isnan(signal_stats_smoothed(&stats)));
+
+    /* A large offset with a small spread, where the sum of squares fails */
+    for(i=0; i<TEST_SAMPLES; i++)
+        samples[i] = 10000.0f + g_test_rand_int_range(0, 64) / 64.0f;
+
+    max = samples[0];
+    smoothed = samples[0];
+    for(i=0; i<TEST_SAMPLES; i++)
+    {
+        signal_stats_add(&stats, samples[i]);
+        max = MAX(max, samples[i]);
+        if(i)
+            smoothed += SIGNAL_STATS_SMOOTHING * (samples[i] - smoothed);
+
+        if(i % 97 && i != TEST_SAMPLES - 1)
+            continue;
+
+        sum = 0.0;
+        for(j=0; j<=i; j++)
+            sum += samples[j];
+        mean = sum / (i + 1);
+        var = 0.0;
+        for(j=0; j<=i; j++)
+            var += (samples[j] - mean) * (samples[j] - mean);
+        var /= (i + 1);
+
+        g_assert_cmpfloat(stats.max, ==, max);
+        g_assert_cmpfloat_with_epsilon(signal_stats_avg(&stats), mean, 1e-6);
+        g_assert_cmpfloat_with_epsilon(signal_stats_var(&stats), var, 1e-9);
+        g_assert_cmpfloat_with_epsilon(signal_stats_smoothed(&stats), smoothed, 1e-6);
+
+        peak = samples[i];
+        for(j=MAX(i-SIGNAL_STATS_PEAK_WINDOW+1, 0); j<i; j++)
+            peak = MAX(peak, samples[j]);
+        g_assert_cmpfloat(signal_window_max(&stats.peak), ==, peak);
+    }
+
+    signal_stats_add(&stats, 20000.0f);
+    g_assert_cmpfloat(signal_window_max(&stats.peak), ==, 20000.0f);
+    for(i=1; i<SIGNAL_STATS_PEAK_WINDOW; i++)
+        signal_stats_add(&stats, 0.0f);
+    g_assert_cmpfloat(signal_window_max(&stats.peak), ==, 20000.0f);
+    signal_stats_add(&stats, 0.0f);
+    g_assert_cmpfloat(signal_window_max(&stats.peak), ==, 0.0f);
+    g_assert_cmpfloat(stats.max, ==, 20000.0f);
+
+    signal_stats_reset(&stats);
+    g_assert_cmpuint(stats.samples, ==, 0);
+    g_assert_true(isnan(stats.max));
+    signal_stats_add(&stats, -5.0f);
+    g_assert_cmpfloat(signal_stats_avg(&stats), ==, -5.0);
+    g_assert_cmpfloat(signal_stats_var(&stats), ==, 0.0);
+    g_assert_cmpfloat(signal_stats_smoothed(&stats), ==, -5.0);
+}
+
+gint
+main(gint   argc,
+     gchar *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func("/signal-stats/window", test_window);
+    g_test_add_func("/signal-stats/welford", test_welford);
+    return g_test_run();
+}
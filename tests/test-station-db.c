@@ -0,0 +1,192 @@
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef G_OS_UNIX
+#include <signal.h>
+#include <sys/resource.h>
+#endif
+#include "station-db.h"
+
+/* Fills a table of 4096 slots to just below its 7/10 load limit */
+#define TEST_FILL 2867
+
+static gchar*
+test_db_path()
+{
+    gchar *path;
+    gint fd = g_file_open_tmp("xdr-station-db-XXXXXX", &path, NULL);
+
+    g_assert_cmpint(fd, >=, 0);
+    close(fd);
+    return path;
+}
+
+static void
+test_fill(station_db_t *db,
+          gint          from,
+          gint          to)
+{
+    station_db_entry_t *entry;
+    gint i;
+
+    for(i=from; i<to; i++)
+    {
+        entry = station_db_insert(db, 0x1000 + i, 87500 + i % 205 * 100);
+        g_assert_nonnull(entry);
+        entry->pty = i % 32;
+    }
+}
+
+static void
+test_check(const station_db_t *db,
+           gint                count)
+{
+    const station_db_entry_t *entry;
+    gint i;
+
+    g_assert_cmpuint(station_db_count(db), ==, count);
+    for(i=0; i<count; i++)
+    {
+        entry = station_db_lookup(db, 0x1000 + i, 87500 + i % 205 * 100);
+        g_assert_nonnull(entry);
+        g_assert_cmpint(entry->pi, ==, 0x1000 + i);
+        g_assert_cmpint(entry->pty, ==, i % 32);
+    }
+    g_assert_null(station_db_lookup(db, 0x1000 + count, 87500 + count % 205 * 100));
+}
+
+static void
+test_insert()
+{
+    gchar *path = test_db_path();
+    station_db_t *db = station_db_open(path);
+    station_db_entry_t *entry;
+
+    g_assert_nonnull(db);
+    g_assert_cmpuint(station_db_count(db), ==, 0);
+    g_assert_null(station_db_insert(db, 0x3201, 0));
+    g_assert_null(station_db_insert(db, 0x3201, -1));
+
+    entry = station_db_insert(db, 0x3201, 98000);
+    g_assert_nonnull(entry);
+    g_assert_cmpint(entry->pty, ==, 0xFF);
+    entry->pty = 10;
+
+    /* The same key is found again, not inserted twice */
+    g_assert_true(station_db_insert(db, 0x3201, 98000) == entry);
+    g_assert_cmpuint(station_db_count(db), ==, 1);
+    g_assert_null(station_db_lookup(db, 0x3201, 98100));
+    g_assert_null(station_db_lookup(db, 0x3202, 98000));
+    station_db_close(db);
+
+    db = station_db_open(path);
+    g_assert_nonnull(db);
+    g_assert_cmpuint(station_db_count(db), ==, 1);
+    entry = (station_db_entry_t*)station_db_lookup(db, 0x3201, 98000);
+    g_assert_nonnull(entry);
+    g_assert_cmpint(entry->pty, ==, 10);
+    station_db_close(db);
+
+    g_unlink(path);
+    g_free(path);
+}
+
+static void
+test_grow()
+{
+    gchar *path = test_db_path();
+    station_db_t *db = station_db_open(path);
+
+    g_assert_nonnull(db);
+    test_fill(db, 0, TEST_FILL * 2);
+    test_check(db, TEST_FILL * 2);
+    station_db_close(db);
+
+    /* The grown table is valid on disk */
+    db = station_db_open(path);
+    g_assert_nonnull(db);
+    test_check(db, TEST_FILL * 2);
+    station_db_close(db);
+
+    g_unlink(path);
+    g_free(path);
+}
+
+static void
+test_damaged()
+{
+    gchar *path = test_db_path();
+    station_db_t *db;
+
+    g_assert_true(g_file_set_contents(path, "XDRSTDB1 but not a table", -1, NULL));
+    db = station_db_open(path);
+    g_assert_nonnull(db);
+    g_assert_cmpuint(station_db_count(db), ==, 0);
+    test_fill(db, 0, 16);
+    test_check(db, 16);
+    station_db_close(db);
+
+    g_unlink(path);
+    g_free(path);
+}
+
+#ifdef G_OS_UNIX
+static void
+test_rollback()
+{
+    gchar *path = test_db_path();
+    station_db_t *db = station_db_open(path);
+    struct rlimit saved, limit;
+    off_t size;
+    gint fd;
+
+    g_assert_nonnull(db);
+    test_fill(db, 0, TEST_FILL);
+    test_check(db, TEST_FILL);
+
+    /* Keep the file from growing, so the doubled table cannot be mapped */
+    fd = g_open(path, O_RDONLY, 0);
+    g_assert_cmpint(fd, >=, 0);
+    size = lseek(fd, 0, SEEK_END);
+    close(fd);
+    g_assert_cmpint(getrlimit(RLIMIT_FSIZE, &saved), ==, 0);
+    limit = saved;
+    limit.rlim_cur = size;
+    signal(SIGXFSZ, SIG_IGN);
+    g_assert_cmpint(setrlimit(RLIMIT_FSIZE, &limit), ==, 0);
+
+    g_assert_null(station_db_insert(db, 0x1000 + TEST_FILL, 87500 + TEST_FILL % 205 * 100));
+    test_check(db, TEST_FILL);
+
+    g_assert_cmpint(setrlimit(RLIMIT_FSIZE, &saved), ==, 0);
+    signal(SIGXFSZ, SIG_DFL);
+
+    /* With room again, the same insert grows the table */
+    test_fill(db, TEST_FILL, TEST_FILL + 1);
+    test_check(db, TEST_FILL + 1);
+    station_db_close(db);
+
+    db = station_db_open(path);
+    g_assert_nonnull(db);
+    test_check(db, TEST_FILL + 1);
+    station_db_close(db);
+
+    g_unlink(path);
+    g_free(path);
+}
+#endif
+
+gint
+main(gint   argc,
+     gchar *argv[])
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_add_func("/station-db/insert", test_insert);
+    g_test_add_func("/station-db/grow", test_grow);
+    g_test_add_func("/station-db/damaged", test_damaged);
+#ifdef G_OS_UNIX
+    g_test_add_func("/station-db/rollback", test_rollback);
+#endif
+    return g_test_run();
+}
@@ -0,0 +1,111 @@
+#include <glib.h>
+#include <stdlib.h>
+#include "tuner-parse.h"
+#include "tuner-queue.h"
+#include "tuner-scan.h"
+
+#define BENCH_DEFAULT_ITERATIONS 200
+
+/* Typical traffic of a tuner streaming signal and RDS */
+static const gchar *bench_sample[] =
+{
+    "T87500",
+    "M0",
+    "Y75",
+    "F-1",
+    "Z0",
+    "G00",
+    "Ss45.23,0,1",
+    "Ss45.51,0,1",
+    "P3201",
+    "R2008303A205200",
+    "Ss45.80,2,1",
+    "P3201?",
+    "R0408E0CD420000",
+    "Sm12.05,14,7",
+    "N12",
+    "U87500=12.5,87600=14.0,87700=33.2,87800=41.0,87900=8.5,88000=10.5",
+    "!",
+    "o2,1",
+    /* Truncated lines, as seen after a serial glitch */
+    "R0408E0CD42",
+    "Ss",
+    NULL
+};
+
+static gchar**
+bench_load(const gchar *path)
+{
+    gchar *contents;
+    gchar **lines;
+    GError *error = NULL;
+
+    if(!g_file_get_contents(path, &contents, NULL, &error))
+    {
+        g_printerr("%s\n", error->message);
+        g_error_free(error);
+        return NULL;
+    }
+
+    lines = g_strsplit_set(contents, "\r\n", -1);
+    g_free(contents);
+    return lines;
+}
+
+static void
+bench_drain(tuner_queue_t *queue)
+{
+    tuner_event_t event;
+
+    tuner_queue_disarm(queue);
+    while(tuner_queue_pop(queue, &event))
+        if(event.type == TUNER_EVENT_SCAN)
+            tuner_scan_free(event.data.ptr);
+}
+
+gint
+main(gint   argc,
+     gchar *argv[])
+{
+    tuner_queue_t *queue;
+    tuner_parser_t parser;
+    gchar **lines = NULL;
+    const gchar **input;
+    gint iterations = BENCH_DEFAULT_ITERATIONS;
+    gint64 start, elapsed;
+    gint i, j;
+
+    if(argc > 1 && !(lines = bench_load(argv[1])))
+        return EXIT_FAILURE;
+    if(argc > 2)
+        iterations = MAX(atoi(argv[2]), 1);
+
+    input = (lines ? (const gchar**)lines : bench_sample);
+    queue = tuner_queue_new(NULL, NULL);
+    tuner_parser_init(&parser, queue);
+
+    start = g_get_monotonic_time();
+    for(i=0; i<iterations; i++)
+    {
+        for(j=0; input[j]; j++)
+        {
+            if(!input[j][0])
+                continue;
+            tuner_parse(&parser, input[j]);
+            /* Keep the ring from overflowing, the consumer is free */
+            if(tuner_queue_depth(queue) > TUNER_QUEUE_SIZE/2)
+                bench_drain(queue);
+        }
+    }
+    bench_drain(queue);
+    elapsed = MAX(g_get_monotonic_time() - start, 1);
+
+    g_print("lines:   %u (%u invalid)\n", parser.lines, parser.invalid);
+    g_print("time:    %.3f ms\n", elapsed / 1000.0);
+    g_print("rate:    %.0f lines/s\n", parser.lines / (elapsed / 1000000.0));
+    g_print("latency: %.1f ns/line\n", elapsed * 1000.0 / MAX(parser.lines, 1));
+
+    tuner_queue_free(queue);
+    g_strfreev(lines);
+    return EXIT_SUCCESS;
+}
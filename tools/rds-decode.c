@@ -0,0 +1,248 @@
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "rds-archive.h"
+#include "rds-decoder.h"
+
+/* Decodes archived RDS groups again with the given error correction,
+ * one file per worker thread, and prints PI, PS and RT timelines */
+
+typedef struct decode_job
+{
+    const gchar *path;
+    const rds_decoder_config_t *config;
+    GString *output;
+    gboolean failed;
+    guint64 groups;
+
+    /* Decoding state */
+    const rds_archive_group_t *group;
+    gchar ps[RDS_PS_LEN+1];
+    gchar rt[2][RDS_RT_LEN+1];
+} decode_job_t;
+
+static void
+decode_usage(const gchar *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-e info,data] [-r info,data] [-p] [-v] [-j jobs] archive...\n"
+            "  -e  PS error correction of the group type and of the data (default 0,0)\n"
+            "  -r  RT error correction of the group type and of the data (default 0,0)\n"
+            "      0 - no errors, 1 - up to 2 bits corrected, 2 - up to 5 bits corrected\n"
+            "  -p  progressive PS\n"
+            "  -v  PS and RT character voting\n"
+            "  -j  number of files decoded in parallel (default: number of CPUs)\n",
+            name);
+}
+
+static gboolean
+decode_parse_levels(const gchar *text,
+                    gint        *info,
+                    gint        *data)
+{
+    gchar *end;
+
+    *info = strtol(text, &end, 10);
+    if(*end != ',')
+        return FALSE;
+    *data = strtol(end + 1, &end, 10);
+    if(*end || *info < 0 || *info > 2 || *data < 0 || *data > 2)
+        return FALSE;
+    return TRUE;
+}
+
+static void
+decode_line(decode_job_t *job,
+            const gchar  *type,
+            const gchar  *value)
+{
+    const rds_archive_group_t *group = job->group;
+    GDateTime *date = g_date_time_new_from_unix_local(group->time / G_USEC_PER_SEC);
+
+    g_string_append_printf(job->output, "%04d-%02d-%02d %02d:%02d:%02d.%03d\t%d\t%s\t%s\n",
+                           g_date_time_get_year(date), g_date_time_get_month(date), g_date_time_get_day_of_month(date),
+                           g_date_time_get_hour(date), g_date_time_get_minute(date), g_date_time_get_second(date),
+                           (gint)(group->time % G_USEC_PER_SEC / 1000),
+                           group->freq, type, value);
+    g_date_time_unref(date);
+}
+
+static void
+decode_event(const rds_decoder_t *decoder,
+             const rds_event_t   *event,
+             gpointer             user_data)
+{
+    /* Only complete texts go to the timeline, each time they change */
+    decode_job_t *job = (decode_job_t*)user_data;
+    gchar pi[5];
+    gint flag;
+
+    switch(event->type)
+    {
+    case RDS_EVENT_PI:
+        g_snprintf(pi, sizeof(pi), "%04X", decoder->pi);
+        decode_line(job, "PI", pi);
+        job->ps[0] = 0;
+        job->rt[0][0] = job->rt[1][0] = 0;
+        break;
+    case RDS_EVENT_PS:
+        if(rds_decoder_ps_complete(decoder) &&
+           strcmp(job->ps, decoder->ps))
+        {
+            g_strlcpy(job->ps, decoder->ps, sizeof(job->ps));
+            decode_line(job, "PS", job->ps);
+        }
+        break;
+    case RDS_EVENT_RT:
+        flag = event->rt.flag;
+        if(rds_decoder_rt_complete(decoder, flag) &&
+           strcmp(job->rt[flag], decoder->rt[flag]))
+        {
+            g_strlcpy(job->rt[flag], decoder->rt[flag], sizeof(job->rt[flag]));
+            decode_line(job, (flag ? "RT1" : "RT0"), job->rt[flag]);
+        }
+        break;
+    }
+}
+
+static void
+decode_file(gpointer data,
+            gpointer user_data)
+{
+    decode_job_t *job = (decode_job_t*)data;
+    rds_archive_reader_t *reader = rds_archive_reader_open(job->path);
+    rds_decoder_t decoder;
+    rds_archive_group_t group;
+    gint freq = -1, pi = -1, pi_err_level = -1;
+
+    if(!reader)
+    {
+        job->failed = TRUE;
+        return;
+    }
+
+    rds_decoder_init(&decoder);
+    decoder.config = *job->config;
+    rds_decoder_subscribe(&decoder,
+                          RDS_EVENT_MASK(RDS_EVENT_PI) | RDS_EVENT_MASK(RDS_EVENT_PS) | RDS_EVENT_MASK(RDS_EVENT_RT),
+                          decode_event, job);
+
+    job->group = &group;
+    while(rds_archive_next(reader, &group))
+    {
+        /* Retuning starts the decoding over, like in the client */
+        if(group.freq != freq)
+        {
+            freq = group.freq;
+            pi = pi_err_level = -1;
+            rds_decoder_reset(&decoder);
+            job->ps[0] = 0;
+            job->rt[0][0] = job->rt[1][0] = 0;
+        }
+
+        if(group.pi >= 0 &&
+           (group.pi != pi || group.pi_err_level != pi_err_level))
+        {
+            pi = group.pi;
+            pi_err_level = group.pi_err_level;
+            rds_decoder_pi(&decoder, pi, pi_err_level);
+        }
+
+        rds_decoder_group(&decoder, group.data, group.errors);
+        job->groups++;
+    }
+
+    rds_archive_reader_free(reader);
+}
+
+gint
+main(gint   argc,
+     gchar *argv[])
+{
+    rds_decoder_config_t config;
+    decode_job_t *jobs;
+    GThreadPool *pool;
+    gint count, threads = g_get_num_processors();
+    guint64 groups = 0;
+    gint64 start, elapsed;
+    gint ret = EXIT_SUCCESS;
+    gint c, i;
+
+    memset(&config, 0, sizeof(config));
+    while((c = getopt(argc, argv, "e:r:pvj:h")) != -1)
+    {
+        switch(c)
+        {
+        case 'e':
+            if(!decode_parse_levels(optarg, &config.ps_info_error, &config.ps_data_error))
+            {
+                decode_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'r':
+            if(!decode_parse_levels(optarg, &config.rt_info_error, &config.rt_data_error))
+            {
+                decode_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'p':
+            config.ps_progressive = TRUE;
+            break;
+        case 'v':
+            config.ps_voting = TRUE;
+            config.rt_voting = TRUE;
+            break;
+        case 'j':
+            threads = MAX(atoi(optarg), 1);
+            break;
+        default:
+            decode_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    count = argc - optind;
+    if(count <= 0)
+    {
+        decode_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    jobs = g_new0(decode_job_t, count);
+    start = g_get_monotonic_time();
+    pool = g_thread_pool_new(decode_file, NULL, MIN(threads, count), TRUE, NULL);
+    for(i=0; i<count; i++)
+    {
+        jobs[i].path = argv[optind + i];
+        jobs[i].config = &config;
+        jobs[i].output = g_string_new(NULL);
+        g_thread_pool_push(pool, &jobs[i], NULL);
+    }
+    g_thread_pool_free(pool, FALSE, TRUE);
+    elapsed = MAX(g_get_monotonic_time() - start, 1);
+
+    /* Timelines are printed in the order of the arguments */
+    for(i=0; i<count; i++)
+    {
+        if(jobs[i].failed)
+        {
+            fprintf(stderr, "%s: not an RDS archive\n", jobs[i].path);
+            ret = EXIT_FAILURE;
+        }
+        else
+        {
+            printf("# %s\n%s", jobs[i].path, jobs[i].output->str);
+        }
+        groups += jobs[i].groups;
+        g_string_free(jobs[i].output, TRUE);
+    }
+
+    fprintf(stderr, "%" G_GUINT64_FORMAT " groups in %.3f s (%.0f groups/s)\n",
+            groups, elapsed / 1000000.0, groups / (elapsed / 1000000.0));
+    g_free(jobs);
+    return ret;
+}
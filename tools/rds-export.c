@@ -0,0 +1,229 @@
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "rds-archive.h"
+
+/* Exports archived RDS groups as text: RDS Spy log, bare hex groups or CSV */
+
+enum
+{
+    EXPORT_SPY,
+    EXPORT_HEX,
+    EXPORT_CSV
+};
+
+typedef struct export_args
+{
+    gint format;
+    gint pi;
+    gint64 from;
+    gint64 until;
+} export_args_t;
+
+typedef struct export_clock
+{
+    gint64 second;
+    gchar date[16];
+    gchar time[16];
+} export_clock_t;
+
+static void
+export_usage(const gchar *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-f spy|hex|csv] [-p PI] [-t from] [-u until] archive...\n"
+            "  -f  output format (default spy)\n"
+            "  -p  only groups received with the given PI (hex)\n"
+            "  -t  start time, ISO 8601 (e.g. 2021-03-14T21:30:00)\n"
+            "  -u  end time, ISO 8601\n",
+            name);
+}
+
+static gboolean
+export_parse_time(const gchar *text,
+                  gint64      *time)
+{
+    GTimeZone *tz = g_time_zone_new_local();
+    GDateTime *date = g_date_time_new_from_iso8601(text, tz);
+
+    g_time_zone_unref(tz);
+    if(!date)
+        return FALSE;
+
+    *time = g_date_time_to_unix(date) * G_USEC_PER_SEC + g_date_time_get_microsecond(date);
+    g_date_time_unref(date);
+    return TRUE;
+}
+
+static void
+export_clock_update(export_clock_t *stamp,
+                    gint64          time)
+{
+    /* Formatting is done once per second */
+    gint64 second = time / G_USEC_PER_SEC;
+    GDateTime *date;
+
+    if(second == stamp->second)
+        return;
+
+    date = g_date_time_new_from_unix_local(second);
+    g_snprintf(stamp->date, sizeof(stamp->date), "%04d/%02d/%02d",
+               g_date_time_get_year(date), g_date_time_get_month(date), g_date_time_get_day_of_month(date));
+    g_snprintf(stamp->time, sizeof(stamp->time), "%02d:%02d:%02d",
+               g_date_time_get_hour(date), g_date_time_get_minute(date), g_date_time_get_second(date));
+    g_date_time_unref(date);
+    stamp->second = second;
+}
+
+static void
+export_block(gchar   *out,
+             guint16  value,
+             gboolean valid)
+{
+    if(valid)
+        g_snprintf(out, 5, "%04X", value);
+    else
+        strcpy(out, "----");
+}
+
+static void
+export_group(const export_args_t       *args,
+             export_clock_t            *stamp,
+             const rds_archive_group_t *group)
+{
+    gchar blocks[4][5];
+    gint i;
+
+    /* Blocks that were not received without errors are left out, like for RDS Spy */
+    export_block(blocks[0], group->pi, group->pi >= 0);
+    for(i=0; i<3; i++)
+        export_block(blocks[i+1], group->data[i], !((group->errors >> (i*2)) & 3));
+
+    switch(args->format)
+    {
+    case EXPORT_SPY:
+        export_clock_update(stamp, group->time);
+        printf("%s %s %s %s @%s %s.%02d\n",
+               blocks[0], blocks[1], blocks[2], blocks[3],
+               stamp->date, stamp->time, (gint)(group->time % G_USEC_PER_SEC / 10000));
+        break;
+    case EXPORT_HEX:
+        printf("%s%s%s%s\n", blocks[0], blocks[1], blocks[2], blocks[3]);
+        break;
+    case EXPORT_CSV:
+        printf("%" G_GINT64_FORMAT ",%d,%d,%d,%04X,%04X,%04X,%u\n",
+               group->time / 1000, group->freq, group->pi, group->pi_err_level,
+               group->data[0], group->data[1], group->data[2], group->errors);
+        break;
+    }
+}
+
+static gboolean
+export_file(const export_args_t *args,
+            const gchar         *path)
+{
+    rds_archive_reader_t *reader = rds_archive_reader_open(path);
+    export_clock_t stamp = { -1 };
+    rds_archive_group_t group;
+    gboolean found;
+
+    if(!reader)
+    {
+        fprintf(stderr, "%s: not an RDS archive\n", path);
+        return FALSE;
+    }
+
+    /* The index takes the reader to the first matching group */
+    if(args->from)
+        found = rds_archive_seek_time(reader, args->from);
+    else if(args->pi >= 0)
+        found = rds_archive_seek_pi(reader, args->pi);
+    else
+        found = TRUE;
+
+    if(args->format == EXPORT_SPY)
+        printf("<recorder=\"xdr-gtk\" source=\"%s\">\n", path);
+
+    while(found && rds_archive_next(reader, &group))
+    {
+        if(args->until && group.time > args->until)
+            break;
+        if(args->pi >= 0 && group.pi != args->pi)
+            continue;
+        export_group(args, &stamp, &group);
+    }
+
+    rds_archive_reader_free(reader);
+    return TRUE;
+}
+
+gint
+main(gint   argc,
+     gchar *argv[])
+{
+    export_args_t args;
+    gint ret = EXIT_SUCCESS;
+    gint c;
+
+    args.format = EXPORT_SPY;
+    args.pi = -1;
+    args.from = 0;
+    args.until = 0;
+
+    while((c = getopt(argc, argv, "f:p:t:u:h")) != -1)
+    {
+        switch(c)
+        {
+        case 'f':
+            if(!strcmp(optarg, "spy"))
+                args.format = EXPORT_SPY;
+            else if(!strcmp(optarg, "hex"))
+                args.format = EXPORT_HEX;
+            else if(!strcmp(optarg, "csv"))
+                args.format = EXPORT_CSV;
+            else
+            {
+                export_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'p':
+            args.pi = strtol(optarg, NULL, 16) & 0xFFFF;
+            break;
+        case 't':
+            if(!export_parse_time(optarg, &args.from))
+            {
+                fprintf(stderr, "Invalid time: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'u':
+            if(!export_parse_time(optarg, &args.until))
+            {
+                fprintf(stderr, "Invalid time: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        default:
+            export_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(optind >= argc)
+    {
+        export_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if(args.format == EXPORT_CSV)
+        printf("time,freq,pi,pi_errors,b,c,d,errors\n");
+
+    for(; optind < argc; optind++)
+        if(!export_file(&args, argv[optind]))
+            ret = EXIT_FAILURE;
+
+    return ret;
+}
@@ -0,0 +1,642 @@
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <termios.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/* Simulated TEF668X tuner: serves the xdrd network protocol
+ * or the serial protocol over a pseudo-terminal */
+
+#define SIM_DEFAULT_PORT      7373
+#define SIM_SALT_LEN          16
+#define SIM_AUTH_TIMEOUT      5000
+#define SIM_LINE_BUFFER       1024
+#define SIM_SIGNAL_RATE       15.0
+#define SIM_RDS_RATE          11.4
+#define SIM_SCAN_STEP_TIME    5000    /* microseconds per scan sample */
+#define SIM_MAX_CATCH_UP      100
+
+typedef struct sim_args
+{
+    gint port;
+    const gchar *password;
+    gboolean guests;
+    gboolean pty;
+    gdouble multiplier;
+    gdouble signal_rate;
+    gdouble rds_rate;
+    gint error_rate;
+} sim_args_t;
+
+typedef struct sim_timer
+{
+    gint64 interval;
+    gint64 due;
+} sim_timer_t;
+
+typedef struct sim
+{
+    const sim_args_t *args;
+    gint fd;
+    gboolean socket;
+    gboolean started;
+    GString *out;
+    gchar line[SIM_LINE_BUFFER];
+    gint pos;
+
+    gint freq;
+    gint filter;
+    gboolean forced_mono;
+    gfloat level;
+
+    gint rds_group;
+    gboolean rds_ab;
+
+    gboolean scan_active;
+    gboolean scan_continuous;
+    gint scan_start;
+    gint scan_stop;
+    gint scan_step;
+
+    sim_timer_t signal;
+    sim_timer_t rds;
+    sim_timer_t scan;
+    guint lines;
+} sim_t;
+
+static const gchar sim_ps[] = "SIMULATR";
+static const gchar sim_rt[] = "XDR-GTK tuner simulator - synthetic RDS radiotext for load tests ";
+
+static void
+sim_timer_init(sim_timer_t *timer,
+               gdouble      rate,
+               gint64       now)
+{
+    timer->interval = (rate > 0.0 ? (gint64)(1000000.0 / rate) : 0);
+    timer->due = now + timer->interval;
+}
+
+static gboolean
+sim_timer_due(sim_timer_t *timer,
+              gint64       now)
+{
+    if(!timer->interval || now < timer->due)
+        return FALSE;
+
+    timer->due += timer->interval;
+    /* Do not try to catch up after a long stall */
+    if(now - timer->due > timer->interval * SIM_MAX_CATCH_UP)
+        timer->due = now + timer->interval;
+    return TRUE;
+}
+
+static gint
+sim_timer_wait(sim_timer_t *timer,
+               gint64       now,
+               gint         timeout)
+{
+    gint wait;
+
+    if(!timer->interval)
+        return timeout;
+
+    wait = (timer->due > now ? (gint)((timer->due - now + 999) / 1000) : 0);
+    return (timeout < 0 ? wait : MIN(wait, timeout));
+}
+
+static void
+sim_emit_signal(sim_t *sim)
+{
+    gchar value[G_ASCII_DTOSTR_BUF_SIZE];
+
+    /* Random walk around a moderate level */
+    sim->level += g_random_double_range(-1.5, 1.5);
+    sim->level = CLAMP(sim->level, 5.0, 80.0);
+
+    g_ascii_formatd(value, sizeof(value), "%.2f", sim->level);
+    g_string_append_printf(sim->out, "S%c%s,%d,%d\n",
+                           (sim->forced_mono ? 'M' : 's'),
+                           value,
+                           g_random_int_range(0, 20),
+                           g_random_int_range(0, 10));
+    sim->lines++;
+}
+
+static void
+sim_emit_rds(sim_t *sim)
+{
+    const guint16 pi = 0x3201;
+    guint16 b, c, d;
+    guint8 errors = 0;
+    gint segment;
+
+    if(sim->rds_group % 5 != 4)
+    {
+        /* 0A: PS in four segments */
+        segment = sim->rds_group % 4;
+        b = (0 << 12) | (1 << 10) | (10 << 5) | (1 << 3) | segment;
+        c = 0xE0CD;
+        d = (sim_ps[segment*2] << 8) | sim_ps[segment*2+1];
+    }
+    else
+    {
+        /* 2A: RT in sixteen segments */
+        segment = (sim->rds_group / 5) % 16;
+        if(!segment && sim->rds_group)
+            sim->rds_ab = !sim->rds_ab;
+        b = (2 << 12) | (1 << 10) | (10 << 5) | (sim->rds_ab << 4) | segment;
+        c = (sim_rt[segment*4] << 8) | sim_rt[segment*4+1];
+        d = (sim_rt[segment*4+2] << 8) | sim_rt[segment*4+3];
+    }
+    sim->rds_group++;
+
+    /* Random block errors, two bits per block */
+    if(sim->args->error_rate && g_random_int_range(0, 100) < sim->args->error_rate)
+        errors = g_random_int_range(0, 0x100) & 0x3F;
+
+    g_string_append_printf(sim->out, "P%04X%s\nR%04X%04X%04X%02X\n",
+                           pi,
+                           (errors ? "?" : ""),
+                           b, c, d, errors);
+    sim->lines += 2;
+}
+
+static void
+sim_emit_scan(sim_t *sim)
+{
+    gint freq;
+
+    g_string_append_c(sim->out, 'U');
+    for(freq = sim->scan_start; freq <= sim->scan_stop; freq += sim->scan_step)
+    {
+        g_string_append_printf(sim->out, "%d=%d.%d,",
+                               freq,
+                               g_random_int_range(5, 60),
+                               g_random_int_range(0, 10));
+    }
+    g_string_append_c(sim->out, '\n');
+    sim->lines++;
+
+    if(!sim->scan_continuous)
+        sim->scan_active = FALSE;
+}
+
+static void
+sim_scan_start(sim_t     *sim,
+               gboolean   continuous,
+               gint64     now)
+{
+    gint samples;
+
+    if(sim->scan_step <= 0 || sim->scan_stop < sim->scan_start)
+        return;
+
+    samples = (sim->scan_stop - sim->scan_start) / sim->scan_step + 1;
+    sim->scan_active = TRUE;
+    sim->scan_continuous = continuous;
+    sim->scan.interval = (gint64)(samples * SIM_SCAN_STEP_TIME / sim->args->multiplier);
+    sim->scan.due = now + sim->scan.interval;
+}
+
+static void
+sim_session_start(sim_t  *sim,
+                  gint64  now)
+{
+    sim->started = TRUE;
+    sim_timer_init(&sim->signal, sim->args->signal_rate * sim->args->multiplier, now);
+    sim_timer_init(&sim->rds, sim->args->rds_rate * sim->args->multiplier, now);
+
+    g_string_append_printf(sim->out, "OK\nM0\nT%d\nF%d\n", sim->freq, sim->filter);
+    sim->lines += 4;
+}
+
+static gboolean
+sim_command(sim_t       *sim,
+            const gchar *cmd,
+            gint64       now)
+{
+    /* Returns FALSE when the client asks for a shutdown */
+    switch(cmd[0])
+    {
+    case 0:
+        /* An empty line cancels the scan */
+        sim->scan_active = FALSE;
+        break;
+    case 'x':
+        sim_session_start(sim, now);
+        break;
+    case 'X':
+        sim->started = FALSE;
+        sim->scan_active = FALSE;
+        return !sim->socket;
+    case 'T':
+        sim->freq = atoi(cmd+1);
+        g_string_append_printf(sim->out, "T%d\nV%d\n", sim->freq, (sim->freq / 100) % 128);
+        sim->lines += 2;
+        break;
+    case 'F':
+        sim->filter = atoi(cmd+1);
+        g_string_append_printf(sim->out, "%s\n", cmd);
+        sim->lines++;
+        break;
+    case 'B':
+        sim->forced_mono = (cmd[1] == '1');
+        break;
+    case 'N':
+        g_string_append_printf(sim->out, "N%d\n", g_random_int_range(0, 100));
+        sim->lines++;
+        break;
+    case 'S':
+        switch(cmd[1])
+        {
+        case 'a':
+            sim->scan_start = atoi(cmd+2);
+            break;
+        case 'b':
+            sim->scan_stop = atoi(cmd+2);
+            break;
+        case 'c':
+            sim->scan_step = atoi(cmd+2);
+            break;
+        case 'f':
+        case 'z':
+            break;
+        case 'm':
+            sim_scan_start(sim, TRUE, now);
+            break;
+        case 0:
+            sim_scan_start(sim, FALSE, now);
+            break;
+        }
+        break;
+    case 'I':
+        g_string_append_printf(sim->out, "I%d\n", atoi(cmd+1));
+        sim->lines++;
+        break;
+    default:
+        /* Settings are acknowledged by echoing them back */
+        g_string_append_printf(sim->out, "%s\n", cmd);
+        sim->lines++;
+        break;
+    }
+    return TRUE;
+}
+
+static gboolean
+sim_read(sim_t  *sim,
+         gint64  now)
+{
+    gchar block[SIM_LINE_BUFFER];
+    gchar *ptr;
+    gint len;
+    gint i;
+
+    len = read(sim->fd, block, sizeof(block));
+    if(len <= 0)
+        return FALSE;
+
+    for(i = 0, ptr = block; i < len; i++, ptr++)
+    {
+        if(*ptr == '\r')
+            continue;
+        if(*ptr != '\n')
+        {
+            if(sim->pos < SIM_LINE_BUFFER-1)
+                sim->line[sim->pos++] = *ptr;
+            continue;
+        }
+        sim->line[sim->pos] = 0;
+        sim->pos = 0;
+        if(!sim_command(sim, sim->line, now))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+sim_hangup(sim_t *sim)
+{
+    /* The serial client has closed the terminal, wait for the next one */
+    sim->started = FALSE;
+    sim->scan_active = FALSE;
+    sim->pos = 0;
+    g_string_truncate(sim->out, 0);
+    g_usleep(100000);
+}
+
+static gboolean
+sim_flush(sim_t *sim)
+{
+    gsize sent = 0;
+    gssize n;
+
+    while(sent < sim->out->len)
+    {
+        if(sim->socket)
+            n = send(sim->fd, sim->out->str + sent, sim->out->len - sent, MSG_NOSIGNAL);
+        else
+            n = write(sim->fd, sim->out->str + sent, sim->out->len - sent);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            return FALSE;
+        }
+        sent += n;
+    }
+    g_string_truncate(sim->out, 0);
+    return TRUE;
+}
+
+static void
+sim_run(sim_t *sim)
+{
+    struct pollfd fds;
+    gint64 now, stats = g_get_monotonic_time();
+    guint lines = 0;
+    gint timeout;
+    gint n;
+
+    fds.fd = sim->fd;
+    fds.events = POLLIN;
+
+    while(TRUE)
+    {
+        now = g_get_monotonic_time();
+        if(sim->started)
+        {
+            while(sim_timer_due(&sim->signal, now))
+                sim_emit_signal(sim);
+            while(sim_timer_due(&sim->rds, now))
+                sim_emit_rds(sim);
+            if(sim->scan_active && sim_timer_due(&sim->scan, now))
+                sim_emit_scan(sim);
+        }
+
+        if(sim->out->len && !sim_flush(sim))
+        {
+            if(sim->socket)
+                break;
+            sim_hangup(sim);
+        }
+
+        if(now - stats >= G_USEC_PER_SEC)
+        {
+            g_print("sim: %u lines/s\n", sim->lines - lines);
+            lines = sim->lines;
+            stats = now;
+        }
+
+        timeout = 1000;
+        if(sim->started)
+        {
+            timeout = sim_timer_wait(&sim->signal, now, timeout);
+            timeout = sim_timer_wait(&sim->rds, now, timeout);
+            if(sim->scan_active)
+                timeout = sim_timer_wait(&sim->scan, now, timeout);
+        }
+
+        n = poll(&fds, 1, timeout);
+        if(n < 0 && errno != EINTR)
+            break;
+        if(n > 0 && !sim_read(sim, g_get_monotonic_time()))
+        {
+            if(sim->socket)
+                break;
+            sim_hangup(sim);
+        }
+    }
+}
+
+static void
+sim_init(sim_t            *sim,
+         const sim_args_t *args,
+         gint              fd,
+         gboolean          socket)
+{
+    memset(sim, 0, sizeof(sim_t));
+    sim->args = args;
+    sim->fd = fd;
+    sim->socket = socket;
+    sim->out = g_string_sized_new(4096);
+    sim->freq = 87500;
+    sim->filter = -1;
+    sim->level = 40.0;
+}
+
+static gboolean
+sim_auth(gint              fd,
+         const sim_args_t *args)
+{
+    static const gchar chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    gchar salt[SIM_SALT_LEN+1];
+    gchar hash[SIM_LINE_BUFFER];
+    struct pollfd fds;
+    GChecksum *sha1;
+    gboolean valid;
+    const gchar *reply;
+    gint len = 0;
+    gint i;
+
+    for(i=0; i<SIM_SALT_LEN; i++)
+        salt[i] = chars[g_random_int_range(0, sizeof(chars)-1)];
+    salt[SIM_SALT_LEN] = '\n';
+    if(send(fd, salt, sizeof(salt), MSG_NOSIGNAL) != sizeof(salt))
+        return FALSE;
+
+    /* SHA1 of the salt and password, as a hex string with \n.
+     * Read byte by byte, so that no command is consumed here */
+    fds.fd = fd;
+    fds.events = POLLIN;
+    while(len < (gint)sizeof(hash)-1)
+    {
+        if(poll(&fds, 1, SIM_AUTH_TIMEOUT) <= 0)
+            return FALSE;
+        if(recv(fd, hash+len, 1, 0) != 1)
+            return FALSE;
+        if(hash[len] == '\n')
+            break;
+        len++;
+    }
+    hash[len] = 0;
+    if(len && hash[len-1] == '\r')
+        hash[len-1] = 0;
+
+    sha1 = g_checksum_new(G_CHECKSUM_SHA1);
+    g_checksum_update(sha1, (guchar*)salt, SIM_SALT_LEN);
+    g_checksum_update(sha1, (guchar*)args->password, strlen(args->password));
+    valid = !g_ascii_strcasecmp(hash, g_checksum_get_string(sha1));
+    g_checksum_free(sha1);
+
+    if(valid)
+        reply = "a2\no1,0\n";
+    else if(args->guests)
+        reply = "a1\no1,1\n";
+    else
+        reply = "a0\n";
+
+    send(fd, reply, strlen(reply), MSG_NOSIGNAL);
+    g_print("sim: client %s\n", (valid ? "authorized" : (args->guests ? "connected as a guest" : "unauthorized")));
+    return (valid || args->guests);
+}
+
+static gint
+sim_serve_socket(const sim_args_t *args)
+{
+    struct sockaddr_in addr;
+    sim_t sim;
+    gint server, client;
+    gint on = 1;
+
+    server = socket(AF_INET, SOCK_STREAM, 0);
+    if(server < 0)
+    {
+        perror("socket");
+        return EXIT_FAILURE;
+    }
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(args->port);
+    if(bind(server, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(server, 1) < 0)
+    {
+        perror("bind");
+        close(server);
+        return EXIT_FAILURE;
+    }
+
+    g_print("sim: listening on port %d\n", args->port);
+    while((client = accept(server, NULL, NULL)) >= 0)
+    {
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        if(sim_auth(client, args))
+        {
+            sim_init(&sim, args, client, TRUE);
+            sim_run(&sim);
+            g_string_free(sim.out, TRUE);
+            g_print("sim: client disconnected (%u lines)\n", sim.lines);
+        }
+        shutdown(client, SHUT_RDWR);
+        close(client);
+    }
+
+    close(server);
+    return EXIT_SUCCESS;
+}
+
+static gint
+sim_serve_pty(const sim_args_t *args)
+{
+    struct termios options;
+    sim_t sim;
+    gint master;
+
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if(master < 0 || grantpt(master) < 0 || unlockpt(master) < 0)
+    {
+        perror("posix_openpt");
+        return EXIT_FAILURE;
+    }
+
+    /* Raw terminal, no echo of the commands */
+    if(!tcgetattr(master, &options))
+    {
+        cfmakeraw(&options);
+        tcsetattr(master, TCSANOW, &options);
+    }
+
+    /* The connection dialog expects a path relative to /dev */
+    g_print("sim: serial port %s (use \"%s\")\n",
+            ptsname(master),
+            (g_str_has_prefix(ptsname(master), "/dev/") ? ptsname(master) + 5 : ptsname(master)));
+
+    sim_init(&sim, args, master, FALSE);
+    sim_run(&sim);
+    g_string_free(sim.out, TRUE);
+    close(master);
+    return EXIT_SUCCESS;
+}
+
+static void
+sim_usage(const gchar *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-p port] [-w password] [-g] [-t] [-m multiplier] [-s signal/s] [-r groups/s] [-e error%%]\n"
+            "  -p  TCP port (default %d)\n"
+            "  -w  password (default none)\n"
+            "  -g  accept guests with a wrong password\n"
+            "  -t  serve the serial protocol on a pseudo-terminal instead\n"
+            "  -m  rate multiplier for all the traffic (default 1.0)\n"
+            "  -s  signal samples per second (default %.1f)\n"
+            "  -r  RDS groups per second (default %.1f)\n"
+            "  -e  percentage of RDS groups with errors (default 0)\n",
+            name, SIM_DEFAULT_PORT, SIM_SIGNAL_RATE, SIM_RDS_RATE);
+}
+
+gint
+main(gint   argc,
+     gchar *argv[])
+{
+    sim_args_t args;
+    gint c;
+
+    args.port = SIM_DEFAULT_PORT;
+    args.password = "";
+    args.guests = FALSE;
+    args.pty = FALSE;
+    args.multiplier = 1.0;
+    args.signal_rate = SIM_SIGNAL_RATE;
+    args.rds_rate = SIM_RDS_RATE;
+    args.error_rate = 0;
+
+    while((c = getopt(argc, argv, "p:w:gtm:s:r:e:h")) != -1)
+    {
+        switch(c)
+        {
+        case 'p':
+            args.port = atoi(optarg);
+            break;
+        case 'w':
+            args.password = optarg;
+            break;
+        case 'g':
+            args.guests = TRUE;
+            break;
+        case 't':
+            args.pty = TRUE;
+            break;
+        case 'm':
+            args.multiplier = g_ascii_strtod(optarg, NULL);
+            break;
+        case 's':
+            args.signal_rate = g_ascii_strtod(optarg, NULL);
+            break;
+        case 'r':
+            args.rds_rate = g_ascii_strtod(optarg, NULL);
+            break;
+        case 'e':
+            args.error_rate = CLAMP(atoi(optarg), 0, 100);
+            break;
+        default:
+            sim_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(args.multiplier <= 0.0)
+        args.multiplier = 1.0;
+
+    return (args.pty ? sim_serve_pty(&args) : sim_serve_socket(&args));
+}